@@ -0,0 +1,428 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+/*
+ * Software loopback network device
+ *
+ * Every receive queue holds a ring of buffers that were handed out by the
+ * user's `alloc_rxpkts` callback, just like the descriptor ring of a real
+ * NIC. Transmitting on queue `n` copies the packet into the next posted
+ * buffer of receive queue `n` (modulo the number of receive queues) and
+ * raises a receive event. When no posted buffer is left, transmission
+ * reports a full queue so that the sender sees back pressure instead of
+ * silent drops.
+ */
+
+#include <string.h>
+#include <uk/alloc.h>
+#include <uk/assert.h>
+#include <uk/errptr.h>
+#include <uk/essentials.h>
+#include <uk/init.h>
+#include <uk/netdev.h>
+#include <uk/netdev_driver.h>
+#include <uk/print.h>
+
+#define DRIVER_NAME		"loop"
+
+#define LOOP_NB_QUEUES		CONFIG_LIBUKNETDEV_LOOP_QUEUES
+#define LOOP_NB_DESC_DEFAULT	256
+#define LOOP_NB_DESC_MAX	4096
+
+#define LOOP_INTR_EN		0x01
+#define LOOP_INTR_USR_EN	0x02
+
+#define to_loopdev(ndev) \
+	__containerof(ndev, struct loop_dev, netdev)
+
+struct uk_netdev_rx_queue {
+	struct uk_netdev *ndev;
+	uint16_t queue_id;
+	uint16_t nb_desc;
+	/* Free-running ring indices: [head, fill) holds received packets,
+	 * [fill, post) holds empty buffers posted for reception.
+	 */
+	uint32_t head;
+	uint32_t fill;
+	uint32_t post;
+	struct uk_netbuf **ring;
+	uk_netdev_alloc_rxpkts alloc_rxpkts;
+	void *alloc_rxpkts_argp;
+	int intr_enabled;
+	struct uk_alloc *a;
+};
+
+struct uk_netdev_tx_queue {
+	uint16_t queue_id;
+};
+
+struct loop_dev {
+	struct uk_netdev netdev;
+	struct uk_hwaddr hwaddr;
+	uint16_t mtu;
+	unsigned int promisc;
+	uint16_t nb_rx_queues;
+	uint16_t nb_tx_queues;
+	struct uk_netdev_rx_queue rxqs[LOOP_NB_QUEUES];
+	struct uk_netdev_tx_queue txqs[LOOP_NB_QUEUES];
+};
+
+static const char *drv_name = DRIVER_NAME;
+static struct loop_dev loop_dev;
+
+/* Posts empty buffers until the ring is full */
+static int loop_rxq_fillup(struct uk_netdev_rx_queue *rxq)
+{
+	uint16_t mask = rxq->nb_desc - 1;
+	uint16_t free, idx, cnt, got;
+
+	while ((free = rxq->nb_desc - (rxq->post - rxq->head)) > 0) {
+		idx = rxq->post & mask;
+		cnt = MIN(free, (uint16_t) (rxq->nb_desc - idx));
+		got = rxq->alloc_rxpkts(rxq->alloc_rxpkts_argp,
+					&rxq->ring[idx], cnt);
+		rxq->post += got;
+		if (unlikely(got < cnt))
+			return UK_NETDEV_STATUS_UNDERRUN;
+	}
+	return 0;
+}
+
+static int loop_recv(struct uk_netdev *dev __unused,
+		     struct uk_netdev_rx_queue *rxq,
+		     struct uk_netbuf **pkt)
+{
+	int status = 0x0;
+
+	UK_ASSERT(rxq);
+	UK_ASSERT(pkt);
+
+	/* Queue interrupts have to be off when calling receive */
+	UK_ASSERT(!(rxq->intr_enabled & LOOP_INTR_EN));
+
+	if (rxq->head == rxq->fill) {
+		*pkt = NULL;
+	} else {
+		*pkt = rxq->ring[rxq->head & (rxq->nb_desc - 1)];
+		rxq->head++;
+		status |= UK_NETDEV_STATUS_SUCCESS;
+	}
+	status |= loop_rxq_fillup(rxq);
+
+	if (rxq->head != rxq->fill)
+		status |= UK_NETDEV_STATUS_MORE;
+	else if (rxq->intr_enabled & LOOP_INTR_USR_EN)
+		rxq->intr_enabled |= LOOP_INTR_EN;
+	return status;
+}
+
+#if CONFIG_LIBUKNETDEV_LOOP_NULL
+static int loop_xmit(struct uk_netdev *dev __unused,
+		     struct uk_netdev_tx_queue *txq __unused,
+		     struct uk_netbuf *pkt)
+{
+	UK_ASSERT(pkt);
+
+	uk_netbuf_free(pkt);
+	return UK_NETDEV_STATUS_SUCCESS | UK_NETDEV_STATUS_MORE;
+}
+#else /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+static int loop_xmit(struct uk_netdev *dev,
+		     struct uk_netdev_tx_queue *txq,
+		     struct uk_netbuf *pkt)
+{
+	struct loop_dev *ldev;
+	struct uk_netdev_rx_queue *rxq;
+	struct uk_netbuf *rb, *nb;
+	__sz len = 0;
+	__u8 *dst;
+
+	UK_ASSERT(dev && txq);
+	UK_ASSERT(pkt);
+
+	ldev = to_loopdev(dev);
+	UK_ASSERT(ldev->nb_rx_queues > 0);
+	rxq = &ldev->rxqs[txq->queue_id % ldev->nb_rx_queues];
+
+	/* Nobody listens: drop */
+	if (unlikely(!rxq->ring))
+		goto out;
+
+	/* No posted buffer left: the receiver has to catch up first */
+	if (unlikely(rxq->fill == rxq->post))
+		return 0x0;
+
+	rb = rxq->ring[rxq->fill & (rxq->nb_desc - 1)];
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt)
+		len += nb->len;
+
+	/* Packets that do not fit into a receive buffer are dropped, as a
+	 * NIC would do.
+	 */
+	if (unlikely(len > rb->len)) {
+		uk_pr_debug("%s: Dropped packet of %"__PRIsz" bytes\n",
+			    drv_name, len);
+		goto out;
+	}
+
+	dst = rb->data;
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt) {
+		memcpy(dst, nb->data, nb->len);
+		dst += nb->len;
+	}
+	rb->len = len;
+
+	/* The payload never left memory: a partial checksum stays partial,
+	 * everything else is known to be intact.
+	 */
+	if (pkt->flags & UK_NETBUF_F_PARTIAL_CSUM) {
+		rb->flags = UK_NETBUF_F_PARTIAL_CSUM;
+		rb->csum_start  = pkt->csum_start;
+		rb->csum_offset = pkt->csum_offset;
+	} else {
+		rb->flags = UK_NETBUF_F_DATA_VALID;
+	}
+	rxq->fill++;
+
+	if (rxq->intr_enabled & LOOP_INTR_EN) {
+		rxq->intr_enabled &= ~(LOOP_INTR_EN);
+		uk_netdev_drv_rx_event(rxq->ndev, rxq->queue_id);
+	}
+
+out:
+	uk_netbuf_free(pkt);
+	return UK_NETDEV_STATUS_SUCCESS
+	       | ((rxq->fill != rxq->post) ? UK_NETDEV_STATUS_MORE : 0x0);
+}
+#endif /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+
+static int loop_rxq_intr_enable(struct uk_netdev *dev __unused,
+				struct uk_netdev_rx_queue *rxq)
+{
+	UK_ASSERT(rxq);
+
+	if (rxq->intr_enabled & LOOP_INTR_EN)
+		return 0;
+
+	/* Like with a hardware queue, the interrupt is only armed once all
+	 * pending packets are received.
+	 */
+	rxq->intr_enabled = LOOP_INTR_USR_EN;
+	if (rxq->head != rxq->fill)
+		return 1;
+	rxq->intr_enabled |= LOOP_INTR_EN;
+	return 0;
+}
+
+static int loop_rxq_intr_disable(struct uk_netdev *dev __unused,
+				 struct uk_netdev_rx_queue *rxq)
+{
+	UK_ASSERT(rxq);
+
+	rxq->intr_enabled &= ~(LOOP_INTR_USR_EN | LOOP_INTR_EN);
+	return 0;
+}
+
+static void loop_info_get(struct uk_netdev *dev __unused,
+			  struct uk_netdev_info *dev_info)
+{
+	UK_ASSERT(dev_info);
+
+	dev_info->max_rx_queues = LOOP_NB_QUEUES;
+	dev_info->max_tx_queues = LOOP_NB_QUEUES;
+	dev_info->in_queue_pairs = 0;
+	dev_info->max_mtu = UK_ETH_JPAYLOAD_MAXLEN;
+	dev_info->nb_encap_tx = 0;
+	dev_info->nb_encap_rx = 0;
+	dev_info->ioalign = sizeof(void *);
+	dev_info->features = UK_NETDEV_F_RXQ_INTR
+			     | UK_NETDEV_F_PARTIAL_CSUM;
+}
+
+static int loop_queue_info_get(struct uk_netdev *dev __unused,
+			       uint16_t queue_id,
+			       struct uk_netdev_queue_info *qinfo)
+{
+	UK_ASSERT(qinfo);
+
+	if (unlikely(queue_id >= LOOP_NB_QUEUES))
+		return -EINVAL;
+
+	qinfo->nb_min = 1;
+	qinfo->nb_max = LOOP_NB_DESC_MAX;
+	qinfo->nb_align = 1;
+	qinfo->nb_is_power_of_two = 1;
+	return 0;
+}
+
+static int loop_configure(struct uk_netdev *dev,
+			  const struct uk_netdev_conf *conf)
+{
+	struct loop_dev *ldev;
+
+	UK_ASSERT(dev && conf);
+	ldev = to_loopdev(dev);
+
+	if (unlikely(conf->nb_rx_queues > LOOP_NB_QUEUES ||
+		     conf->nb_tx_queues > LOOP_NB_QUEUES))
+		return -EINVAL;
+
+	ldev->nb_rx_queues = conf->nb_rx_queues;
+	ldev->nb_tx_queues = conf->nb_tx_queues;
+	return 0;
+}
+
+static struct uk_netdev_rx_queue *
+loop_rxq_configure(struct uk_netdev *dev, uint16_t queue_id, uint16_t nb_desc,
+		   struct uk_netdev_rxqueue_conf *conf)
+{
+	struct loop_dev *ldev;
+	struct uk_netdev_rx_queue *rxq;
+	int rc;
+
+	UK_ASSERT(dev && conf);
+	UK_ASSERT(conf->alloc_rxpkts);
+	ldev = to_loopdev(dev);
+
+	if (unlikely(queue_id >= ldev->nb_rx_queues))
+		return ERR2PTR(-EINVAL);
+	if (nb_desc == 0)
+		nb_desc = LOOP_NB_DESC_DEFAULT;
+	if (unlikely(nb_desc > LOOP_NB_DESC_MAX ||
+		     (nb_desc & (nb_desc - 1)) != 0))
+		return ERR2PTR(-EINVAL);
+
+	rxq = &ldev->rxqs[queue_id];
+	rxq->ring = uk_calloc(conf->a, nb_desc, sizeof(*rxq->ring));
+	if (unlikely(!rxq->ring))
+		return ERR2PTR(-ENOMEM);
+
+	rxq->ndev = dev;
+	rxq->queue_id = queue_id;
+	rxq->nb_desc = nb_desc;
+	rxq->head = rxq->fill = rxq->post = 0;
+	rxq->alloc_rxpkts = conf->alloc_rxpkts;
+	rxq->alloc_rxpkts_argp = conf->alloc_rxpkts_argp;
+	rxq->intr_enabled = 0;
+	rxq->a = conf->a;
+
+	rc = loop_rxq_fillup(rxq);
+	if (unlikely(rc))
+		uk_pr_warn("%s: Could not fill receive queue %"__PRIu16"\n",
+			   drv_name, queue_id);
+	return rxq;
+}
+
+static struct uk_netdev_tx_queue *
+loop_txq_configure(struct uk_netdev *dev, uint16_t queue_id,
+		   uint16_t nb_desc __unused,
+		   struct uk_netdev_txqueue_conf *conf __unused)
+{
+	struct loop_dev *ldev;
+
+	UK_ASSERT(dev);
+	ldev = to_loopdev(dev);
+
+	if (unlikely(queue_id >= ldev->nb_tx_queues))
+		return ERR2PTR(-EINVAL);
+
+	ldev->txqs[queue_id].queue_id = queue_id;
+	return &ldev->txqs[queue_id];
+}
+
+static int loop_start(struct uk_netdev *dev __unused)
+{
+	return 0;
+}
+
+static const struct uk_hwaddr *loop_hwaddr_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+	return &to_loopdev(dev)->hwaddr;
+}
+
+static int loop_hwaddr_set(struct uk_netdev *dev,
+			   const struct uk_hwaddr *hwaddr)
+{
+	UK_ASSERT(dev && hwaddr);
+	to_loopdev(dev)->hwaddr = *hwaddr;
+	return 0;
+}
+
+static uint16_t loop_mtu_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+	return to_loopdev(dev)->mtu;
+}
+
+static int loop_mtu_set(struct uk_netdev *dev, uint16_t mtu)
+{
+	UK_ASSERT(dev);
+
+	if (unlikely(mtu > UK_ETH_JPAYLOAD_MAXLEN))
+		return -EINVAL;
+	to_loopdev(dev)->mtu = mtu;
+	return 0;
+}
+
+static unsigned int loop_promiscuous_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+	return to_loopdev(dev)->promisc;
+}
+
+static int loop_promiscuous_set(struct uk_netdev *dev, unsigned int mode)
+{
+	UK_ASSERT(dev);
+	to_loopdev(dev)->promisc = mode ? 1 : 0;
+	return 0;
+}
+
+static const struct uk_netdev_ops loop_ops = {
+	.rxq_intr_enable  = loop_rxq_intr_enable,
+	.rxq_intr_disable = loop_rxq_intr_disable,
+	.hwaddr_get       = loop_hwaddr_get,
+	.hwaddr_set       = loop_hwaddr_set,
+	.mtu_get          = loop_mtu_get,
+	.mtu_set          = loop_mtu_set,
+	.promiscuous_set  = loop_promiscuous_set,
+	.promiscuous_get  = loop_promiscuous_get,
+	.info_get         = loop_info_get,
+	.txq_info_get     = loop_queue_info_get,
+	.rxq_info_get     = loop_queue_info_get,
+	.configure        = loop_configure,
+	.txq_configure    = loop_txq_configure,
+	.rxq_configure    = loop_rxq_configure,
+	.start            = loop_start,
+};
+
+static int loop_init(struct uk_init_ctx *ictx __unused)
+{
+	int rc;
+
+	loop_dev.netdev.ops = &loop_ops;
+	loop_dev.netdev.rx_one = loop_recv;
+	loop_dev.netdev.tx_one = loop_xmit;
+	loop_dev.mtu = UK_ETH_PAYLOAD_MAXLEN;
+
+	/* Locally administered unicast address */
+	loop_dev.hwaddr.addr_bytes[0] = 0x02;
+
+	rc = uk_netdev_drv_register(&loop_dev.netdev,
+				    uk_alloc_get_default(), drv_name);
+	if (unlikely(rc < 0)) {
+		uk_pr_err("%s: Failed to register device: %d\n",
+			  drv_name, rc);
+		return rc;
+	}
+	loop_dev.hwaddr.addr_bytes[5] = (uint8_t) rc;
+
+	uk_pr_info("%s: Registered netdev%d with %d queue pair(s)\n",
+		   drv_name, rc, LOOP_NB_QUEUES);
+	return 0;
+}
+
+uk_plat_initcall(loop_init, 0x0);
@@ -50,7 +50,8 @@
  *	Multi-queue,
  *	Maximum size of a segment for requests,
  *	Maximum number of segments per request,
- *	Flush
+ *	Flush,
+ *	Packed virtqueues
  **/
 #define VIRTIO_BLK_DRV_FEATURES(features)				\
 	do {								\
@@ -62,6 +63,7 @@
 		VIRTIO_FEATURE_SET(features, VIRTIO_BLK_F_SIZE_MAX);	\
 		VIRTIO_FEATURE_SET(features, VIRTIO_BLK_F_FLUSH);	\
 		VIRTIO_FEATURE_SET(features, VIRTIO_F_VERSION_1);	\
+		VIRTIO_FEATURE_SET(features, VIRTIO_F_RING_PACKED);	\
 	} while (0)
 
 static struct uk_alloc *a;
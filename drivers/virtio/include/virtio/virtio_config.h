@@ -53,6 +53,8 @@ extern "C" {
 
 #define VIRTIO_TRANSPORT_F_START		28
 #define VIRTIO_TRANSPORT_F_END			32
+/* Feature bits from here on are again specific to the device type */
+#define VIRTIO_DEV_F_HIGH_START			50
 
 /* v1.0 compliant. */
 #define VIRTIO_F_VERSION_1			32
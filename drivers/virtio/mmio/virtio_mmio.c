@@ -115,6 +115,10 @@ static void vm_set_features(struct virtio_dev *vdev)
 	/* Give virtio_ring a chance to accept features. */
 	vdev->features = virtqueue_feature_negotiate(vdev->features);
 
+	/* Legacy devices do not support packed virtqueues */
+	if (vm_dev->version == 1)
+		VIRTIO_FEATURE_CLEAR(vdev->features, VIRTIO_F_RING_PACKED);
+
 	/* Make sure there are no mixed devices */
 	if (vm_dev->version == 2 &&
 	    !uk_test_bit(VIRTIO_F_VERSION_1, &vdev->features)) {
@@ -74,6 +74,8 @@
 #define VIRTIO_NET_F_CTRL_MAC_ADDR 23	/* Set MAC address */
 
 #define VIRTIO_NET_F_SPEED_DUPLEX 63	/* Device set linkspeed and duplex */
+#define VIRTIO_NET_F_RSS	  60	/* Supports RSS RX steering */
+#define VIRTIO_NET_F_HOST_USO	  56	/* Host can handle USO in. */
 #define VIRTIO_NET_F_HASH_REPORT  57	/* Device can provide per-packet hash
 					 * value
 					 */
@@ -108,8 +110,25 @@ struct virtio_net_config {
 	 * Any other value stands for unknown.
 	 */
 	__u8 duplex;
+	/* Maximum size of the RSS key (if VIRTIO_NET_F_RSS) */
+	__u8 rss_max_key_size;
+	/* Maximum number of RSS indirection table entries */
+	__u16 rss_max_indirection_table_length;
+	/* Supported hash types; see VIRTIO_NET_RSS_HASH_TYPE_* */
+	__u32 supported_hash_types;
 } __packed;
 
+/* Hash types for RSS and hash reporting */
+#define VIRTIO_NET_RSS_HASH_TYPE_IPv4		(1 << 0)
+#define VIRTIO_NET_RSS_HASH_TYPE_TCPv4		(1 << 1)
+#define VIRTIO_NET_RSS_HASH_TYPE_UDPv4		(1 << 2)
+#define VIRTIO_NET_RSS_HASH_TYPE_IPv6		(1 << 3)
+#define VIRTIO_NET_RSS_HASH_TYPE_TCPv6		(1 << 4)
+#define VIRTIO_NET_RSS_HASH_TYPE_UDPv6		(1 << 5)
+#define VIRTIO_NET_RSS_HASH_TYPE_IP_EX		(1 << 6)
+#define VIRTIO_NET_RSS_HASH_TYPE_TCP_EX		(1 << 7)
+#define VIRTIO_NET_RSS_HASH_TYPE_UDP_EX		(1 << 8)
+
 /* This header comes first in the scatter-gather list.
  * For legacy virtio, if VIRTIO_F_ANY_LAYOUT is not negotiated, it must
  * be the first element of the scatter-gather list.  If you don't
@@ -124,6 +143,7 @@ struct virtio_net_hdr {
 #define VIRTIO_NET_HDR_GSO_TCPV4    1   /* GSO frame, IPv4 TCP (TSO) */
 #define VIRTIO_NET_HDR_GSO_UDP      3   /* GSO frame, IPv4 UDP (UFO) */
 #define VIRTIO_NET_HDR_GSO_TCPV6    4   /* GSO frame, IPv6 TCP */
+#define VIRTIO_NET_HDR_GSO_UDP_L4   5   /* GSO frame, IPv4 & IPv6 UDP (USO) */
 #define VIRTIO_NET_HDR_GSO_ECN      0x80    /* TCP has ECN set */
 	/* See VIRTIO_NET_HDR_GSO_* */
 	__u8 gso_type;
@@ -242,6 +262,30 @@ struct virtio_net_ctrl_mq {
  #define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_MIN        1
  #define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_MAX        0x8000
 
+/*
+ * Control Receive Side Scaling
+ *
+ * The command VIRTIO_NET_CTRL_MQ_RSS_CONFIG is available with the
+ * VIRTIO_NET_F_RSS feature bit. The device selects the receive virtqueue
+ * with the hash of the packet as index into the indirection table. The
+ * command data is a virtio_net_rss_config, followed by the indirection
+ * table, followed by a virtio_net_rss_config_tail, followed by the key.
+ */
+struct virtio_net_rss_config {
+	__virtio_le32 hash_types;
+	__virtio_le16 indirection_table_mask;
+	__virtio_le16 unclassified_queue;
+	__virtio_le16 indirection_table[];
+} __packed;
+
+struct virtio_net_rss_config_tail {
+	__virtio_le16 max_tx_vq;
+	__u8 hash_key_length;
+	__u8 hash_key_data[];
+} __packed;
+
+ #define VIRTIO_NET_CTRL_MQ_RSS_CONFIG          1
+
 /*
  * Control network offloads
  *
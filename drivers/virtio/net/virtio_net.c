@@ -34,6 +34,7 @@
 #include <uk/sglist.h>
 #include <uk/arch/types.h>
 #include <uk/arch/limits.h>
+#include <uk/arch/lcpu.h>
 #include <uk/netbuf.h>
 #include <uk/netdev.h>
 #include <uk/netdev_core.h>
@@ -83,6 +84,30 @@
  */
 #define NET_MAX_FRAGMENTS    ((__U16_MAX >> __PAGE_SHIFT) + 2)
 
+/**
+ * Size of the RSS indirection table and key that we program to the device.
+ * The device may support less and we program only what is supported.
+ */
+#define VTNET_RSS_RETA_SIZE			128
+#define VTNET_RSS_KEY_SIZE			40
+
+/* Hash types that we enable for RSS if the device supports them */
+#define VTNET_RSS_HASH_TYPES					\
+	(VIRTIO_NET_RSS_HASH_TYPE_IPv4 | VIRTIO_NET_RSS_HASH_TYPE_TCPv4 | \
+	 VIRTIO_NET_RSS_HASH_TYPE_UDPv4 | VIRTIO_NET_RSS_HASH_TYPE_IPv6 | \
+	 VIRTIO_NET_RSS_HASH_TYPE_TCPv6 | VIRTIO_NET_RSS_HASH_TYPE_UDPv6)
+
+#define VTNET_RSS_CONFIG_MAXLEN					\
+	(sizeof(struct virtio_net_rss_config) +			\
+	 VTNET_RSS_RETA_SIZE * sizeof(__virtio_le16) +		\
+	 sizeof(struct virtio_net_rss_config_tail) + VTNET_RSS_KEY_SIZE)
+
+/**
+ * Control commands consist of a header, the command data, and the ack. The
+ * command data might cross a page boundary.
+ */
+#define VTNET_CTRL_MAX_FRAGMENTS		4
+
 #define to_virtionetdev(ndev) \
 	__containerof(ndev, struct virtio_net_device, netdev)
 
@@ -140,6 +165,26 @@ struct uk_netdev_rx_queue {
 	struct uk_sglist_seg sgsegs[NET_MAX_FRAGMENTS];
 };
 
+/**
+ * @internal structure to represent the control queue and its buffers.
+ */
+struct virtio_net_ctrl {
+	/* The virtqueue reference */
+	struct virtqueue *vq;
+	/* The command header, read by the device */
+	struct virtio_net_ctrl_hdr hdr;
+	/* The command data, read by the device */
+	union {
+		struct virtio_net_ctrl_mq mq;
+		__u8 rss[VTNET_RSS_CONFIG_MAXLEN];
+	} data;
+	/* The command status, written by the device */
+	virtio_net_ctrl_ack ack;
+	/* The scatter list and its associated fragements */
+	struct uk_sglist sg;
+	struct uk_sglist_seg sgsegs[VTNET_CTRL_MAX_FRAGMENTS];
+};
+
 struct virtio_net_device {
 	/* Virtio Device */
 	struct virtio_dev *vdev;
@@ -148,9 +193,19 @@ struct virtio_net_device {
 	struct uk_netdev netdev;
 	/* Count of the number of the virtqueues */
 	__u16 max_vqueue_pairs;
+	/* The hw identifier of the control queue */
+	__u16 ctrlq_id;
+	/* The control queue (if VIRTIO_NET_F_CTRL_VQ) */
+	struct virtio_net_ctrl *ctrl;
+	/* RSS capabilities of the device (if VIRTIO_NET_F_RSS) */
+	__u8 rss_max_key_size;
+	__u16 rss_max_reta_size;
+	__u32 rss_hash_types;
 	/* List of the Rx/Tx queue */
+	__u16    rx_vqueue_nb;
 	__u16    rx_vqueue_cnt;
 	struct   uk_netdev_rx_queue *rxqs;
+	__u16    tx_vqueue_nb;
 	__u16    tx_vqueue_cnt;
 	struct   uk_netdev_tx_queue *txqs;
 	/* The netdevice identifier */
@@ -226,6 +281,15 @@ static int virtio_netdev_rx_fillup(struct virtio_net_device *vndev,
 static const char *drv_name = DRIVER_NAME;
 static struct uk_alloc *a;
 
+/* Default Toeplitz hash key as given in the Microsoft RSS specification */
+static const __u8 vtnet_rss_key[VTNET_RSS_KEY_SIZE] = {
+	0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+	0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+	0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+	0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+	0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
 /* This provides the size of the virtio-net header depending on the
  * virito version and features selected. Use this instead of
  * sizeof(struct virtio_net_hdr).
@@ -256,6 +320,96 @@ static inline __u16 virtio_net_hdr_size(struct virtio_net_device *vndev)
 	return hdr_size;
 }
 
+/**
+ * Sends a command on the control queue and busy-waits for its completion.
+ * The command data has to be placed in vndev->ctrl->data beforehand.
+ */
+static int virtio_netdev_ctrl_cmd(struct virtio_net_device *vndev,
+				  __u8 class, __u8 cmd, __sz len)
+{
+	struct virtio_net_ctrl *ctrl = vndev->ctrl;
+	void *cookie;
+	int rc;
+
+	if (unlikely(!ctrl))
+		return -ENOTSUP;
+
+	UK_ASSERT(len <= sizeof(ctrl->data));
+
+	ctrl->hdr.class = class;
+	ctrl->hdr.cmd = cmd;
+	ctrl->ack = VIRTIO_NET_ERR;
+
+	uk_sglist_reset(&ctrl->sg);
+	rc = uk_sglist_append(&ctrl->sg, &ctrl->hdr, sizeof(ctrl->hdr));
+	if (likely(rc == 0 && len > 0))
+		rc = uk_sglist_append(&ctrl->sg, &ctrl->data, len);
+	if (likely(rc == 0))
+		rc = uk_sglist_append(&ctrl->sg, &ctrl->ack, sizeof(ctrl->ack));
+	if (unlikely(rc != 0))
+		return rc;
+
+	rc = virtqueue_buffer_enqueue(ctrl->vq, ctrl, &ctrl->sg,
+				      ctrl->sg.sg_nseg - 1, 1);
+	if (unlikely(rc < 0))
+		return rc;
+
+	virtqueue_host_notify(ctrl->vq);
+
+	/* Control commands are rare, so we just poll for the completion */
+	while (virtqueue_buffer_dequeue(ctrl->vq, &cookie, NULL) < 0)
+		ukarch_spinwait();
+
+	UK_ASSERT(cookie == ctrl);
+
+	return (ctrl->ack == VIRTIO_NET_OK) ? 0 : -EIO;
+}
+
+/**
+ * Lets the device spread incoming flows over all configured receive queues,
+ * either with RSS or by setting the number of queue pairs, in which case the
+ * device steers the flows on its own.
+ */
+static int virtio_netdev_steering_configure(struct virtio_net_device *vndev)
+{
+	struct virtio_net_rss_config *rss;
+	struct virtio_net_rss_config_tail *tail;
+	__u16 reta_size, key_size, i;
+	__sz len;
+
+	if (!VIRTIO_FEATURE_HAS(vndev->vdev->features, VIRTIO_NET_F_RSS)) {
+		vndev->ctrl->data.mq.virtqueue_pairs = MAX(vndev->rx_vqueue_nb,
+							   vndev->tx_vqueue_nb);
+		return virtio_netdev_ctrl_cmd(vndev, VIRTIO_NET_CTRL_MQ,
+					      VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET,
+					      sizeof(struct virtio_net_ctrl_mq));
+	}
+
+	/* The indirection table size must be a power of two */
+	reta_size = 1;
+	while ((reta_size << 1) <= MIN(vndev->rss_max_reta_size,
+				       VTNET_RSS_RETA_SIZE))
+		reta_size <<= 1;
+	key_size = MIN(vndev->rss_max_key_size, VTNET_RSS_KEY_SIZE);
+
+	rss = (struct virtio_net_rss_config *)vndev->ctrl->data.rss;
+	rss->hash_types = vndev->rss_hash_types & VTNET_RSS_HASH_TYPES;
+	rss->indirection_table_mask = reta_size - 1;
+	rss->unclassified_queue = 0;
+	for (i = 0; i < reta_size; i++)
+		rss->indirection_table[i] = i % vndev->rx_vqueue_nb;
+
+	tail = (struct virtio_net_rss_config_tail *)
+			&rss->indirection_table[reta_size];
+	tail->max_tx_vq = vndev->tx_vqueue_nb;
+	tail->hash_key_length = key_size;
+	memcpy(tail->hash_key_data, vtnet_rss_key, key_size);
+
+	len = (__sz)(&tail->hash_key_data[key_size] - vndev->ctrl->data.rss);
+	return virtio_netdev_ctrl_cmd(vndev, VIRTIO_NET_CTRL_MQ,
+				      VIRTIO_NET_CTRL_MQ_RSS_CONFIG, len);
+}
+
 /**
  * The Driver method implementation.
  */
@@ -425,8 +579,13 @@ static int virtio_netdev_xmit(struct uk_netdev *dev,
 		vhdr->csum_start   = pkt->csum_start - VTNET_HDR_SIZE_PADDED(vndev);
 		vhdr->csum_offset  = pkt->csum_offset;
 	}
-	if (pkt->flags & UK_NETBUF_F_GSO_TCPV4) {
-		vhdr->gso_type     = VIRTIO_NET_HDR_GSO_TCPV4;
+	if (pkt->flags & UK_NETBUF_F_GSO_MASK) {
+		if (pkt->flags & UK_NETBUF_F_GSO_TCPV4)
+			vhdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		else if (pkt->flags & UK_NETBUF_F_GSO_TCPV6)
+			vhdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+		else
+			vhdr->gso_type = VIRTIO_NET_HDR_GSO_UDP_L4;
 		vhdr->hdr_len      = pkt->header_len;
 		vhdr->gso_size     = pkt->gso_size;
 	}
@@ -462,7 +621,7 @@ static int virtio_netdev_xmit(struct uk_netdev *dev,
 		}
 	}
 
-	if (!(pkt->flags & UK_NETBUF_F_GSO_TCPV4)) {
+	if (!(pkt->flags & UK_NETBUF_F_GSO_MASK)) {
 		total_len = uk_sglist_length(&queue->sg);
 		if (unlikely(total_len > VIRTIO_PKT_BUFFER_LEN(vndev))) {
 			uk_pr_err("Packet size too big: %lu, max:%lu\n",
@@ -560,7 +719,10 @@ static int virtio_netdev_rxq_dequeue(struct virtio_net_device *vndev,
 	int ret;
 	int rc __maybe_unused = 0;
 	struct uk_netbuf *buf = NULL;
+	struct uk_netbuf *seg, *tail;
 	struct virtio_net_hdr *vhdr;
+	__u16 hdr_size = virtio_net_hdr_size(vndev);
+	__u16 nb_bufs = 1;
 	__u32 len;
 
 	UK_ASSERT(netbuf);
@@ -592,15 +754,50 @@ static int virtio_netdev_rxq_dequeue(struct virtio_net_device *vndev,
 		buf->csum_start  = vhdr->csum_start + VTNET_HDR_SIZE_PADDED(vndev);
 	}
 
+	if (VIRTIO_FEATURE_HAS(vndev->vdev->features, VIRTIO_NET_F_MRG_RXBUF))
+		nb_bufs = vhdr->num_buffers;
+
 	/**
 	 * Removing the virtio header from the buffer and adjusting length.
 	 * We pad the rx buffer while enqueuing for alignment of the packet
 	 * data. We compensate for this by subtracting the padding to the
-	 * length on dequeue.
+	 * length on dequeue. The device-reported length includes the
+	 * virtio header.
 	 */
-	buf->len = len + VTNET_HDR_SIZE_PADDED(vndev);
+	buf->len = len - hdr_size + VTNET_HDR_SIZE_PADDED(vndev);
 	rc = uk_netbuf_header(buf, -((__s16)VTNET_HDR_SIZE_PADDED(vndev)));
 	UK_ASSERT(rc == 1);
+
+	/**
+	 * With mergeable receive buffers, a large packet spans multiple
+	 * buffers that are chained to the first one. The device does not
+	 * place a header into the following buffers. Their first bytes land
+	 * in the header slot and are moved in front of the data area so
+	 * that the buffer content becomes contiguous again.
+	 */
+	tail = buf;
+	while (--nb_bufs > 0) {
+		ret = virtqueue_buffer_dequeue(rxq->vq, (void **) &seg, &len);
+		if (unlikely(ret < 0 || len == 0 ||
+			     len > VIRTIO_PKT_BUFFER_LEN(vndev))) {
+			uk_pr_err("Received invalid mergeable buffer (%d, %"__PRIu32")\n",
+				  ret, len);
+			if (ret >= 0)
+				uk_netbuf_free(seg);
+			uk_netbuf_free(buf);
+			*netbuf = NULL;
+			return -EINVAL;
+		}
+
+		memmove((__u8 *) seg->data + VTNET_HDR_SIZE_PADDED(vndev)
+			- hdr_size, seg->data, MIN((__u32) hdr_size, len));
+		seg->data  = (__u8 *) seg->data + VTNET_HDR_SIZE_PADDED(vndev)
+			     - hdr_size;
+		seg->len   = len;
+		seg->flags = 0x0;
+		uk_netbuf_connect(tail, seg);
+		tail = seg;
+	}
 	*netbuf = buf;
 
 	return ret;
@@ -691,7 +888,7 @@ static struct uk_netdev_rx_queue *virtio_netdev_rx_queue_setup(
 	UK_ASSERT(conf->alloc_rxpkts);
 
 	vndev = to_virtionetdev(n);
-	if (queue_id >= vndev->max_vqueue_pairs) {
+	if (queue_id >= vndev->rx_vqueue_nb) {
 		uk_pr_err("Invalid virtqueue identifier: %"__PRIu16"\n",
 			  queue_id);
 		rc = -EINVAL;
@@ -743,13 +940,15 @@ static int virtio_netdev_vqueue_setup(struct virtio_net_device *vndev,
 	__u16 max_desc, hwvq_id;
 	struct virtqueue *vq;
 
+	/* The queues are indexed by the user queue identifier, so that they
+	 * can be set up in any order (e.g., from the CPU serving them).
+	 */
+	id = queue_id;
 	if (queue_type == VNET_RX) {
-		id = vndev->rx_vqueue_cnt;
 		callback = virtio_netdev_recv_done;
 		max_desc = vndev->rxqs[id].max_nb_desc;
 		hwvq_id = vndev->rxqs[id].hwvq_id;
 	} else {
-		id = vndev->tx_vqueue_cnt;
 		/* We don't support the callback from the txqueue yet */
 		callback = NULL;
 		max_desc = vndev->txqs[id].max_nb_desc;
@@ -806,7 +1005,7 @@ static struct uk_netdev_tx_queue *virtio_netdev_tx_queue_setup(
 
 	UK_ASSERT(n);
 	vndev = to_virtionetdev(n);
-	if (queue_id >= vndev->max_vqueue_pairs) {
+	if (queue_id >= vndev->tx_vqueue_nb) {
 		uk_pr_err("Invalid virtqueue identifier: %"__PRIu16"\n",
 			  queue_id);
 		rc = -EINVAL;
@@ -840,7 +1039,7 @@ static int virtio_netdev_rxq_info_get(struct uk_netdev *dev,
 	UK_ASSERT(dev);
 	UK_ASSERT(qinfo);
 	vndev = to_virtionetdev(dev);
-	if (unlikely(queue_id >= vndev->max_vqueue_pairs)) {
+	if (unlikely(queue_id >= vndev->rx_vqueue_nb)) {
 		uk_pr_err("Invalid virtqueue id: %"__PRIu16"\n", queue_id);
 		rc = -EINVAL;
 		goto exit;
@@ -856,7 +1055,7 @@ exit:
 }
 
 static int virtio_netdev_txq_info_get(struct uk_netdev *dev,
-				      __u16 queue_id __unused,
+				      __u16 queue_id,
 				      struct uk_netdev_queue_info *qinfo)
 {
 	struct virtio_net_device *vndev;
@@ -867,7 +1066,7 @@ static int virtio_netdev_txq_info_get(struct uk_netdev *dev,
 	UK_ASSERT(qinfo);
 
 	vndev = to_virtionetdev(dev);
-	if (unlikely(queue_id >= vndev->max_vqueue_pairs)) {
+	if (unlikely(queue_id >= vndev->tx_vqueue_nb)) {
 		uk_pr_err("Invalid queue_id %"__PRIu16"\n", queue_id);
 		rc = -EINVAL;
 		goto exit;
@@ -989,6 +1188,38 @@ static int virtio_netdev_feature_negotiate(struct uk_netdev *n)
 	if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_HOST_TSO4))
 		VIRTIO_FEATURE_SET(drv_features, VIRTIO_NET_F_HOST_TSO4);
 
+	/**
+	 * TCPv6 and UDP Segmentation Offload
+	 * NOTE: These require that the host computes checksums for us.
+	 */
+	if (VIRTIO_FEATURE_HAS(drv_features, VIRTIO_NET_F_CSUM)) {
+		if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_HOST_TSO6))
+			VIRTIO_FEATURE_SET(drv_features,
+					   VIRTIO_NET_F_HOST_TSO6);
+		if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_HOST_USO))
+			VIRTIO_FEATURE_SET(drv_features,
+					   VIRTIO_NET_F_HOST_USO);
+	}
+
+#if CONFIG_LIBVIRTIO_NET_GUEST_TSO
+	/**
+	 * Large receive segments
+	 * NOTE: The host may hand us TCP segments of up to 64KiB. These are
+	 *       received with mergeable receive buffers as netbuf chains.
+	 *       Requires that receive checksums are offloaded.
+	 */
+	if (VIRTIO_FEATURE_HAS(drv_features, VIRTIO_NET_F_GUEST_CSUM) &&
+	    VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_MRG_RXBUF)) {
+		VIRTIO_FEATURE_SET(drv_features, VIRTIO_NET_F_MRG_RXBUF);
+		if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_GUEST_TSO4))
+			VIRTIO_FEATURE_SET(drv_features,
+					   VIRTIO_NET_F_GUEST_TSO4);
+		if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_GUEST_TSO6))
+			VIRTIO_FEATURE_SET(drv_features,
+					   VIRTIO_NET_F_GUEST_TSO6);
+	}
+#endif /* CONFIG_LIBVIRTIO_NET_GUEST_TSO */
+
 	/**
 	 * Use index based event supression when it's available.
 	 * This allows a more fine-grained control when the hypervisor should
@@ -998,6 +1229,34 @@ static int virtio_netdev_feature_negotiate(struct uk_netdev *n)
 	if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_F_EVENT_IDX))
 		VIRTIO_FEATURE_SET(drv_features, VIRTIO_F_EVENT_IDX);
 
+	/**
+	 * Use the packed virtqueue layout when it's available. It is only
+	 * accepted if supported by the transport and the virtio ring.
+	 */
+	if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_F_RING_PACKED) &&
+	    VIRTIO_FEATURE_HAS(host_features, VIRTIO_F_VERSION_1))
+		VIRTIO_FEATURE_SET(drv_features, VIRTIO_F_RING_PACKED);
+
+#if CONFIG_LIBVIRTIO_NET_MQ
+	/**
+	 * Multiple queue pairs
+	 * NOTE: The number of queue pairs in use and the RSS configuration
+	 *       are programmed via the control queue.
+	 */
+	if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_CTRL_VQ)) {
+		VIRTIO_FEATURE_SET(drv_features, VIRTIO_NET_F_CTRL_VQ);
+
+		if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_MQ))
+			VIRTIO_FEATURE_SET(drv_features, VIRTIO_NET_F_MQ);
+#if CONFIG_LIBVIRTIO_NET_RSS
+		if (VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_MQ) &&
+		    VIRTIO_FEATURE_HAS(host_features, VIRTIO_NET_F_RSS) &&
+		    VIRTIO_FEATURE_HAS(host_features, VIRTIO_F_VERSION_1))
+			VIRTIO_FEATURE_SET(drv_features, VIRTIO_NET_F_RSS);
+#endif /* CONFIG_LIBVIRTIO_NET_RSS */
+	}
+#endif /* CONFIG_LIBVIRTIO_NET_MQ */
+
 	/**
 	 * Announce our enabled driver features back to the backend device
 	 */
@@ -1032,6 +1291,50 @@ static int virtio_netdev_feature_negotiate(struct uk_netdev *n)
 		vndev->max_mtu = vndev->mtu = UK_ETH_PAYLOAD_MAXLEN;
 	}
 
+	/**
+	 * The control queue follows the last receive/transmit queue pair
+	 * that is supported by the device.
+	 */
+	vndev->max_vqueue_pairs = 1;
+	if (VIRTIO_FEATURE_HAS(drv_features, VIRTIO_NET_F_MQ)) {
+		virtio_config_get(vndev->vdev,
+				  __offsetof(struct virtio_net_config,
+					     max_virtqueue_pairs),
+				  &vndev->max_vqueue_pairs,
+				  sizeof(vndev->max_vqueue_pairs), 1);
+		if (unlikely(vndev->max_vqueue_pairs <
+			     VIRTIO_NET_CTRL_MQ_VQ_PAIRS_MIN ||
+			     vndev->max_vqueue_pairs >
+			     VIRTIO_NET_CTRL_MQ_VQ_PAIRS_MAX)) {
+			uk_pr_err("%p: Invalid number of queue pairs: %"__PRIu16"\n",
+				  n, vndev->max_vqueue_pairs);
+			rc = -EINVAL;
+			goto err_negotiate_feature;
+		}
+	}
+	vndev->ctrlq_id = 2 * vndev->max_vqueue_pairs;
+
+	if (VIRTIO_FEATURE_HAS(drv_features, VIRTIO_NET_F_RSS)) {
+		virtio_config_get(vndev->vdev,
+				  __offsetof(struct virtio_net_config,
+					     rss_max_key_size),
+				  &vndev->rss_max_key_size,
+				  sizeof(vndev->rss_max_key_size), 1);
+		virtio_config_get(vndev->vdev,
+				  __offsetof(struct virtio_net_config,
+					     rss_max_indirection_table_length),
+				  &vndev->rss_max_reta_size,
+				  sizeof(vndev->rss_max_reta_size), 1);
+		virtio_config_get(vndev->vdev,
+				  __offsetof(struct virtio_net_config,
+					     supported_hash_types),
+				  &vndev->rss_hash_types,
+				  sizeof(vndev->rss_hash_types), 1);
+		uk_pr_debug("%p: RSS key size: %"__PRIu8", table size: %"__PRIu16", hash types: 0x%"__PRIx32"\n",
+			    n, vndev->rss_max_key_size,
+			    vndev->rss_max_reta_size, vndev->rss_hash_types);
+	}
+
 	virtio_dev_status_update(vndev->vdev,
 				 (VIRTIO_CONFIG_STATUS_ACK |
 				  VIRTIO_CONFIG_STATUS_DRIVER |
@@ -1044,22 +1347,69 @@ err_negotiate_feature:
 	return rc;
 }
 
+static int virtio_netdev_ctrlq_setup(struct virtio_net_device *vndev,
+				     __u16 nr_desc)
+{
+	struct virtio_net_ctrl *ctrl;
+	struct virtqueue *vq;
+
+	ctrl = uk_calloc(a, 1, sizeof(*ctrl));
+	if (unlikely(!ctrl))
+		return -ENOMEM;
+
+	vq = virtio_vqueue_setup(vndev->vdev, vndev->ctrlq_id, nr_desc, NULL,
+				 a);
+	if (unlikely(PTRISERR(vq))) {
+		uk_pr_err("Failed to set up control virtqueue\n");
+		uk_free(a, ctrl);
+		return PTR2ERR(vq);
+	}
+
+	/* We poll for the completion of control commands */
+	virtqueue_intr_disable(vq);
+
+	ctrl->vq = vq;
+	uk_sglist_init(&ctrl->sg, ARRAY_SIZE(ctrl->sgsegs), &ctrl->sgsegs[0]);
+	vndev->ctrl = ctrl;
+
+	return 0;
+}
+
 static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 				    const struct uk_netdev_conf *conf)
 {
 	int rc = 0;
 	int i = 0;
 	int vq_avail = 0;
-	int total_vqs = conf->nb_rx_queues + conf->nb_tx_queues;
-	__u16 qdesc_size[total_vqs];
+	int total_vqs;
+	__u16 *qdesc_size;
 
-	if (conf->nb_rx_queues != 1 || conf->nb_tx_queues != 1) {
+	if (conf->nb_rx_queues < 1 ||
+	    conf->nb_rx_queues > vndev->max_vqueue_pairs ||
+	    conf->nb_tx_queues < 1 ||
+	    conf->nb_tx_queues > vndev->max_vqueue_pairs) {
 		uk_pr_err("Queue combination not supported: %"__PRIu16"/%"__PRIu16" rx/tx\n",
 			  conf->nb_rx_queues, conf->nb_tx_queues);
 
 		return -ENOTSUP;
 	}
 
+	/**
+	 * The virtqueue are organized as:
+	 * Virtqueue-rx0
+	 * Virtqueue-tx0
+	 * Virtqueue-rx1
+	 * Virtqueue-tx1
+	 * ...
+	 * Virtqueue-ctrlq
+	 * where the position of the control queue depends on the maximum
+	 * number of queue pairs supported by the device.
+	 */
+	if (VIRTIO_FEATURE_HAS(vndev->vdev->features, VIRTIO_NET_F_CTRL_VQ))
+		total_vqs = vndev->ctrlq_id + 1;
+	else
+		total_vqs = 2 * vndev->max_vqueue_pairs;
+
 	/**
 	 * TODO:
 	 * The virtio device management data structure are allocated using the
@@ -1067,9 +1417,10 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 	 * wiser to move it to the allocator of each individual queue. This
 	 * would better considering NUMA support.
 	 */
-	vndev->rxqs = uk_malloc(a, sizeof(*vndev->rxqs) * conf->nb_rx_queues);
-	vndev->txqs = uk_malloc(a, sizeof(*vndev->txqs) * conf->nb_tx_queues);
-	if (unlikely(!vndev->rxqs || !vndev->txqs)) {
+	vndev->rxqs = uk_calloc(a, conf->nb_rx_queues, sizeof(*vndev->rxqs));
+	vndev->txqs = uk_calloc(a, conf->nb_tx_queues, sizeof(*vndev->txqs));
+	qdesc_size = uk_malloc(a, sizeof(*qdesc_size) * total_vqs);
+	if (unlikely(!vndev->rxqs || !vndev->txqs || !qdesc_size)) {
 		uk_pr_err("Failed to allocate memory for queue management\n");
 		rc = -ENOMEM;
 		goto err_free_txrx;
@@ -1083,16 +1434,7 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 		goto err_free_txrx;
 	}
 
-	/**
-	 * The virtqueue are organized as:
-	 * Virtqueue-rx0
-	 * Virtqueue-tx0
-	 * Virtqueue-rx1
-	 * Virtqueue-tx1
-	 * ...
-	 * Virtqueue-ctrlq
-	 */
-	for (i = 0; i < vndev->max_vqueue_pairs; i++) {
+	for (i = 0; i < conf->nb_rx_queues; i++) {
 		/**
 		 * Initialize the received queue with the information received
 		 * from the device.
@@ -1103,7 +1445,9 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 			       (sizeof(vndev->rxqs[i].sgsegs) /
 				sizeof(vndev->rxqs[i].sgsegs[0])),
 			       &vndev->rxqs[i].sgsegs[0]);
+	}
 
+	for (i = 0; i < conf->nb_tx_queues; i++) {
 		/**
 		 * Initialize the transmit queue with the information received
 		 * from the device.
@@ -1115,14 +1459,27 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 				sizeof(vndev->txqs[i].sgsegs[0])),
 			       &vndev->txqs[i].sgsegs[0]);
 	}
+
+	if (VIRTIO_FEATURE_HAS(vndev->vdev->features, VIRTIO_NET_F_CTRL_VQ) &&
+	    !vndev->ctrl) {
+		rc = virtio_netdev_ctrlq_setup(vndev,
+					       qdesc_size[vndev->ctrlq_id]);
+		if (unlikely(rc < 0))
+			goto err_free_txrx;
+	}
+
+	vndev->rx_vqueue_nb = conf->nb_rx_queues;
+	vndev->tx_vqueue_nb = conf->nb_tx_queues;
+	uk_free(a, qdesc_size);
 exit:
 	return rc;
 
 err_free_txrx:
-	if (!vndev->rxqs)
-		uk_free(a, vndev->rxqs);
-	if (!vndev->txqs)
-		uk_free(a, vndev->txqs);
+	uk_free(a, qdesc_size);
+	uk_free(a, vndev->rxqs);
+	vndev->rxqs = NULL;
+	uk_free(a, vndev->txqs);
+	vndev->txqs = NULL;
 	goto exit;
 }
 
@@ -1196,6 +1553,7 @@ static void virtio_net_info_get(struct uk_netdev *dev,
 
 	dev_info->max_rx_queues = vndev->max_vqueue_pairs;
 	dev_info->max_tx_queues = vndev->max_vqueue_pairs;
+	dev_info->in_queue_pairs = 1;
 	dev_info->max_mtu = vndev->max_mtu;
 	dev_info->nb_encap_tx = VTNET_HDR_SIZE_PADDED(vndev);
 	dev_info->nb_encap_rx = VTNET_HDR_SIZE_PADDED(vndev);
@@ -1208,17 +1566,39 @@ static void virtio_net_info_get(struct uk_netdev *dev,
 				       VIRTIO_NET_F_HOST_TSO4)
 		    || VIRTIO_FEATURE_HAS(vndev->vdev->features,
 					  VIRTIO_NET_F_GSO))
-		   ? UK_NETDEV_F_TSO4 : 0);
+		   ? UK_NETDEV_F_TSO4 : 0)
+		| ((VIRTIO_FEATURE_HAS(vndev->vdev->features,
+				       VIRTIO_NET_F_HOST_TSO6)
+		    || VIRTIO_FEATURE_HAS(vndev->vdev->features,
+					  VIRTIO_NET_F_GSO))
+		   ? UK_NETDEV_F_TSO6 : 0)
+		| (VIRTIO_FEATURE_HAS(vndev->vdev->features,
+				      VIRTIO_NET_F_HOST_USO)
+		   ? UK_NETDEV_F_USO : 0)
+		| ((VIRTIO_FEATURE_HAS(vndev->vdev->features,
+				       VIRTIO_NET_F_GUEST_TSO4)
+		    || VIRTIO_FEATURE_HAS(vndev->vdev->features,
+					  VIRTIO_NET_F_GUEST_TSO6))
+		   ? UK_NETDEV_F_LRO : 0);
 }
 
 static int virtio_net_start(struct uk_netdev *n)
 {
 	struct virtio_net_device *d;
 	int i = 0;
+	int rc;
 
 	UK_ASSERT(n != NULL);
 	d = to_virtionetdev(n);
 
+	/* All configured queues have to be set up */
+	if (unlikely(d->rx_vqueue_cnt != d->rx_vqueue_nb ||
+		     d->tx_vqueue_cnt != d->tx_vqueue_nb)) {
+		uk_pr_err(DRIVER_NAME": %"__PRIu16": Not all queues set up\n",
+			  d->uid);
+		return -EINVAL;
+	}
+
 	/*
 	 * By default, interrupts are disabled and it is up to the user or
 	 * network stack to manually enable them with a call to
@@ -1238,6 +1618,21 @@ static int virtio_net_start(struct uk_netdev *n)
 	 * Set the DRIVER_OK status bit. At this point the device is "live".
 	 */
 	virtio_dev_drv_up(d->vdev);
+
+	/*
+	 * After a reset, the device uses only the first queue pair. Control
+	 * commands must not be sent before DRIVER_OK.
+	 */
+	if (VIRTIO_FEATURE_HAS(d->vdev->features, VIRTIO_NET_F_MQ) &&
+	    (d->rx_vqueue_nb > 1 || d->tx_vqueue_nb > 1)) {
+		rc = virtio_netdev_steering_configure(d);
+		if (unlikely(rc < 0)) {
+			uk_pr_err(DRIVER_NAME": %"__PRIu16": Failed to configure %"__PRIu16"/%"__PRIu16" rx/tx queues: %d\n",
+				  d->uid, d->rx_vqueue_nb, d->tx_vqueue_nb,
+				  rc);
+			return rc;
+		}
+	}
 	uk_pr_info(DRIVER_NAME": %"__PRIu16" started\n", d->uid);
 
 	for (i = 0; i < d->rx_vqueue_cnt; i++)
@@ -1289,10 +1684,7 @@ static int virtio_net_add_dev(struct virtio_dev *vdev)
 	rc = 0;
 	vndev->promisc = 0;
 
-	/**
-	 * TODO:
-	 * Adding multiqueue support for the virtio net driver.
-	 */
+	/* Updated with the device capabilities during feature negotiation */
 	vndev->max_vqueue_pairs = 1;
 	uk_pr_debug("virtio-net device registered with libuknet\n");
 
@@ -0,0 +1,151 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/alloc.h>
+#include <uk/arch/limits.h>
+#include <uk/config.h>
+#include <uk/errptr.h>
+#include <uk/sglist.h>
+#include <uk/test.h>
+#include <virtio/virtio_bus.h>
+#include <virtio/virtio_ring.h>
+#include <virtio/virtqueue.h>
+
+#include "../virtqueue_vring.h"
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+#define TEST_RING_SIZE 4
+#define TEST_CHAIN_LEN 3
+
+#define PACKED_F_AVAIL (1 << VRING_PACKED_DESC_F_AVAIL)
+#define PACKED_F_USED  (1 << VRING_PACKED_DESC_F_USED)
+
+/* Device side of a packed ring */
+struct test_packed_dev {
+	struct vring_packed *ring;
+	__u16 idx;
+	__u8 wrap_counter;
+};
+
+/* Returns whether descriptor `idx` is available in the lap of `wrap` */
+static int test_packed_desc_avail(struct vring_packed *ring, __u16 idx,
+				  __u8 wrap)
+{
+	__u16 flags = ring->desc[idx].flags;
+
+	return !!(flags & PACKED_F_AVAIL) == wrap &&
+	       !!(flags & PACKED_F_USED) != wrap;
+}
+
+/* Writes back the used buffer at the head, skipping `count` descriptors */
+static void test_packed_dev_use(struct test_packed_dev *dev, __u16 count,
+				__u32 len)
+{
+	struct vring_packed_desc *desc = &dev->ring->desc[dev->idx];
+
+	desc->len = len;
+	desc->flags = dev->wrap_counter ? (PACKED_F_AVAIL | PACKED_F_USED) : 0;
+
+	dev->idx += count;
+	if (dev->idx >= dev->ring->num) {
+		dev->idx -= dev->ring->num;
+		dev->wrap_counter ^= 1;
+	}
+}
+
+UK_TESTCASE(virtio_ring, packed_wrap)
+{
+	struct virtio_dev vdev = {
+		.features = 1ULL << VIRTIO_F_RING_PACKED
+	};
+	struct uk_alloc *a = uk_alloc_get_default();
+	struct uk_sglist_seg segs[TEST_CHAIN_LEN];
+	struct uk_sglist sg = {
+		.sg_segs = segs,
+		.sg_nseg = TEST_CHAIN_LEN,
+		.sg_maxseg = TEST_CHAIN_LEN
+	};
+	struct test_packed_dev dev;
+	struct virtqueue_vring *vrq;
+	struct virtqueue *vq;
+	int cookies[TEST_RING_SIZE];
+	void *cookie;
+	__u16 idx;
+	__u32 len;
+	__u8 wrap;
+	int i, j;
+
+	vq = virtqueue_create(0, TEST_RING_SIZE, __PAGE_SIZE, NULL, NULL,
+			      &vdev, a);
+	UK_TEST_EXPECT(!PTRISERR(vq));
+	if (PTRISERR(vq))
+		return;
+	vrq = to_virtqueue_vring(vq);
+	UK_TEST_EXPECT(virtqueue_is_packed(vrq));
+	UK_TEST_EXPECT_SNUM_EQ(virtqueue_vring_get_num(vq), TEST_RING_SIZE);
+
+	dev = (struct test_packed_dev){
+		.ring = &vrq->vring_packed,
+		.idx = 0,
+		.wrap_counter = 1
+	};
+	for (j = 0; j < TEST_CHAIN_LEN; j++) {
+		segs[j].ss_paddr = 0x1000 * (j + 1);
+		segs[j].ss_len = 64;
+	}
+
+	/* Chains of 3 in a ring of 4 wrap within a chain and at its end */
+	for (i = 0; i < TEST_RING_SIZE; i++) {
+		UK_TEST_EXPECT(!virtqueue_hasdata(vq));
+		UK_TEST_EXPECT_SNUM_EQ(virtqueue_buffer_enqueue(vq, &cookies[i],
+								&sg, 1, 2),
+				       TEST_RING_SIZE - TEST_CHAIN_LEN);
+
+		/* The whole chain is available to the device in its lap */
+		idx = dev.idx;
+		wrap = dev.wrap_counter;
+		for (j = 0; j < TEST_CHAIN_LEN; j++) {
+			UK_TEST_EXPECT(test_packed_desc_avail(dev.ring, idx,
+							      wrap));
+			UK_TEST_EXPECT_SNUM_EQ(dev.ring->desc[idx].addr,
+					       segs[j].ss_paddr);
+			if (++idx == TEST_RING_SIZE) {
+				idx = 0;
+				wrap ^= 1;
+			}
+		}
+
+		UK_TEST_EXPECT_SNUM_EQ(virtqueue_buffer_dequeue(vq, &cookie,
+								&len),
+				       -ENOMSG);
+		test_packed_dev_use(&dev, TEST_CHAIN_LEN, 100 + i);
+		UK_TEST_EXPECT(virtqueue_hasdata(vq));
+		UK_TEST_EXPECT_ZERO(virtqueue_buffer_dequeue(vq, &cookie,
+							     &len));
+		UK_TEST_EXPECT_PTR_EQ(cookie, &cookies[i]);
+		UK_TEST_EXPECT_SNUM_EQ(len, 100 + i);
+	}
+
+	/* 12 descriptors went through a ring of 4: three laps */
+	UK_TEST_EXPECT_SNUM_EQ(dev.idx, 0);
+	UK_TEST_EXPECT_SNUM_EQ(dev.wrap_counter, 0);
+	UK_TEST_EXPECT_SNUM_EQ(vrq->avail_wrap_counter, 0);
+	UK_TEST_EXPECT_SNUM_EQ(vrq->used_wrap_counter, 0);
+
+	/* Event suppression set by the device */
+	dev.ring->device->flags = VRING_PACKED_EVENT_FLAG_DISABLE;
+	UK_TEST_EXPECT(!virtqueue_notify_enabled(vq));
+	dev.ring->device->flags = VRING_PACKED_EVENT_FLAG_ENABLE;
+	UK_TEST_EXPECT(virtqueue_notify_enabled(vq));
+
+#ifndef CONFIG_LIBUKVMEM
+	/* Only heap-allocated rings can be freed */
+	virtqueue_destroy(vq, a);
+#endif /* !CONFIG_LIBUKVMEM */
+}
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
+uk_testsuite_register(virtio_ring, NULL);
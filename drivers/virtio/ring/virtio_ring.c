@@ -44,6 +44,7 @@
 #include <virtio/virtio_ring.h>
 #include <virtio/virtqueue.h>
 #include <virtio/virtio_bus.h>
+#include "virtqueue_vring.h"
 #ifdef CONFIG_LIBUKVMEM
 #include <uk/arch/paging.h>
 #include <uk/plat/paging.h>
@@ -52,29 +53,6 @@
 #endif /* CONFIG_LIBUKVMEM */
 
 #define VIRTQUEUE_MAX_SIZE  32768
-#define to_virtqueue_vring(vq)			\
-	__containerof(vq, struct virtqueue_vring, vq)
-
-struct virtqueue_desc_info {
-	void *cookie;
-	__u16 desc_count;
-};
-
-struct virtqueue_vring {
-	struct virtqueue vq;
-	/* Descriptor Ring */
-	struct vring vring;
-	/* Reference to the vring */
-	void   *vring_mem;
-	/* Keep track of available descriptors */
-	__u16 desc_avail;
-	/* Index of the next available slot */
-	__u16 head_free_desc;
-	/* Index of the last used descriptor by the host */
-	__u16 last_used_desc_idx;
-	/* Cookie to identify driver buffer */
-	struct virtqueue_desc_info vq_info[];
-};
 
 /**
  * Static function Declaration(s).
@@ -92,6 +70,196 @@ static inline int virtqueue_buffer_enqueue_segments(
 static void virtqueue_vring_init(struct virtqueue_vring *vrq, __u16 nr_desc,
 				 __u16 align);
 
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+/**
+ * Packed ring implementation
+ *
+ * Instead of separate descriptor, available, and used rings, the driver and
+ * the device exchange buffers through a single descriptor ring. The driver
+ * makes descriptors available by flipping their AVAIL/USED flags according to
+ * its wrap counter and the device writes back used descriptors in place. This
+ * way, a buffer touches a single ring entry instead of three structures.
+ */
+static inline int virtqueue_packed_desc_is_used(struct virtqueue_vring *vrq,
+						__u16 idx, __u8 wrap_counter)
+{
+	__u16 flags;
+	__u8 avail, used;
+
+	flags = *(volatile __virtio_le16 *)&vrq->vring_packed.desc[idx].flags;
+	avail = !!(flags & (1 << VRING_PACKED_DESC_F_AVAIL));
+	used = !!(flags & (1 << VRING_PACKED_DESC_F_USED));
+
+	return (avail == used) && (used == wrap_counter);
+}
+
+static inline int virtqueue_packed_hasdata(struct virtqueue_vring *vrq)
+{
+	return virtqueue_packed_desc_is_used(vrq, vrq->last_used_desc_idx,
+					     vrq->used_wrap_counter);
+}
+
+static int virtqueue_packed_notify_enabled(struct virtqueue_vring *vrq)
+{
+	__u16 flags, off_wrap, event_idx, old, new;
+
+	/**
+	 * Make sure the device sees the descriptors that we made available
+	 * before we read its event suppression settings. Otherwise, we might
+	 * miss a notification request that the device issued meanwhile.
+	 */
+	mb();
+	flags = vrq->vring_packed.device->flags;
+	if (flags != VRING_PACKED_EVENT_FLAG_DESC) {
+		vrq->avail_added = 0;
+		return (flags != VRING_PACKED_EVENT_FLAG_DISABLE);
+	}
+
+	/* The device wants to be notified once a specific descriptor was
+	 * made available. Check if it is among the ones that we added since
+	 * the last notification.
+	 */
+	new = vrq->next_avail_idx;
+	old = new - vrq->avail_added;
+	vrq->avail_added = 0;
+
+	off_wrap = vrq->vring_packed.device->off_wrap;
+	event_idx = off_wrap & ~(1 << VRING_PACKED_EVENT_F_WRAP_CTR);
+	if ((off_wrap >> VRING_PACKED_EVENT_F_WRAP_CTR) !=
+	    vrq->avail_wrap_counter)
+		event_idx -= vrq->vring_packed.num;
+
+	return vring_need_event(event_idx, new, old);
+}
+
+static int virtqueue_packed_buffer_dequeue(struct virtqueue_vring *vrq,
+					   void **cookie, __u32 *len)
+{
+	struct vring_packed_desc *desc;
+	struct virtqueue_desc_info *vq_info;
+	__u16 id;
+
+	if (!virtqueue_packed_hasdata(vrq))
+		return -ENOMSG;
+
+	/**
+	 * We are reading the used descriptor written by the host only after
+	 * we saw its flags.
+	 */
+	rmb();
+	desc = &vrq->vring_packed.desc[vrq->last_used_desc_idx];
+	id = desc->id;
+	UK_ASSERT(id < vrq->vring_packed.num);
+
+	vq_info = &vrq->vq_info[id];
+	UK_ASSERT(vq_info->cookie);
+	if (len)
+		*len = desc->len;
+	*cookie = vq_info->cookie;
+
+	/* The device skips over the whole descriptor chain of the buffer */
+	vrq->desc_avail += vq_info->desc_count;
+	vrq->last_used_desc_idx += vq_info->desc_count;
+	if (vrq->last_used_desc_idx >= vrq->vring_packed.num) {
+		vrq->last_used_desc_idx -= vrq->vring_packed.num;
+		vrq->used_wrap_counter ^= 1;
+	}
+
+	/* Return the buffer id to the free list */
+	vq_info->cookie = NULL;
+	vq_info->desc_count = 0;
+	vq_info->next = vrq->head_free_desc;
+	vrq->head_free_desc = id;
+
+	return (vrq->vring_packed.num - vrq->desc_avail);
+}
+
+static int virtqueue_packed_buffer_enqueue(struct virtqueue_vring *vrq,
+					   void *cookie, struct uk_sglist *sg,
+					   __u16 read_bufs, __u16 write_bufs)
+{
+	struct vring_packed_desc *desc;
+	struct uk_sglist_seg *segs;
+	__u16 total_desc, head, idx, id, flags, head_flags = 0;
+	int i;
+
+	total_desc = read_bufs + write_bufs;
+
+	/* Get a free buffer id */
+	id = vrq->head_free_desc;
+	UK_ASSERT(id < vrq->vring_packed.num);
+	vrq->head_free_desc = vrq->vq_info[id].next;
+	vrq->vq_info[id].cookie = cookie;
+	vrq->vq_info[id].desc_count = total_desc;
+
+	head = idx = vrq->next_avail_idx;
+	for (i = 0; i < total_desc; i++) {
+		segs = &sg->sg_segs[i];
+		desc = &vrq->vring_packed.desc[idx];
+		desc->addr = segs->ss_paddr;
+		desc->len = segs->ss_len;
+		desc->id = id;
+
+		flags = vrq->avail_used_flags;
+		if (i >= read_bufs)
+			flags |= VRING_DESC_F_WRITE;
+		if (i < total_desc - 1)
+			flags |= VRING_DESC_F_NEXT;
+
+		/* The flags of the head are written last to publish the
+		 * whole chain at once
+		 */
+		if (i == 0)
+			head_flags = flags;
+		else
+			desc->flags = flags;
+
+		if (++idx >= vrq->vring_packed.num) {
+			idx = 0;
+			vrq->avail_wrap_counter ^= 1;
+			vrq->avail_used_flags ^=
+				(1 << VRING_PACKED_DESC_F_AVAIL) |
+				(1 << VRING_PACKED_DESC_F_USED);
+		}
+	}
+
+	vrq->next_avail_idx = idx;
+	vrq->desc_avail -= total_desc;
+	vrq->avail_added += total_desc;
+
+	uk_pr_debug("Old head:%d, new head:%d, total_desc:%d\n",
+		    head, idx, total_desc);
+
+	/**
+	 * Write barrier to make sure the device sees the descriptors of the
+	 * chain before the head becomes available.
+	 */
+	wmb();
+	vrq->vring_packed.desc[head].flags = head_flags;
+
+	return vrq->desc_avail;
+}
+
+static void virtqueue_vring_packed_init(struct virtqueue_vring *vrq,
+					__u16 nr_desc)
+{
+	int i = 0;
+
+	vring_packed_init(&vrq->vring_packed, nr_desc, vrq->vring_mem);
+
+	vrq->desc_avail = nr_desc;
+	vrq->head_free_desc = 0;
+	vrq->last_used_desc_idx = 0;
+	vrq->next_avail_idx = 0;
+	vrq->avail_added = 0;
+	vrq->avail_wrap_counter = 1;
+	vrq->used_wrap_counter = 1;
+	vrq->avail_used_flags = 1 << VRING_PACKED_DESC_F_AVAIL;
+	for (i = 0; i < nr_desc; i++)
+		vrq->vq_info[i].next = i + 1;
+}
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 /**
  * Driver implementation
  */
@@ -103,6 +271,14 @@ void virtqueue_intr_disable(struct virtqueue *vq)
 
 	vrq = to_virtqueue_vring(vq);
 
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vrq)) {
+		vrq->vring_packed.driver->flags =
+			VRING_PACKED_EVENT_FLAG_DISABLE;
+		return;
+	}
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	if (vq->uses_event_idx) {
 		vring_used_event(&vrq->vring) =
 			vrq->last_used_desc_idx - vrq->vring.num - 1;
@@ -121,6 +297,12 @@ int virtqueue_intr_enable(struct virtqueue *vq)
 	vrq = to_virtqueue_vring(vq);
 	/* Check if there are no more packets enabled */
 	if (!virtqueue_hasdata(vq)) {
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+		if (virtqueue_is_packed(vrq)) {
+			vrq->vring_packed.driver->flags =
+				VRING_PACKED_EVENT_FLAG_ENABLE;
+		} else
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
 		if (vq->uses_event_idx) {
 			/* TODO: This allows delaying the interrupts by a
 			 *       adjustable count of descriptors. This is could
@@ -206,6 +388,12 @@ int virtqueue_notify_enabled(struct virtqueue *vq)
 
 	UK_ASSERT(vq);
 	vrq = to_virtqueue_vring(vq);
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vrq))
+		return virtqueue_packed_notify_enabled(vrq);
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	if (vq->uses_event_idx) {
 		new = vrq->vring.avail->idx;
 		/* TODO: Use the actually submitted count instead of assuming
@@ -254,6 +442,12 @@ int virtqueue_hasdata(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	vring = to_virtqueue_vring(vq);
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vring))
+		return virtqueue_packed_hasdata(vring);
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	return (vring->last_used_desc_idx != vring->vring.used->idx);
 }
 
@@ -261,10 +455,16 @@ __u64 virtqueue_feature_negotiate(__u64 feature_set)
 {
 	__u64 feature = (1ULL << VIRTIO_TRANSPORT_F_START) - 1;
 
+	/* Allow device-specific feature bits 50 and above (e.g., RSS) */
+	feature |= ~((1ULL << VIRTIO_DEV_F_HIGH_START) - 1);
 	/* Allow version 1 flag */
 	feature |= 1ULL << VIRTIO_F_VERSION_1;
 	/* Allow event index feature */
 	feature |= 1ULL << VIRTIO_F_EVENT_IDX;
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	/* Allow packed virtqueues */
+	feature |= 1ULL << VIRTIO_F_RING_PACKED;
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
 
 	feature &= feature_set;
 	return feature;
@@ -304,6 +504,15 @@ __paddr_t virtqueue_get_avail_addr(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	vrq = to_virtqueue_vring(vq);
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	/* For packed rings, this is the driver event suppression area */
+	if (virtqueue_is_packed(vrq))
+		return virtqueue_physaddr(vq) +
+			((char *)vrq->vring_packed.driver -
+			 (char *)vrq->vring_packed.desc);
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	return virtqueue_physaddr(vq) +
 		((char *)vrq->vring.avail - (char *)vrq->vring.desc);
 }
@@ -315,6 +524,15 @@ __paddr_t virtqueue_get_used_addr(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	vrq = to_virtqueue_vring(vq);
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	/* For packed rings, this is the device event suppression area */
+	if (virtqueue_is_packed(vrq))
+		return virtqueue_physaddr(vq) +
+			((char *)vrq->vring_packed.device -
+			 (char *)vrq->vring_packed.desc);
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	return virtqueue_physaddr(vq) +
 		((char *)vrq->vring.used - (char *)vrq->vring.desc);
 }
@@ -326,6 +544,12 @@ unsigned int virtqueue_vring_get_num(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	vrq = to_virtqueue_vring(vq);
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vrq))
+		return vrq->vring_packed.num;
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	return vrq->vring.num;
 }
 
@@ -339,6 +563,11 @@ int virtqueue_buffer_dequeue(struct virtqueue *vq, void **cookie, __u32 *len)
 	UK_ASSERT(cookie);
 	vrq = to_virtqueue_vring(vq);
 
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vrq))
+		return virtqueue_packed_buffer_dequeue(vrq, cookie, len);
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	/* No new descriptor since last dequeue operation */
 	if (!virtqueue_hasdata(vq))
 		return -ENOMSG;
@@ -370,7 +599,8 @@ int virtqueue_buffer_enqueue(struct virtqueue *vq, void *cookie,
 
 	vrq = to_virtqueue_vring(vq);
 	total_desc = read_bufs + write_bufs;
-	if (unlikely(total_desc < 1 || total_desc > vrq->vring.num)) {
+	if (unlikely(total_desc < 1 ||
+		     total_desc > virtqueue_vring_get_num(vq))) {
 		uk_pr_err("%"__PRIu32" invalid number of descriptor\n",
 			  total_desc);
 		return -EINVAL;
@@ -379,9 +609,16 @@ int virtqueue_buffer_enqueue(struct virtqueue *vq, void *cookie,
 			  vrq->desc_avail, total_desc);
 		return -ENOSPC;
 	}
+	UK_ASSERT(cookie);
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vrq))
+		return virtqueue_packed_buffer_enqueue(vrq, cookie, sg,
+						       read_bufs, write_bufs);
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+
 	/* Get the head of free descriptor */
 	head_idx = vrq->head_free_desc;
-	UK_ASSERT(cookie);
 	/* Additional information to reconstruct the data buffer */
 	vrq->vq_info[head_idx].cookie = cookie;
 	vrq->vq_info[head_idx].desc_count = total_desc;
@@ -447,6 +684,12 @@ struct virtqueue *virtqueue_create(__u16 queue_id, __u16 nr_descs, __u16 align,
 	 */
 	vrq->vring_mem = NULL;
 
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	vrq->packed = VIRTIO_FEATURE_HAS(vdev->features, VIRTIO_F_RING_PACKED);
+	if (virtqueue_is_packed(vrq))
+		ring_size = vring_packed_size(nr_descs);
+	else
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
 	ring_size = vring_size(nr_descs, align);
 #ifdef CONFIG_LIBUKVMEM
 	struct uk_pagetable *pt = ukplat_pt_get_active();
@@ -474,6 +717,11 @@ struct virtqueue *virtqueue_create(__u16 queue_id, __u16 nr_descs, __u16 align,
 	}
 #endif /* !CONFIG_LIBUKVMEM */
 	memset(vrq->vring_mem, 0, ring_size);
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	if (virtqueue_is_packed(vrq))
+		virtqueue_vring_packed_init(vrq, nr_descs);
+	else
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
 	virtqueue_vring_init(vrq, nr_descs, align);
 
 	vq = &vrq->vq;
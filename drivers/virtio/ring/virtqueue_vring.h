@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+/* Internal state of a virtqueue, shared with the unit tests */
+
+#ifndef __VIRTIO_VIRTQUEUE_VRING_H__
+#define __VIRTIO_VIRTQUEUE_VRING_H__
+
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <virtio/virtio_ring.h>
+#include <virtio/virtqueue.h>
+
+#define to_virtqueue_vring(vq)			\
+	__containerof(vq, struct virtqueue_vring, vq)
+
+struct virtqueue_desc_info {
+	void *cookie;
+	__u16 desc_count;
+	/* Next free buffer id (packed ring only) */
+	__u16 next;
+};
+
+struct virtqueue_vring {
+	struct virtqueue vq;
+	/* Descriptor Ring */
+	struct vring vring;
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+	/* Packed descriptor ring (if VIRTIO_F_RING_PACKED) */
+	struct vring_packed vring_packed;
+	/* The ring uses the packed layout */
+	__u8 packed;
+	/* Driver and device ring wrap counters */
+	__u8 avail_wrap_counter;
+	__u8 used_wrap_counter;
+	/* AVAIL/USED flags for descriptors made available in this lap */
+	__u16 avail_used_flags;
+	/* Index of the next descriptor slot to make available */
+	__u16 next_avail_idx;
+	/* Number of descriptors made available since the last notification */
+	__u16 avail_added;
+#endif /* CONFIG_LIBVIRTIO_RING_PACKED */
+	/* Reference to the vring */
+	void   *vring_mem;
+	/* Keep track of available descriptors */
+	__u16 desc_avail;
+	/* Index of the next available slot (next free buffer id if packed) */
+	__u16 head_free_desc;
+	/* Index of the last used descriptor by the host */
+	__u16 last_used_desc_idx;
+	/* Cookie to identify driver buffer */
+	struct virtqueue_desc_info vq_info[];
+};
+
+#ifdef CONFIG_LIBVIRTIO_RING_PACKED
+#define virtqueue_is_packed(vrq)	((vrq)->packed)
+#else /* CONFIG_LIBVIRTIO_RING_PACKED */
+#define virtqueue_is_packed(vrq)	0
+#endif /* !CONFIG_LIBVIRTIO_RING_PACKED */
+
+#endif /* __VIRTIO_VIRTQUEUE_VRING_H__ */
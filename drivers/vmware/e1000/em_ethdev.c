@@ -432,6 +432,7 @@ eth_em_infos_get(__unused struct uk_netdev *dev, struct uk_netdev_info *dev_info
 
 	dev_info->max_mtu = EM_TX_MAX_MTU_SEG;
 	dev_info->ioalign = EM_RXD_ALIGN;
+	dev_info->features = UK_NETDEV_F_PARTIAL_CSUM | UK_NETDEV_F_TSO4;
 }
 
 /* return 0 means link status changed, -1 means not changed */
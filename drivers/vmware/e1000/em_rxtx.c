@@ -14,6 +14,8 @@
 #include <e1000/e1000_api.h>
 #include <e1000/e1000_ethdev.h>
 #include <e1000/e1000_osdep.h>
+#include <uk/netdev_driver.h>
+#include <uk/netstructs.h>
 
 #define	E1000_TXD_VLAN_SHIFT	16
 
@@ -84,42 +86,12 @@ struct em_rx_queue {
 };
 typedef struct em_rx_queue uk_netdev_rx_queue;
 
-/**
- * Hardware context number
- */
-enum {
-	EM_CTX_0    = 0, /**< CTX0 */
-	EM_CTX_NUM  = 1, /**< CTX NUM */
-};
-
-/** Offload features */
-union em_vlan_macip {
-	uint32_t data;
-	struct {
-		uint16_t l3_len:9; /**< L3 (IP) Header Length. */
-		uint16_t l2_len:7; /**< L2 (MAC) Header Length. */
-		uint16_t vlan_tci;
-		/**< VLAN Tag Control Identifier (CPU order). */
-	} f;
-};
-
-/*
- * Compare mask for vlan_macip_len.data,
- * should be in sync with em_vlan_macip.f layout.
- * */
-#define TX_VLAN_CMP_MASK        0xFFFF0000  /**< VLAN length - 16-bits. */
-#define TX_MAC_LEN_CMP_MASK     0x0000FE00  /**< MAC length - 7-bits. */
-#define TX_IP_LEN_CMP_MASK      0x000001FF  /**< IP  length - 9-bits. */
-/** MAC+IP  length. */
-#define TX_MACIP_LEN_CMP_MASK   (TX_MAC_LEN_CMP_MASK | TX_IP_LEN_CMP_MASK)
-
 /**
  * Structure to check if new context need be built
  */
 struct em_ctx_info {
-	uint64_t flags;              /**< ol_flags related to context build. */
-	uint32_t cmp_mask;           /**< compare mask */
-	union em_vlan_macip hdrlen;  /**< L2 and L3 header lenghts */
+	struct e1000_context_desc desc; /**< Last context written to the ring */
+	uint8_t valid;                  /**< `desc` holds a context */
 };
 
 /**
@@ -228,6 +200,71 @@ em_xmit_cleanup(struct em_tx_queue *txq)
 	return 0;
 }
 
+/*
+ * Builds the offload context for a packet. Returns 1 if the packet needs a
+ * context, 0 if it does not, or a negative error code. `cmd` and `popts`
+ * receive the bits to set in the data descriptors of the packet.
+ */
+static int
+em_tx_ctx_build(struct uk_netbuf *pkt, struct e1000_context_desc *ctx,
+		uint32_t *cmd, uint32_t *popts)
+{
+	struct uk_netbuf *m_seg;
+	uint32_t paylen = 0;
+	uint16_t l3off, l4off;
+	uint16_t csum_off;
+	int rc;
+
+	memset(ctx, 0, sizeof(*ctx));
+	*cmd = 0;
+	*popts = 0;
+
+	if (pkt->flags & UK_NETBUF_F_GSO_TCPV4) {
+		rc = uk_netdev_drv_tso_prepare(pkt, &l3off, &l4off);
+		if (unlikely(rc < 0))
+			return rc;
+		/* Header length and offsets are 8 bit fields */
+		if (unlikely(pkt->header_len > UINT8_MAX))
+			return -EINVAL;
+
+		UK_NETBUF_CHAIN_FOREACH(m_seg, pkt)
+			paylen += m_seg->len;
+		paylen -= pkt->header_len;
+
+		ctx->lower_setup.ip_fields.ipcss = l3off;
+		ctx->lower_setup.ip_fields.ipcso =
+			l3off + __offsetof(struct uk_iphdr, ip_sum);
+		ctx->lower_setup.ip_fields.ipcse = l4off - 1;
+		ctx->upper_setup.tcp_fields.tucss = l4off;
+		ctx->upper_setup.tcp_fields.tucso =
+			l4off + __offsetof(struct uk_tcphdr, th_sum);
+		ctx->cmd_and_length = E1000_TXD_CMD_DEXT | E1000_TXD_DTYP_C |
+			E1000_TXD_CMD_TSE | E1000_TXD_CMD_IP |
+			E1000_TXD_CMD_TCP | paylen;
+		ctx->tcp_seg_setup.fields.hdr_len = pkt->header_len;
+		ctx->tcp_seg_setup.fields.mss = pkt->gso_size;
+
+		*cmd = E1000_TXD_CMD_TSE;
+		*popts = (E1000_TXD_POPTS_IXSM | E1000_TXD_POPTS_TXSM) << 8;
+		return 1;
+	}
+
+	if (pkt->flags & UK_NETBUF_F_PARTIAL_CSUM) {
+		csum_off = pkt->csum_start + pkt->csum_offset;
+		if (unlikely(csum_off > UINT8_MAX ||
+			     csum_off + sizeof(uint16_t) > pkt->len))
+			return -EINVAL;
+
+		ctx->upper_setup.tcp_fields.tucss = pkt->csum_start;
+		ctx->upper_setup.tcp_fields.tucso = csum_off;
+		ctx->cmd_and_length = E1000_TXD_CMD_DEXT | E1000_TXD_DTYP_C;
+
+		*popts = E1000_TXD_POPTS_TXSM << 8;
+		return 1;
+	}
+	return 0;
+}
+
 int eth_em_xmit_pkts(__unused struct uk_netdev *dev,
 	struct uk_netdev_tx_queue *queue,
 	struct uk_netbuf *pkt)
@@ -248,6 +285,10 @@ int eth_em_xmit_pkts(__unused struct uk_netdev *dev,
 	uint16_t nb_tx;
 	uint16_t nb_used;
 	uint32_t new_ctx;
+	struct e1000_context_desc ctx;
+	volatile struct e1000_context_desc *ctxd;
+	uint32_t cmd_offload;
+	int rc;
 
 	txq = (struct em_tx_queue *) queue;
 	sw_ring = txq->sw_ring;
@@ -261,15 +302,25 @@ int eth_em_xmit_pkts(__unused struct uk_netdev *dev,
 	 }
 
 	for (nb_tx = 0; nb_tx < 1; nb_tx++) {
-		new_ctx = 0;
 		tx_pkt = pkt;
 
+		rc = em_tx_ctx_build(tx_pkt, &ctx, &cmd_offload, &popts_spec);
+		if (unlikely(rc < 0))
+			return rc;
+
+		/* Only write a context if it differs from the current one */
+		new_ctx = rc > 0 && (!txq->ctx_cache.valid ||
+				     memcmp(&txq->ctx_cache.desc, &ctx,
+					    sizeof(ctx)));
+
 		/*
 		 * Keep track of how many descriptors are used this loop
 		 * This will always be the number of segments + the number of
 		 * Context descriptors required to transmit the packet
 		 */
-		nb_used = (uint16_t)(1 + new_ctx);
+		nb_used = (uint16_t) new_ctx;
+		for (m_seg = tx_pkt; m_seg != NULL; m_seg = m_seg->next)
+			nb_used++;
 
 		/*
 		 * The number of descriptors that must be allocated for a
@@ -330,8 +381,31 @@ int eth_em_xmit_pkts(__unused struct uk_netdev *dev,
 		 *   - E1000_TXD_CMD_RS
 		 */
 		cmd_type_len = E1000_TXD_CMD_DEXT | E1000_TXD_DTYP_D |
-			E1000_TXD_CMD_IFCS;
-		popts_spec = 0;
+			E1000_TXD_CMD_IFCS | cmd_offload;
+
+		if (new_ctx) {
+			ctxd = (volatile struct e1000_context_desc *)
+				&txr[tx_id];
+			txn = &sw_ring[txe->next_id];
+
+			if (txe->mbuf != NULL) {
+				uk_netbuf_free_single(txe->mbuf);
+				txe->mbuf = NULL;
+			}
+
+			ctxd->lower_setup.ip_config = ctx.lower_setup.ip_config;
+			ctxd->upper_setup.tcp_config =
+				ctx.upper_setup.tcp_config;
+			ctxd->cmd_and_length = ctx.cmd_and_length;
+			ctxd->tcp_seg_setup.data = ctx.tcp_seg_setup.data;
+
+			txq->ctx_cache.desc = ctx;
+			txq->ctx_cache.valid = 1;
+
+			txe->last_id = tx_last;
+			tx_id = txe->next_id;
+			txe = txn;
+		}
 
 		m_seg = tx_pkt;
 		do {
@@ -346,8 +420,8 @@ int eth_em_xmit_pkts(__unused struct uk_netdev *dev,
 			/*
 			 * Set up Transmit Data Descriptor.
 			 */
-			slen = m_seg->buflen;
-			buf_dma_addr = (uint64_t) m_seg->buf;
+			slen = m_seg->len;
+			buf_dma_addr = (uint64_t) m_seg->data;
 
 			txd->buffer_addr = buf_dma_addr;
 			txd->lower.data = cmd_type_len | slen;
@@ -494,6 +568,15 @@ eth_em_recv_pkts(__unused struct uk_netdev *dev, struct uk_netdev_rx_queue *rx_q
 		rxm->buflen = pkt_len;
 		rxm->len = pkt_len;
 		rxm->next = NULL;
+
+		/*
+		 * The device verified the TCP/UDP (and IPv4) checksums,
+		 * unless it skipped them (IXSM) or found an error.
+		 */
+		if (!(rxd.status & E1000_RXD_STAT_IXSM) &&
+		    (rxd.status & E1000_RXD_STAT_TCPCS) &&
+		    !(rxd.errors & (E1000_RXD_ERR_TCPE | E1000_RXD_ERR_IPE)))
+			rxm->flags |= UK_NETBUF_F_DATA_VALID;
 		ret_status |= UK_NETDEV_STATUS_SUCCESS;
 
 		/*
@@ -1013,9 +1096,11 @@ eth_em_rx_init(struct e1000_hw *hw)
 	/*
 	 * Setup the Checksum Register.
 	 * Receive Full-Packet Checksum Offload is mutually exclusive with RSS.
+	 * IP and TCP/UDP checksums are validated by the device and reported
+	 * in the descriptor status.
 	 */
 	rxcsum = E1000_READ_REG(hw, E1000_RXCSUM);
-	rxcsum &= ~E1000_RXCSUM_IPOFL;
+	rxcsum |= E1000_RXCSUM_IPOFL | E1000_RXCSUM_TUOFL;
 	E1000_WRITE_REG(hw, E1000_RXCSUM, rxcsum);
 
 	/* No MRQ or RSS support for now */
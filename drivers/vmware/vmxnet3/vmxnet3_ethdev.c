@@ -443,6 +443,8 @@ vmxnet3_setup_driver_shared(struct uk_netdev *dev)
 	devRead->misc.mtu = mtu;
 	devRead->misc.queueDescPA  = hw->queueDescPA;
 	devRead->misc.queueDescLen = hw->queue_desc_len;
+	/* Report the checksum validation result in the completion */
+	devRead->misc.uptFeatures = UPT1_F_RXCSUM;
 	devRead->misc.numTxQueues  = hw->num_tx_queues;
 	devRead->misc.numRxQueues  = hw->num_rx_queues;
 
@@ -646,6 +648,8 @@ vmxnet3_dev_info_get(struct uk_netdev *dev __unused,
 	dev_info->max_rx_queues = VMXNET3_MAX_RX_QUEUES;
 	dev_info->max_tx_queues = VMXNET3_MAX_TX_QUEUES;
 	dev_info->max_mtu = VMXNET3_MAX_MTU;
+	dev_info->features = UK_NETDEV_F_PARTIAL_CSUM | UK_NETDEV_F_TSO4 |
+			     UK_NETDEV_F_TSO6;
 }
 
 static int
@@ -14,6 +14,7 @@
 #include <vmxnet3/base/vmxnet3_defs.h>
 #include <vmxnet3/vmxnet3_ring.h>
 #include <vmxnet3/vmxnet3_ethdev.h>
+#include <uk/netdev_driver.h>
 
 #define to_vmxnet3dev(ndev) \
 	__containerof(ndev, struct vmxnet3_hw, netdev)
@@ -273,7 +274,14 @@ int vmxnet3_xmit_pkts(__unused struct uk_netdev *dev,
 		struct uk_netbuf *m_seg = txm;
 		int copy_size = 0;
 		/* # of descriptors needed for a packet. */
-		unsigned count = 1;
+		unsigned count = 0;
+		uint16_t l3off, l4off;
+		uint32_t paylen;
+		int rc;
+
+		for (; m_seg != NULL; m_seg = m_seg->next)
+			count++;
+		m_seg = txm;
 
 		avail = vmxnet3_cmd_ring_desc_avail(&txq->cmd_ring);
 		if (count > avail) {
@@ -308,8 +316,21 @@ int vmxnet3_xmit_pkts(__unused struct uk_netdev *dev,
 			continue;
 		}
 
+		if (txm->flags & (UK_NETBUF_F_GSO_TCPV4 |
+				  UK_NETBUF_F_GSO_TCPV6)) {
+			rc = uk_netdev_drv_tso_prepare(txm, &l3off, &l4off);
+			if (unlikely(rc < 0))
+				return rc;
+			paylen = 0;
+			for (; m_seg != NULL; m_seg = m_seg->next)
+				paylen += m_seg->len;
+			paylen -= txm->header_len;
+			m_seg = txm;
+		}
+
 		debug_uk_pr_info("txm->len = %d, txq->txdata_desc_size = %d\n", txm->len, txq->txdata_desc_size);
-		if (txm->len <= txq->txdata_desc_size) {
+		/* Only packets within a single netbuf fit the data ring */
+		if (!txm->next && txm->len <= txq->txdata_desc_size) {
 			struct Vmxnet3_TxDataDesc *tdd;
 			tdd = (struct Vmxnet3_TxDataDesc *)
 				((uint8 *)txq->data_ring.base +
@@ -317,7 +338,7 @@ int vmxnet3_xmit_pkts(__unused struct uk_netdev *dev,
 				 txq->txdata_desc_size);
 			
 			copy_size = txm->len;
-			memcpy(tdd->data, txm->buf, copy_size);
+			memcpy(tdd->data, txm->data, copy_size);
 		}
 
 		/* use the previous gen bit for the SOP desc */
@@ -346,7 +367,7 @@ int vmxnet3_xmit_pkts(__unused struct uk_netdev *dev,
 					txq->data_ring.basePA +
 							 offset;
 			} else {
-				gdesc->txd.addr = (uint64) m_seg->buf;
+				gdesc->txd.addr = (uint64) m_seg->data;
 				ret |= UK_NETDEV_STATUS_MORE;
 			}
 
@@ -368,10 +389,24 @@ int vmxnet3_xmit_pkts(__unused struct uk_netdev *dev,
 		/* Add VLAN tag if present */
 		gdesc = txq->cmd_ring.base + first2fill;
 
-		gdesc->txd.hlen = 0;
-		gdesc->txd.om = VMXNET3_OM_NONE;
-		gdesc->txd.msscof = 0;
-		deferred++;
+		if (txm->flags & (UK_NETBUF_F_GSO_TCPV4 |
+				  UK_NETBUF_F_GSO_TCPV6)) {
+			/* The device computes the checksums of each segment */
+			gdesc->txd.hlen = txm->header_len;
+			gdesc->txd.om = VMXNET3_OM_TSO;
+			gdesc->txd.msscof = txm->gso_size;
+			deferred += DIV_ROUND_UP(paylen, txm->gso_size);
+		} else if (txm->flags & UK_NETBUF_F_PARTIAL_CSUM) {
+			gdesc->txd.hlen = txm->csum_start;
+			gdesc->txd.om = VMXNET3_OM_CSUM;
+			gdesc->txd.msscof = txm->csum_start + txm->csum_offset;
+			deferred++;
+		} else {
+			gdesc->txd.hlen = 0;
+			gdesc->txd.om = VMXNET3_OM_NONE;
+			gdesc->txd.msscof = 0;
+			deferred++;
+		}
 
 		/* flip the GEN bit on the SOP */
 		barrier();
@@ -606,6 +641,11 @@ vmxnet3_recv_pkts(struct uk_netdev *dev __unused,
 
 		if (rcd->eop) {
 			*pkt = rxq->start_seg;
+
+			/* Checksum results are only valid on the EOP */
+			if (*pkt && !rcd->cnc && (rcd->v4 ? rcd->ipc : rcd->v6) &&
+			    (rcd->tcp || rcd->udp) && rcd->tuc)
+				(*pkt)->flags |= UK_NETBUF_F_DATA_VALID;
 		}
 rcd_done:
 		rxq->cmd_ring[ring_idx].next2comp = idx;
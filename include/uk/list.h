@@ -428,6 +428,85 @@ static inline int uk_list_is_last(const struct uk_list_head *list,
 	     (pos) && ({ n = (pos)->member.next; 1; });			\
 	     pos = uk_hlist_entry_safe(n, typeof(*(pos)), member))
 
+/*
+ * RCU-safe variants. Updaters must serialize among each other, readers may
+ * traverse the lists concurrently within an RCU read-side critical section
+ * (see uk/rcu.h). Removed entries keep their forward links so that readers
+ * that are on them can continue; they may only be released after a grace
+ * period.
+ */
+
+static inline void
+__uk_list_add_rcu(struct uk_list_head *new_entry, struct uk_list_head *prev,
+		  struct uk_list_head *next)
+{
+	new_entry->next = next;
+	new_entry->prev = prev;
+	/* Publish the initialized entry */
+	__atomic_store_n(&prev->next, new_entry, __ATOMIC_RELEASE);
+	next->prev = new_entry;
+}
+
+static inline void
+uk_list_add_rcu(struct uk_list_head *new_entry, struct uk_list_head *head)
+{
+	__uk_list_add_rcu(new_entry, head, head->next);
+}
+
+static inline void
+uk_list_add_tail_rcu(struct uk_list_head *new_entry, struct uk_list_head *head)
+{
+	__uk_list_add_rcu(new_entry, head->prev, head);
+}
+
+static inline void
+uk_list_del_rcu(struct uk_list_head *entry)
+{
+	__uk_list_del(entry->prev, entry->next);
+	entry->prev = NULL;
+}
+
+static inline void
+uk_list_replace_rcu(struct uk_list_head *old_entry,
+		    struct uk_list_head *new_entry)
+{
+	new_entry->next = old_entry->next;
+	new_entry->prev = old_entry->prev;
+	__atomic_store_n(&new_entry->prev->next, new_entry, __ATOMIC_RELEASE);
+	new_entry->next->prev = new_entry;
+	old_entry->prev = NULL;
+}
+
+#define	uk_list_for_each_entry_rcu(p, h, field)				\
+	for (p = uk_list_entry(UK_READ_ONCE((h)->next), typeof(*p), field); \
+	     &(p)->field != (h);					\
+	     p = uk_list_entry(UK_READ_ONCE((p)->field.next), typeof(*p), \
+			       field))
+
+static inline void
+uk_hlist_add_head_rcu(struct uk_hlist_node *n, struct uk_hlist_head *h)
+{
+	n->next = h->first;
+	n->pprev = &h->first;
+	__atomic_store_n(&h->first, n, __ATOMIC_RELEASE);
+	if (n->next != NULL)
+		n->next->pprev = &n->next;
+}
+
+static inline void
+uk_hlist_del_rcu(struct uk_hlist_node *n)
+{
+	uk_hlist_del(n);
+	n->pprev = NULL;
+}
+
+#define	uk_hlist_for_each_entry_rcu(pos, head, member)			\
+	for (pos = uk_hlist_entry_safe(UK_READ_ONCE((head)->first),	\
+				       typeof(*(pos)), member);		\
+	     pos;							\
+	     pos = uk_hlist_entry_safe(UK_READ_ONCE((pos)->member.next), \
+				       typeof(*(pos)), member))
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,8 +36,13 @@
 #include <stdbool.h>
 #include <uk/9pdev.h>
 #include <uk/9pfid.h>
+#include <uk/arch/time.h>
+#include <uk/list.h>
+#include <uk/mutex.h>
+#include <uk/refcount.h>
 
 #include <vfscore/prex.h>
+#include <vfscore/vnode.h>
 
 /**
  * Protocol version; the default version is `9P2000.L`,
@@ -62,6 +67,41 @@ enum uk_9pfs_proto {
 	UK_9P_PROTO_MAX
 };
 
+/**
+ * Caching mode, selected with the `cache=` mount option.
+ */
+enum uk_9pfs_cache_mode {
+	/* Every lookup, stat and readdir goes to the server */
+	UK_9PFS_CACHE_NONE,
+	/*
+	 * Lookups (including failed ones), attributes and directory
+	 * listings are cached for `cache_ttl` nanoseconds. Changes made
+	 * through this mount invalidate the affected entries; changes made
+	 * by other clients of the server may go unnoticed until the
+	 * entries expire.
+	 */
+	UK_9PFS_CACHE_LOOSE,
+};
+
+/**
+ * Number of hash buckets of the per-mount lookup cache.
+ */
+#define UK_9PFS_CACHE_BUCKETS	64
+
+/**
+ * Lookup cache of a mount
+ */
+struct uk_9pfs_cache {
+	/* Protects all fields below */
+	struct uk_mutex		lock;
+	/* Hash table of `uk_9pfs_cache_entry`, by directory and name */
+	struct uk_hlist_head	buckets[UK_9PFS_CACHE_BUCKETS];
+	/* All entries, least recently used first */
+	struct uk_list_head	lru;
+	/* Number of entries in the cache */
+	unsigned int		count;
+};
+
 /**
  * An entry containing the necessary data for mounting the filesystem
  */
@@ -82,6 +122,14 @@ struct uk_9pfs_mount_data {
 	 * offering several exported file systems.
 	 */
 	char			*aname;
+	/* Maximum number of in-flight requests per read/write */
+	unsigned int		io_window;
+	/* Caching mode */
+	enum uk_9pfs_cache_mode	cache_mode;
+	/* Time after which cached data is considered stale */
+	__nsec			cache_ttl;
+	/* Lookup cache, used with `UK_9PFS_CACHE_LOOSE` */
+	struct uk_9pfs_cache	cache;
 };
 
 /**
@@ -102,6 +150,24 @@ struct uk_9pfs_file_data {
 	int                    readdir_off;
 	/* Total size of the data in the `readdir` buf */
 	int                    readdir_sz;
+	/*
+	 * Cached directory listing `readdir_buf` points into, or NULL if
+	 * `readdir_buf` is owned by this file
+	 */
+	struct uk_9pfs_dirbuf  *readdir_cached;
+};
+
+/**
+ * Complete directory listing in 9P wire format, shared between the directory
+ * node and the files reading from it.
+ */
+struct uk_9pfs_dirbuf {
+	/* Number of references (node and open files) */
+	__atomic               refcount;
+	/* Size of the listing */
+	int                    size;
+	/* Raw Rread/Rreaddir payload of the whole directory */
+	char                   data[];
 };
 
 /**
@@ -114,6 +180,12 @@ struct uk_9pfs_node_data {
 	int                    nb_open_files;
 	/* Is a 9P remove call required when `nb_open_files` reaches 0? */
 	bool                   removed;
+	/* Cached attributes, valid until `attr_expiry` (0: not valid) */
+	struct vattr           attr;
+	__nsec                 attr_expiry;
+	/* Cached directory listing, valid until `dir_expiry` */
+	struct uk_9pfs_dirbuf  *dir;
+	__nsec                 dir_expiry;
 };
 
 /**
@@ -142,6 +214,88 @@ void uk_9pfs_free_vnode_data(struct vnode *vp);
  */
 #define UK_9PFS_READDIR_BUFSZ	8192
 
+/**
+ * Directories whose listing exceeds this size are not cached.
+ */
+#define UK_9PFS_DIRCACHE_MAXSZ	(256 * 1024)
+
+/**
+ * Initializes the lookup cache of a mount.
+ */
+void uk_9pfs_cache_init(struct uk_9pfs_mount_data *md);
+
+/**
+ * Drops all entries of the lookup cache of a mount, releasing the vnodes
+ * they hold.
+ */
+void uk_9pfs_cache_flush(struct uk_9pfs_mount_data *md);
+
+/**
+ * Looks up `name` in directory `dvp` in the lookup cache.
+ *
+ * @return
+ *   1 and a referenced, locked vnode in `vpp` on a positive hit,
+ *   -ENOENT if `name` is known not to exist, 0 on a miss
+ */
+int uk_9pfs_cache_lookup(struct vnode *dvp, const char *name,
+			 struct vnode **vpp);
+
+/**
+ * Records the result of looking up `name` in directory `dvp`. `vp` is the
+ * vnode that was found, or NULL if `name` does not exist. The cache keeps a
+ * reference to `vp` until the entry expires or is invalidated.
+ */
+void uk_9pfs_cache_enter(struct vnode *dvp, const char *name,
+			 struct vnode *vp);
+
+/**
+ * Invalidates the cached lookup of `name` in directory `dvp` as well as the
+ * cached listing of `dvp`. If `name` is NULL, all lookups in `dvp` are
+ * invalidated.
+ */
+void uk_9pfs_cache_invalidate(struct vnode *dvp, const char *name);
+
+/**
+ * Copies the cached attributes of `vp` to `attr` if they are still valid.
+ *
+ * @return
+ *   true if `attr` was filled from the cache
+ */
+bool uk_9pfs_attr_cached(struct vnode *vp, struct vattr *attr);
+
+/**
+ * Updates the cached attributes of `vp`.
+ */
+void uk_9pfs_attr_update(struct vnode *vp, const struct vattr *attr);
+
+/**
+ * Invalidates the cached attributes of `vp`.
+ */
+static inline void uk_9pfs_attr_invalidate(struct vnode *vp)
+{
+	struct uk_9pfs_node_data *nd = (struct uk_9pfs_node_data *)vp->v_data;
+
+	if (nd)
+		nd->attr_expiry = 0;
+}
+
+/**
+ * Returns a new reference to the cached listing of directory `vp`, or NULL
+ * if there is no valid listing.
+ */
+struct uk_9pfs_dirbuf *uk_9pfs_dircache_get(struct vnode *vp);
+
+/**
+ * Sets the cached listing of directory `vp`, taking over the reference to
+ * `dir`.
+ */
+void uk_9pfs_dircache_set(struct vnode *vp, struct uk_9pfs_dirbuf *dir);
+
+/**
+ * Releases a reference to a directory listing.
+ */
+void uk_9pfs_dirbuf_put(struct uk_9pfs_dirbuf *dir);
+
 /**
  * Converts a `vfscore_file` into a `uk_9pfs_file_data`.
  *
@@ -0,0 +1,320 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uk/assert.h>
+#include <uk/plat/time.h>
+#include <vfscore/mount.h>
+
+#include "9pfs.h"
+
+/**
+ * Cached result of looking up a name in a directory.
+ */
+struct uk_9pfs_cache_entry {
+	/* Entry in the hash bucket */
+	struct uk_hlist_node	hash;
+	/* Entry in the LRU list */
+	struct uk_list_head	lru;
+	/* Inode number of the directory */
+	uint64_t		dino;
+	/* Vnode that was found (referenced), or NULL for a failed lookup */
+	struct vnode		*vp;
+	/* Time at which the entry becomes stale */
+	__nsec			expiry;
+	/* Name that was looked up */
+	char			name[];
+};
+
+static unsigned int uk_9pfs_cache_hash(uint64_t dino, const char *name)
+{
+	/* FNV-1a over the name, seeded with the directory inode */
+	uint64_t h = 0xcbf29ce484222325ULL ^ dino;
+
+	while (*name) {
+		h ^= (unsigned char)*name++;
+		h *= 0x100000001b3ULL;
+	}
+
+	return (unsigned int)(h ^ (h >> 32)) % UK_9PFS_CACHE_BUCKETS;
+}
+
+static inline bool uk_9pfs_cache_on(struct uk_9pfs_mount_data *md)
+{
+	return md->cache_mode != UK_9PFS_CACHE_NONE;
+}
+
+static inline __nsec uk_9pfs_cache_expiry(struct uk_9pfs_mount_data *md)
+{
+	return ukplat_monotonic_clock() + md->cache_ttl;
+}
+
+/* Unlinks `e` and returns the vnode it holds, to be released by the caller
+ * once the cache lock is dropped.
+ */
+static struct vnode *uk_9pfs_cache_del_locked(struct uk_9pfs_cache *c,
+					      struct uk_9pfs_cache_entry *e)
+{
+	struct vnode *vp = e->vp;
+
+	uk_hlist_del(&e->hash);
+	uk_list_del(&e->lru);
+	c->count--;
+	free(e);
+
+	return vp;
+}
+
+static struct uk_9pfs_cache_entry *
+uk_9pfs_cache_find_locked(struct uk_9pfs_cache *c, uint64_t dino,
+			  const char *name)
+{
+	struct uk_9pfs_cache_entry *e;
+	struct uk_hlist_node *n;
+
+	uk_hlist_for_each(n, &c->buckets[uk_9pfs_cache_hash(dino, name)]) {
+		e = uk_hlist_entry(n, struct uk_9pfs_cache_entry, hash);
+		if (e->dino == dino && !strcmp(e->name, name))
+			return e;
+	}
+
+	return NULL;
+}
+
+void uk_9pfs_cache_init(struct uk_9pfs_mount_data *md)
+{
+	struct uk_9pfs_cache *c = &md->cache;
+	unsigned int i;
+
+	uk_mutex_init(&c->lock);
+	for (i = 0; i < UK_9PFS_CACHE_BUCKETS; i++)
+		c->buckets[i].first = NULL;
+	UK_INIT_LIST_HEAD(&c->lru);
+	c->count = 0;
+}
+
+void uk_9pfs_cache_flush(struct uk_9pfs_mount_data *md)
+{
+	struct uk_9pfs_cache *c = &md->cache;
+	struct uk_9pfs_cache_entry *e;
+	struct vnode *vp;
+
+	for (;;) {
+		uk_mutex_lock(&c->lock);
+		if (uk_list_empty(&c->lru)) {
+			uk_mutex_unlock(&c->lock);
+			break;
+		}
+		e = uk_list_first_entry(&c->lru, struct uk_9pfs_cache_entry,
+					lru);
+		vp = uk_9pfs_cache_del_locked(c, e);
+		uk_mutex_unlock(&c->lock);
+
+		if (vp)
+			vrele(vp);
+	}
+}
+
+int uk_9pfs_cache_lookup(struct vnode *dvp, const char *name,
+			 struct vnode **vpp)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(dvp->v_mount);
+	struct uk_9pfs_cache *c = &md->cache;
+	struct uk_9pfs_cache_entry *e;
+	struct vnode *stale = NULL;
+	int rc = 0;
+
+	if (!uk_9pfs_cache_on(md))
+		return 0;
+
+	uk_mutex_lock(&c->lock);
+	e = uk_9pfs_cache_find_locked(c, dvp->v_ino, name);
+	if (!e)
+		goto out;
+
+	if (e->expiry <= ukplat_monotonic_clock()) {
+		stale = uk_9pfs_cache_del_locked(c, e);
+		goto out;
+	}
+
+	/* Refresh the position in the LRU list */
+	uk_list_del(&e->lru);
+	uk_list_add_tail(&e->lru, &c->lru);
+
+	if (!e->vp) {
+		rc = -ENOENT;
+		goto out;
+	}
+
+	vref(e->vp);
+	*vpp = e->vp;
+	rc = 1;
+
+out:
+	uk_mutex_unlock(&c->lock);
+	if (stale)
+		vrele(stale);
+	if (rc == 1)
+		vn_lock(*vpp);
+	return rc;
+}
+
+void uk_9pfs_cache_enter(struct vnode *dvp, const char *name,
+			 struct vnode *vp)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(dvp->v_mount);
+	struct uk_9pfs_cache *c = &md->cache;
+	struct uk_9pfs_cache_entry *e, *old;
+	struct vnode *evicted[2] = { NULL, NULL };
+	size_t len;
+
+	if (!uk_9pfs_cache_on(md))
+		return;
+
+	len = strlen(name);
+	e = malloc(sizeof(*e) + len + 1);
+	if (!e)
+		return;
+
+	e->dino = dvp->v_ino;
+	e->vp = vp;
+	e->expiry = uk_9pfs_cache_expiry(md);
+	memcpy(e->name, name, len + 1);
+	if (vp)
+		vref(vp);
+
+	uk_mutex_lock(&c->lock);
+	old = uk_9pfs_cache_find_locked(c, e->dino, name);
+	if (old)
+		evicted[0] = uk_9pfs_cache_del_locked(c, old);
+	else if (c->count >= CONFIG_LIB9PFS_CACHE_MAXENTRIES) {
+		old = uk_list_first_entry(&c->lru, struct uk_9pfs_cache_entry,
+					  lru);
+		evicted[1] = uk_9pfs_cache_del_locked(c, old);
+	}
+
+	uk_hlist_add_head(&e->hash,
+			  &c->buckets[uk_9pfs_cache_hash(e->dino, name)]);
+	uk_list_add_tail(&e->lru, &c->lru);
+	c->count++;
+	uk_mutex_unlock(&c->lock);
+
+	if (evicted[0])
+		vrele(evicted[0]);
+	if (evicted[1])
+		vrele(evicted[1]);
+}
+
+void uk_9pfs_cache_invalidate(struct vnode *dvp, const char *name)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(dvp->v_mount);
+	struct uk_9pfs_cache *c = &md->cache;
+	struct uk_9pfs_cache_entry *e, *en;
+	struct uk_list_head stale;
+	struct vnode *vp;
+
+	if (!uk_9pfs_cache_on(md))
+		return;
+
+	uk_9pfs_dircache_set(dvp, NULL);
+
+	UK_INIT_LIST_HEAD(&stale);
+	uk_mutex_lock(&c->lock);
+	if (name) {
+		e = uk_9pfs_cache_find_locked(c, dvp->v_ino, name);
+		if (e) {
+			uk_hlist_del(&e->hash);
+			uk_list_del(&e->lru);
+			uk_list_add(&e->lru, &stale);
+			c->count--;
+		}
+	} else {
+		uk_list_for_each_entry_safe(e, en, &c->lru, lru) {
+			if (e->dino != dvp->v_ino)
+				continue;
+			uk_hlist_del(&e->hash);
+			uk_list_del(&e->lru);
+			uk_list_add(&e->lru, &stale);
+			c->count--;
+		}
+	}
+	uk_mutex_unlock(&c->lock);
+
+	uk_list_for_each_entry_safe(e, en, &stale, lru) {
+		vp = e->vp;
+		free(e);
+		if (vp)
+			vrele(vp);
+	}
+}
+
+bool uk_9pfs_attr_cached(struct vnode *vp, struct vattr *attr)
+{
+	struct uk_9pfs_node_data *nd = UK_9PFS_ND(vp);
+
+	if (!uk_9pfs_cache_on(UK_9PFS_MD(vp->v_mount)) || !nd)
+		return false;
+	if (nd->attr_expiry <= ukplat_monotonic_clock())
+		return false;
+
+	*attr = nd->attr;
+	return true;
+}
+
+void uk_9pfs_attr_update(struct vnode *vp, const struct vattr *attr)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(vp->v_mount);
+	struct uk_9pfs_node_data *nd = UK_9PFS_ND(vp);
+
+	if (!uk_9pfs_cache_on(md) || !nd)
+		return;
+
+	nd->attr = *attr;
+	nd->attr_expiry = uk_9pfs_cache_expiry(md);
+}
+
+struct uk_9pfs_dirbuf *uk_9pfs_dircache_get(struct vnode *vp)
+{
+	struct uk_9pfs_node_data *nd = UK_9PFS_ND(vp);
+
+	if (!uk_9pfs_cache_on(UK_9PFS_MD(vp->v_mount)) || !nd || !nd->dir)
+		return NULL;
+
+	if (nd->dir_expiry <= ukplat_monotonic_clock()) {
+		uk_9pfs_dircache_set(vp, NULL);
+		return NULL;
+	}
+
+	uk_refcount_acquire(&nd->dir->refcount);
+	return nd->dir;
+}
+
+void uk_9pfs_dircache_set(struct vnode *vp, struct uk_9pfs_dirbuf *dir)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(vp->v_mount);
+	struct uk_9pfs_node_data *nd = UK_9PFS_ND(vp);
+	struct uk_9pfs_dirbuf *old;
+
+	if (!nd) {
+		if (dir)
+			uk_9pfs_dirbuf_put(dir);
+		return;
+	}
+
+	old = nd->dir;
+	nd->dir = dir;
+	nd->dir_expiry = dir ? uk_9pfs_cache_expiry(md) : 0;
+	if (old)
+		uk_9pfs_dirbuf_put(old);
+}
+
+void uk_9pfs_dirbuf_put(struct uk_9pfs_dirbuf *dir)
+{
+	if (uk_refcount_release(&dir->refcount))
+		free(dir);
+}
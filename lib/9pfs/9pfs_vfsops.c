@@ -100,6 +100,28 @@ static int uk_9pfs_parse_option(struct uk_9pfs_mount_data *md,
 		md->aname = strdup(option + 6);
 		if (!md->aname)
 			return -ENOMEM;
+	} else if (strncmp(option, "iowindow=", 9) == 0) {
+		char *end;
+		unsigned long window = strtoul(option + 9, &end, 10);
+
+		if (*end != '\0' || window < 1 ||
+		    window > CONFIG_LIB9PFS_IO_WINDOW)
+			return -EINVAL;
+		md->io_window = window;
+	} else if (strncmp(option, "cache=", 6) == 0) {
+		if (strcmp(option + 6, "none") == 0)
+			md->cache_mode = UK_9PFS_CACHE_NONE;
+		else if (strcmp(option + 6, "loose") == 0)
+			md->cache_mode = UK_9PFS_CACHE_LOOSE;
+		else
+			return -EINVAL;
+	} else if (strncmp(option, "cache_ttl=", 10) == 0) {
+		char *end;
+		unsigned long ttl = strtoul(option + 10, &end, 10);
+
+		if (*end != '\0')
+			return -EINVAL;
+		md->cache_ttl = ukarch_time_msec_to_nsec((__nsec)ttl);
 	}
 
 	return 0;
@@ -119,6 +141,10 @@ static int uk_9pfs_parse_options(struct uk_9pfs_mount_data *md,
 	}
 
 	md->proto = UK_9P_PROTO_2000L;
+	md->io_window = CONFIG_LIB9PFS_IO_WINDOW;
+	md->cache_mode = UK_9PFS_CACHE_NONE;
+	md->cache_ttl = ukarch_time_msec_to_nsec(
+		(__nsec)CONFIG_LIB9PFS_CACHE_TTL);
 	md->uname = strdup("");
 	md->aname = strdup("");
 
@@ -179,6 +205,7 @@ static int uk_9pfs_mount(struct mount *mp, const char *dev,
 		goto out_free_mdata;
 
 	mp->m_data = md;
+	uk_9pfs_cache_init(md);
 
 	/* Establish connection with the given 9P endpoint. */
 	md->dev = uk_9pdev_connect(md->trans, dev, data, NULL);
@@ -243,6 +270,7 @@ static int uk_9pfs_unmount(struct mount *mp, int flags __unused)
 {
 	struct uk_9pfs_mount_data *md = UK_9PFS_MD(mp);
 
+	uk_9pfs_cache_flush(md);
 	uk_9pfs_release_tree_fids(mp->m_root);
 	vfscore_release_mp_dentries(mp);
 	uk_9pdev_disconnect(md->dev);
@@ -154,6 +154,44 @@ static uint64_t uk_9pfs_ino(struct uk_9p_stat *stat)
 	return stat->qid.path;
 }
 
+static void uk_9pfs_vattr_from_attr_l(struct vnode *vp,
+				      const struct uk_9p_attr *stat,
+				      struct vattr *attr)
+{
+	attr->va_type = stat->mode & S_IFMT;
+	attr->va_mode = stat->mode & UK_ALLPERMS;
+	attr->va_nlink = stat->nlink;
+	attr->va_uid = stat->uid;
+	attr->va_gid = stat->gid;
+	attr->va_nodeid = vp->v_ino;
+	attr->va_atime.tv_sec = stat->atime_sec;
+	attr->va_atime.tv_nsec = stat->atime_nsec;
+	attr->va_mtime.tv_sec = stat->mtime_sec;
+	attr->va_mtime.tv_nsec = stat->mtime_nsec;
+	attr->va_ctime.tv_sec = stat->ctime_sec;
+	attr->va_ctime.tv_nsec = stat->ctime_nsec;
+	attr->va_rdev = stat->rdev;
+	attr->va_nblocks = stat->blocks;
+	attr->va_size = stat->size;
+}
+
+static void uk_9pfs_vattr_from_stat_u(struct vnode *vp,
+				      const struct uk_9p_stat *stat,
+				      struct vattr *attr)
+{
+	attr->va_type = uk_9pfs_vtype_from_mode(stat->mode);
+	attr->va_mode = uk_9pfs_posix_mode_from_mode(stat->mode);
+	attr->va_nodeid = vp->v_ino;
+	attr->va_size = stat->length;
+
+	attr->va_atime.tv_sec = stat->atime;
+	attr->va_atime.tv_nsec = 0;
+	attr->va_mtime.tv_sec = stat->mtime;
+	attr->va_mtime.tv_nsec = 0;
+	attr->va_ctime.tv_sec = 0;
+	attr->va_ctime.tv_nsec = 0;
+}
+
 int uk_9pfs_allocate_vnode_data(struct vnode *vp, struct uk_9pfid *fid)
 {
 	struct uk_9pfs_node_data *nd;
@@ -165,6 +203,9 @@ int uk_9pfs_allocate_vnode_data(struct vnode *vp, struct uk_9pfid *fid)
 	nd->fid = fid;
 	nd->nb_open_files = 0;
 	nd->removed = false;
+	nd->attr_expiry = 0;
+	nd->dir = NULL;
+	nd->dir_expiry = 0;
 	vp->v_data = nd;
 
 	return 0;
@@ -181,6 +222,9 @@ void uk_9pfs_free_vnode_data(struct vnode *vp)
 	if (nd->removed)
 		uk_9p_remove(dev, nd->fid);
 
+	if (nd->dir)
+		uk_9pfs_dirbuf_put(nd->dir);
+
 	uk_9pfid_put(nd->fid);
 	free(nd);
 	vp->v_data = NULL;
@@ -237,7 +281,9 @@ static int uk_9pfs_close(struct vnode *vn __unused, struct vfscore_file *file)
 {
 	struct uk_9pfs_file_data *fd = UK_9PFS_FD(file);
 
-	if (fd->readdir_buf)
+	if (fd->readdir_cached)
+		uk_9pfs_dirbuf_put(fd->readdir_cached);
+	else if (fd->readdir_buf)
 		free(fd->readdir_buf);
 
 	uk_9pfid_put(fd->fid);
@@ -255,21 +301,31 @@ static int uk_9pfs_lookup(struct vnode *dvp, const char *name,
 	struct uk_9pfid *dfid = UK_9PFS_VFID(dvp);
 	struct uk_9pfid *fid;
 	struct vnode *vp;
+	struct vattr attr;
+	bool attr_valid = false;
 	int rc;
 
 	if (strlen(name) > NAME_MAX)
 		return ENAMETOOLONG;
 
+	rc = uk_9pfs_cache_lookup(dvp, name, vpp);
+	if (rc == 1)
+		return 0;
+	if (rc < 0)
+		return -rc;
+
 	fid = uk_9p_walk(dev, dfid, name);
 	if (PTRISERR(fid)) {
 		rc = PTR2ERR(fid);
+		if (rc == -ENOENT)
+			uk_9pfs_cache_enter(dvp, name, NULL);
 		goto out;
 	}
 
 	if (md->proto == UK_9P_PROTO_2000L) {
 		struct uk_9p_attr stat;
 		struct uk_9preq *stat_req = uk_9p_getattr(
-		    dev, fid, UK_9P_GETATTR_MODE | UK_9P_GETATTR_SIZE, &stat);
+		    dev, fid, UK_9P_GETATTR_BASIC, &stat);
 		if (PTRISERR(stat_req)) {
 			rc = PTR2ERR(stat_req);
 			goto out_fid;
@@ -291,7 +347,7 @@ static int uk_9pfs_lookup(struct vnode *dvp, const char *name,
 			 * it may be reused.
 			 */
 			if (vp->v_data)
-				goto out_fid;
+				goto out_cache;
 		}
 
 		if (!vp) {
@@ -304,6 +360,11 @@ static int uk_9pfs_lookup(struct vnode *dvp, const char *name,
 		vp->v_type = uk_9pfs_vtype_from_mode_l(stat.mode);
 		vp->v_size = stat.size;
 
+		if ((stat.valid & UK_9P_GETATTR_BASIC) == UK_9P_GETATTR_BASIC) {
+			uk_9pfs_vattr_from_attr_l(vp, &stat, &attr);
+			attr_valid = true;
+		}
+
 	} else if (md->proto == UK_9P_PROTO_2000U) {
 		struct uk_9p_stat stat;
 		struct uk_9preq *stat_req = uk_9p_stat(dev, fid, &stat);
@@ -325,7 +386,7 @@ static int uk_9pfs_lookup(struct vnode *dvp, const char *name,
 			 * it may be reused.
 			 */
 			if (vp->v_data)
-				goto out_fid;
+				goto out_cache;
 		}
 
 		if (!vp) {
@@ -338,6 +399,9 @@ static int uk_9pfs_lookup(struct vnode *dvp, const char *name,
 		vp->v_type = uk_9pfs_vtype_from_mode(stat.mode);
 		vp->v_size = stat.length;
 
+		uk_9pfs_vattr_from_stat_u(vp, &stat, &attr);
+		attr_valid = true;
+
 	} else {
 		rc = -EOPNOTSUPP;
 		goto out_fid;
@@ -347,10 +411,17 @@ static int uk_9pfs_lookup(struct vnode *dvp, const char *name,
 	if (rc != 0)
 		goto out_fid;
 
+	if (attr_valid)
+		uk_9pfs_attr_update(vp, &attr);
+	uk_9pfs_cache_enter(dvp, name, vp);
+
 	*vpp = vp;
 
 	return 0;
 
+out_cache:
+	/* Remember the existing vnode, the walked fid is not needed. */
+	uk_9pfs_cache_enter(dvp, name, vp);
 out_fid:
 	uk_9pfid_put(fid);
 out:
@@ -392,6 +463,8 @@ static int uk_9pfs_create(struct vnode *dvp, const char *name, mode_t mode)
 	if (!S_ISREG(mode))
 		return EINVAL;
 
+	uk_9pfs_cache_invalidate(dvp, name);
+
 	if (md->proto == UK_9P_PROTO_2000L) {
 		struct uk_9pfid *fid =
 		    uk_9p_walk(md->dev, UK_9PFS_VFID(dvp), NULL);
@@ -415,11 +488,13 @@ static int uk_9pfs_remove_generic(struct vnode *dvp, struct vnode *vp)
 }
 
 static int uk_9pfs_remove(struct vnode *dvp, struct vnode *vp,
-			  const char *name __unused)
+			  const char *name)
 {
 	struct uk_9pfs_node_data *nd = UK_9PFS_ND(vp);
 	int rc = 0;
 
+	uk_9pfs_cache_invalidate(dvp, name);
+
 	if (!nd->nb_open_files)
 		rc = uk_9pfs_remove_generic(dvp, vp);
 	else
@@ -433,15 +508,123 @@ static int uk_9pfs_mkdir(struct vnode *dvp, const char *name, mode_t mode)
 	if (!S_ISDIR(mode))
 		return EINVAL;
 
+	uk_9pfs_cache_invalidate(dvp, name);
 	return uk_9pfs_create_generic(dvp, name, mode);
 }
 
 static int uk_9pfs_rmdir(struct vnode *dvp, struct vnode *vp,
-			 const char *name __unused)
+			 const char *name)
 {
+	uk_9pfs_cache_invalidate(dvp, name);
+	uk_9pfs_cache_invalidate(vp, NULL);
 	return uk_9pfs_remove_generic(dvp, vp);
 }
 
+/*
+ * Reads the complete listing of directory `vp` through the open `fid`, so that
+ * it can be cached. Returns NULL if the listing cannot be read or is too large
+ * to be cached.
+ */
+static struct uk_9pfs_dirbuf *uk_9pfs_dircache_fill(struct vnode *vp,
+						    struct uk_9pfid *fid)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(vp->v_mount);
+	struct uk_9pfs_dirbuf *dir, *tmp;
+	struct uk_9preq fake_request;
+	struct uk_9p_qid qid;
+	struct uk_9p_str name;
+	uint64_t offset = 0;
+	uint8_t type;
+	int size = 0, cap = UK_9PFS_READDIR_BUFSZ;
+	int64_t n;
+
+	dir = malloc(sizeof(*dir) + cap);
+	if (!dir)
+		return NULL;
+
+	for (;;) {
+		if (cap - size < UK_9PFS_READDIR_BUFSZ) {
+			if (cap >= UK_9PFS_DIRCACHE_MAXSZ)
+				goto err;
+			cap *= 2;
+			tmp = realloc(dir, sizeof(*dir) + cap);
+			if (!tmp)
+				goto err;
+			dir = tmp;
+		}
+
+		if (md->proto == UK_9P_PROTO_2000L)
+			n = uk_9p_readdir(md->dev, fid, offset,
+					  UK_9PFS_READDIR_BUFSZ,
+					  dir->data + size);
+		else
+			n = uk_9p_read(md->dev, fid, offset,
+				       UK_9PFS_READDIR_BUFSZ, dir->data + size);
+		if (n < 0)
+			goto err;
+		if (n == 0)
+			break;
+
+		if (md->proto == UK_9P_PROTO_2000L) {
+			/* The next chunk starts after the last entry read. */
+			fake_request.recv.buf = dir->data + size;
+			fake_request.recv.size = n;
+			fake_request.recv.offset = 0;
+			fake_request.state = UK_9PREQ_RECEIVED;
+			while (fake_request.recv.offset < n) {
+				if (uk_9preq_readdirent(&fake_request, &qid,
+							&offset, &type, &name))
+					goto err;
+			}
+		} else {
+			offset += n;
+		}
+		size += n;
+	}
+
+	uk_refcount_init(&dir->refcount, 1);
+	dir->size = size;
+	return dir;
+
+err:
+	free(dir);
+	return NULL;
+}
+
+/*
+ * Serves a readdir() stream that starts at the beginning of the directory from
+ * the cached listing of `vp`, filling the cache first if needed.
+ */
+static void uk_9pfs_readdir_use_cache(struct vnode *vp,
+				      struct vfscore_file *fp)
+{
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(vp->v_mount);
+	struct uk_9pfs_file_data *fd = UK_9PFS_FD(fp);
+	struct uk_9pfs_dirbuf *dir;
+
+	if (md->cache_mode == UK_9PFS_CACHE_NONE)
+		return;
+
+	dir = uk_9pfs_dircache_get(vp);
+	if (!dir) {
+		dir = uk_9pfs_dircache_fill(vp, fd->fid);
+		if (!dir)
+			return;
+
+		uk_refcount_acquire(&dir->refcount);
+		uk_9pfs_dircache_set(vp, dir);
+	}
+
+	fd->readdir_cached = dir;
+	fd->readdir_buf = dir->data;
+	fd->readdir_off = 0;
+	fd->readdir_sz = dir->size;
+
+	/* 9p2000.u advances the offset by whole chunks. */
+	if (md->proto == UK_9P_PROTO_2000U)
+		fp->f_offset += dir->size;
+}
+
 static int uk_9pfs_readdir(struct vnode *vp, struct vfscore_file *fp,
 		struct dirent64 *dir)
 {
@@ -451,6 +634,9 @@ static int uk_9pfs_readdir(struct vnode *vp, struct vfscore_file *fp,
 	int rc;
 	struct uk_9preq fake_request;
 
+	if (!fd->readdir_buf && fp->f_offset == 0)
+		uk_9pfs_readdir_use_cache(vp, fp);
+
 again:
 	if (!fd->readdir_buf) {
 		fd->readdir_buf = malloc(UK_9PFS_READDIR_BUFSZ);
@@ -463,6 +649,12 @@ again:
 	}
 
 	if (fd->readdir_off == fd->readdir_sz) {
+		/* The cached listing covers the whole directory. */
+		if (fd->readdir_cached) {
+			rc = -ENOENT;
+			goto out;
+		}
+
 		fd->readdir_off = 0;
 
 		if (md->proto == UK_9P_PROTO_2000L)
@@ -513,7 +705,7 @@ again:
 		rc = uk_9preq_readdirent(&fake_request, &qid, &offset, &type,
 					 &name);
 
-		if (rc == -ENOBUFS) {
+		if (rc == -ENOBUFS && !fd->readdir_cached) {
 			/*
 			 * Retry with a clean buffer, maybe the stat structure
 			 * got chunked and is not whole, although the RFC says
@@ -529,7 +721,6 @@ again:
 		 * deserialization.
 		 */
 		fd->readdir_off = fake_request.recv.offset;
-		fp->f_offset = offset;
 
 		/*
 		 * Any other error besides ENOBUFS when deserializing is
@@ -540,6 +731,8 @@ again:
 			goto out;
 		}
 
+		fp->f_offset = offset;
+
 		dir->d_type = type;
 		dir->d_ino = qid.path;
 		strlcpy((char *)&dir->d_name, name.data,
@@ -550,7 +743,7 @@ again:
 
 		rc = uk_9preq_readstat(&fake_request, &stat);
 
-		if (rc == -ENOBUFS) {
+		if (rc == -ENOBUFS && !fd->readdir_cached) {
 			fd->readdir_off = 0;
 			fd->readdir_sz = 0;
 			goto again;
@@ -573,12 +766,100 @@ out:
 	return -rc;
 }
 
+/*
+ * Reads or writes up to `len` bytes at `offset`, splitting the transfer into
+ * requests of at most the maximum 9P I/O size. Reads keep up to
+ * `md->io_window` requests in flight. Replies are consumed in order; the
+ * transfer ends at the first short or failed reply, while requests that are
+ * still in flight at that point are drained and their results discarded.
+ * Writes are sent one at a time: requests in flight behind a short write
+ * would otherwise still land past the gap it leaves.
+ *
+ * Returns the number of contiguous bytes transferred, or a negative error
+ * code if nothing could be transferred.
+ */
+static int64_t uk_9pfs_rw_window(struct uk_9pfs_mount_data *md,
+				 struct uk_9pfid *fid, uint64_t offset,
+				 char *buf, uint64_t len, bool write)
+{
+	struct uk_9preq *reqs[CONFIG_LIB9PFS_IO_WINDOW];
+	uint32_t counts[CONFIG_LIB9PFS_IO_WINDOW];
+	unsigned int window = MIN(md->io_window, CONFIG_LIB9PFS_IO_WINDOW);
+	unsigned int head = 0, tail = 0, inflight = 0;
+	uint64_t submitted = 0, done = 0;
+	uint32_t maxcount, count;
+	struct uk_9preq *req;
+	int64_t bytes, err = 0;
+	bool stop = false;
+
+	if (write) {
+		maxcount = uk_9p_write_maxcount(md->dev, fid);
+		window = 1;
+	} else {
+		maxcount = uk_9p_read_maxcount(md->dev, fid);
+	}
+
+	do {
+		/* Fill the window. */
+		while (!stop && !err && submitted < len && inflight < window) {
+			count = MIN(len - submitted, maxcount);
+			if (write)
+				req = uk_9p_write_submit(md->dev, fid,
+							 offset + submitted,
+							 count,
+							 buf + submitted);
+			else
+				req = uk_9p_read_submit(md->dev, fid,
+							offset + submitted,
+							count, buf + submitted);
+			if (PTRISERR(req)) {
+				err = PTR2ERR(req);
+				break;
+			}
+
+			reqs[tail] = req;
+			counts[tail] = count;
+			tail = (tail + 1) % window;
+			inflight++;
+			submitted += count;
+		}
+
+		if (!inflight)
+			break;
+
+		/* Consume the oldest reply. */
+		bytes = uk_9p_rw_wait(md->dev, reqs[head]);
+		count = counts[head];
+		head = (head + 1) % window;
+		inflight--;
+
+		if (stop)
+			continue;
+
+		if (unlikely(bytes < 0)) {
+			err = bytes;
+			stop = true;
+			continue;
+		}
+
+		UK_ASSERT((uint64_t)bytes <= count);
+		done += bytes;
+		if ((uint64_t)bytes < count)
+			stop = true;
+	} while (inflight || (!stop && !err && submitted < len));
+
+	if (done || !err)
+		return done;
+	return err;
+}
+
 static int uk_9pfs_read(struct vnode *vp, struct vfscore_file *fp,
 			struct uio *uio, int ioflag __unused)
 {
-	struct uk_9pdev *dev = UK_9PFS_MD(vp->v_mount)->dev;
+	struct uk_9pfs_mount_data *md = UK_9PFS_MD(vp->v_mount);
 	struct uk_9pfid *fid = UK_9PFS_FD(fp)->fid;
 	struct iovec *iov;
+	uint64_t len;
 	int64_t bytes;
 	int i = 0;
 
@@ -593,15 +874,18 @@ static int uk_9pfs_read(struct vnode *vp, struct vfscore_file *fp,
 	if (!uio->uio_resid)
 		return 0;
 
-	while (i < uio->uio_iovcnt) {
+	while (i < uio->uio_iovcnt && uio->uio_offset < (off_t) vp->v_size) {
 		iov = &uio->uio_iov[i];
 		if (!iov->iov_len) {
 			i++;
 			continue;
 		}
 
-		bytes = uk_9p_read(dev, fid, uio->uio_offset,
-				   iov->iov_len, iov->iov_base);
+		/* Do not send requests past the end of the file */
+		len = MIN(iov->iov_len,
+			  (uint64_t) (vp->v_size - uio->uio_offset));
+		bytes = uk_9pfs_rw_window(md, fid, uio->uio_offset,
+					  iov->iov_base, len, false);
 		if (unlikely(bytes < 0))
 			return -(int)bytes;
 		if (!bytes)
@@ -665,8 +949,8 @@ static int uk_9pfs_write(struct vnode *vp, struct uio *uio, int ioflag)
 			continue;
 		}
 
-		bytes = uk_9p_write(dev, fid, uio->uio_offset,
-				    iov->iov_len, iov->iov_base);
+		bytes = uk_9pfs_rw_window(md, fid, uio->uio_offset,
+					  iov->iov_base, iov->iov_len, true);
 		if (unlikely(bytes < 0)) {
 			rc = (int)bytes;
 			break;
@@ -692,6 +976,8 @@ static int uk_9pfs_write(struct vnode *vp, struct uio *uio, int ioflag)
 	if (uio->uio_offset > vp->v_size)
 		vp->v_size = uio->uio_offset;
 
+	uk_9pfs_attr_invalidate(vp);
+
 out:
 	uk_9pfid_put(fid);
 	return -rc;
@@ -705,6 +991,9 @@ static int uk_9pfs_getattr(struct vnode *vp, struct vattr *attr)
 	struct uk_9preq *stat_req;
 	int rc = 0;
 
+	if (uk_9pfs_attr_cached(vp, attr))
+		return 0;
+
 	if (md->proto == UK_9P_PROTO_2000L) {
 		struct uk_9p_attr stat;
 
@@ -721,21 +1010,7 @@ static int uk_9pfs_getattr(struct vnode *vp, struct vattr *attr)
 			goto out;
 		}
 
-		attr->va_type = stat.mode & S_IFMT;
-		attr->va_mode = stat.mode & UK_ALLPERMS;
-		attr->va_nlink = stat.nlink;
-		attr->va_uid = stat.uid;
-		attr->va_gid = stat.gid;
-		attr->va_nodeid = vp->v_ino;
-		attr->va_atime.tv_sec = stat.atime_sec;
-		attr->va_atime.tv_nsec = stat.atime_nsec;
-		attr->va_mtime.tv_sec = stat.mtime_sec;
-		attr->va_mtime.tv_nsec = stat.mtime_nsec;
-		attr->va_ctime.tv_sec = stat.ctime_sec;
-		attr->va_ctime.tv_nsec = stat.ctime_nsec;
-		attr->va_rdev = stat.rdev;
-		attr->va_nblocks = stat.blocks;
-		attr->va_size = stat.size;
+		uk_9pfs_vattr_from_attr_l(vp, &stat, attr);
 
 	} else if (md->proto == UK_9P_PROTO_2000U) {
 		struct uk_9p_stat stat;
@@ -749,21 +1024,14 @@ static int uk_9pfs_getattr(struct vnode *vp, struct vattr *attr)
 		/* No stat string fields are used below. */
 		uk_9pdev_req_remove(dev, stat_req);
 
-		attr->va_type = uk_9pfs_vtype_from_mode(stat.mode);
-		attr->va_mode = uk_9pfs_posix_mode_from_mode(stat.mode);
-		attr->va_nodeid = vp->v_ino;
-		attr->va_size = stat.length;
-
-		attr->va_atime.tv_sec = stat.atime;
-		attr->va_atime.tv_nsec = 0;
-		attr->va_mtime.tv_sec = stat.mtime;
-		attr->va_mtime.tv_nsec = 0;
-		attr->va_ctime.tv_sec = 0;
-		attr->va_ctime.tv_nsec = 0;
+		uk_9pfs_vattr_from_stat_u(vp, &stat, attr);
 	} else {
 		rc = -EOPNOTSUPP;
+		goto out;
 	}
 
+	uk_9pfs_attr_update(vp, attr);
+
 out:
 	return -rc;
 }
@@ -774,6 +1042,8 @@ static int uk_9pfs_do_setattr(struct vnode *vp, struct uk_9pfid *fid,
 	struct uk_9pfs_mount_data *md = UK_9PFS_MD(vp->v_mount);
 	struct uk_9pdev *dev = md->dev;
 
+	uk_9pfs_attr_invalidate(vp);
+
 	if (md->proto == UK_9P_PROTO_2000L) {
 		uint32_t valid = 0;
 		uint32_t mode = 0;
@@ -927,6 +1197,10 @@ static int uk_9pfs_rename(struct vnode *dvp1, struct vnode *vp1,
 	if (dmd1->dev != dmd2->dev)
 		return EXDEV;
 
+	uk_9pfs_cache_invalidate(dvp1, name1);
+	uk_9pfs_cache_invalidate(dvp2, name2);
+	uk_9pfs_attr_invalidate(vp1);
+
 	if (dmd1->proto == UK_9P_PROTO_2000L) {
 		rc = uk_9p_renameat(dmd1->dev, dfid1, name1, dfid2, name2);
 		if (rc == -EOPNOTSUPP)
@@ -948,6 +1222,9 @@ static int uk_9pfs_link(struct vnode *dvp, struct vnode *svp, const char *name)
 	if (dmd->dev != smd->dev)
 		return EXDEV;
 
+	uk_9pfs_cache_invalidate(dvp, name);
+	uk_9pfs_attr_invalidate(svp);
+
 	if (dmd->proto == UK_9P_PROTO_2000L)
 		return -uk_9p_link(dmd->dev, dfid, sfid, name);
 	else
@@ -1004,6 +1281,8 @@ static int uk_9pfs_symlink(struct vnode *dvp, const char *op, const char *np)
 	struct uk_9pfid *dfid = UK_9PFS_VFID(dvp);
 	struct uk_9pfid *fid;
 
+	uk_9pfs_cache_invalidate(dvp, op);
+
 	fid = uk_9p_symlink(md->dev, dfid, op, np, 0);
 	if (PTRISERR(fid))
 		return -PTR2ERR(fid);
@@ -24,11 +24,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, preadv2, int, fd, const struct iovec *, iov,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_preadv2(sf.ofile, iov, iovcnt, offset, flags);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -49,11 +50,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, preadv, int, fd, const struct iovec *, iov,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_preadv(sf.ofile, iov, iovcnt, offset);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -81,11 +83,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, pread64, int, fd,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_pread(sf.ofile, buf, count, offset);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -107,11 +110,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, readv, int, fd,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_readv(sf.ofile, iov, iovcnt);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -129,11 +133,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, read, int, fd,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_read(sf.ofile, buf, count);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -151,11 +156,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, pwritev2, int, fd, const struct iovec*, iov,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_pwritev2(sf.ofile, iov, iovcnt, offset, flags);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -176,11 +182,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, pwritev, int, fd, const struct iovec*, iov,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_pwritev(sf.ofile, iov, iovcnt, offset);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -203,11 +210,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, pwrite64, int, fd,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_pwrite(sf.ofile, buf, count, offset);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -229,11 +237,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, writev, int, fd, const struct iovec *, iov,
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_writev(sf.ofile, iov, iovcnt);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -250,11 +259,12 @@ UK_SYSCALL_R_DEFINE(ssize_t, write, int, fd, const void *, buf, size_t, count)
 {
 	ssize_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_write(sf.ofile, buf, count);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
@@ -271,11 +281,12 @@ UK_SYSCALL_R_DEFINE(off_t, lseek, int, fd, off_t, offset, int, whence)
 {
 	off_t r;
 	union uk_shim_file sf;
+	int sflags;
 
-	switch (uk_fdtab_shim_get(fd, &sf)) {
+	switch (uk_fdtab_shim_get_light(fd, &sf, &sflags)) {
 	case UK_SHIM_OFILE:
 		r = uk_sys_lseek(sf.ofile, offset, whence);
-		uk_fdtab_ret(sf.ofile);
+		uk_fdtab_ret_light(sf.ofile, sflags);
 		break;
 #if CONFIG_LIBVFSCORE
 	case UK_SHIM_LEGACY:
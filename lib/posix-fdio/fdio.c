@@ -22,22 +22,9 @@
 
 #define _SHOULD_BLOCK(r, m) ((r) == -EAGAIN && _IS_BLOCKING((m)))
 
-/* RWF flags not supported by our libc's yet; defining them for bincompat */
-#ifndef RWF_NOWAIT
-#define RWF_NOWAIT	0x08
-#endif /* RWF_NOWAIT */
-
-#ifndef RWF_SYNC
-#define RWF_SYNC	0x04
-#endif /* RWF_SYNC */
-
-#ifndef RWF_DSYNC
-#define RWF_DSYNC	0x02
-#endif /* RWF_DSYNC */
-
-#ifndef RWF_APPEND
-#define RWF_APPEND	0x10
-#endif /* RWF_APPEND */
+/* Same, unless the caller asked not to wait (RWF_NOWAIT) */
+#define _SHOULD_BLOCK_RWF(r, m, f) \
+	(!((f) & RWF_NOWAIT) && _SHOULD_BLOCK((r), (m)))
 
 static inline
 ssize_t fdio_get_eof(const struct uk_file *f)
@@ -160,11 +147,6 @@ ssize_t uk_sys_preadv2(struct uk_ofile *of, const struct iovec *iov, int iovcnt,
 	int use_pos;
 	int iolock;
 
-	if (unlikely(flags & RWF_NOWAIT)) {
-		uk_pr_warn_once("STUB: preadv2 flag RWF_NOWAIT not supported");
-		return -EINVAL; /* Not supported */
-	}
-
 	mode = of->mode;
 
 	if (unlikely(!_CAN_READ(mode)))
@@ -173,7 +155,8 @@ ssize_t uk_sys_preadv2(struct uk_ofile *of, const struct iovec *iov, int iovcnt,
 		return -EINVAL;
 	if (unlikely(!iov && iovcnt))
 		return -EFAULT;
-	if (unlikely(offset < 0))
+	/* An offset of -1 selects the current file position */
+	if (unlikely(offset < -1))
 		return -EINVAL;
 
 	seekable = _IS_SEEKABLE(mode);
@@ -195,7 +178,7 @@ ssize_t uk_sys_preadv2(struct uk_ofile *of, const struct iovec *iov, int iovcnt,
 		r = uk_file_read(f, iov, iovcnt, off, xflags);
 		if (iolock)
 			uk_file_runlock(f);
-		if (!_SHOULD_BLOCK(r, mode))
+		if (!_SHOULD_BLOCK_RWF(r, mode, flags))
 			break;
 		if (use_pos)
 			_of_unlock(of);
@@ -338,7 +321,8 @@ ssize_t uk_sys_pwritev2(struct uk_ofile *of, const struct iovec *iov,
 		return -EINVAL;
 	if (unlikely(!iov && iovcnt))
 		return -EFAULT;
-	if (unlikely(offset < 0))
+	/* An offset of -1 selects the current file position */
+	if (unlikely(offset < -1))
 		return -EINVAL;
 
 	seekable = _IS_SEEKABLE(mode);
@@ -378,7 +362,7 @@ ssize_t uk_sys_pwritev2(struct uk_ofile *of, const struct iovec *iov,
 
 		if (iolock)
 			uk_file_wunlock(f);
-		if (!_SHOULD_BLOCK(r, mode))
+		if (!_SHOULD_BLOCK_RWF(r, mode, flags))
 			break;
 		if (use_pos)
 			_of_unlock(of);
@@ -13,6 +13,23 @@
 
 #include <uk/posix-fd.h>
 
+/* RWF flags not supported by our libc's yet; defining them for bincompat */
+#ifndef RWF_NOWAIT
+#define RWF_NOWAIT	0x08
+#endif /* RWF_NOWAIT */
+
+#ifndef RWF_SYNC
+#define RWF_SYNC	0x04
+#endif /* RWF_SYNC */
+
+#ifndef RWF_DSYNC
+#define RWF_DSYNC	0x02
+#endif /* RWF_DSYNC */
+
+#ifndef RWF_APPEND
+#define RWF_APPEND	0x10
+#endif /* RWF_APPEND */
+
 /* I/O */
 
 ssize_t uk_sys_preadv(struct uk_ofile *of, const struct iovec *iov, int iovcnt,
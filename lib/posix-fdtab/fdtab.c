@@ -9,6 +9,7 @@
 
 #include <uk/alloc.h>
 #include <uk/assert.h>
+#include <uk/atomic.h>
 #include <uk/config.h>
 #include <uk/init.h>
 #include <uk/syscall.h>
@@ -26,17 +27,31 @@
 #include <uk/prio.h>
 #endif /* CONFIG_LIBPOSIX_PROCESS_EXECVE */
 
+#if CONFIG_LIBPOSIX_FDTAB_LIGHT
+#include <uk/process.h>
+#endif /* CONFIG_LIBPOSIX_FDTAB_LIGHT */
+
 #define UK_FDTAB_SIZE CONFIG_LIBPOSIX_FDTAB_MAXFDS
 UK_CTASSERT(UK_FDTAB_SIZE <= UK_FD_MAX);
 
-/* Static init fdtab */
+#define UK_FDTAB_INITSIZE CONFIG_LIBPOSIX_FDTAB_INITFDS
+UK_CTASSERT(UK_FDTAB_INITSIZE > 0 && UK_FDTAB_INITSIZE <= UK_FDTAB_SIZE);
+
+/* Static init fdtab; further chunks of the map are allocated when needed */
 
 static char init_bmap[UK_BMAP_SZ(UK_FDTAB_SIZE)];
-static void *init_fdmap[UK_FDTAB_SIZE];
+static void *init_fdmap[UK_FMAP_CHUNK];
+static void *volatile *init_chunks[UK_FMAP_NCHUNKS(UK_FDTAB_SIZE)] = {
+	init_fdmap
+};
 
 struct uk_fdtab {
 	struct uk_alloc *alloc;
 	struct uk_fmap fmap;
+#if CONFIG_LIBPOSIX_FDTAB_LIGHT
+	/* Number of threads using the table */
+	int users;
+#endif /* CONFIG_LIBPOSIX_FDTAB_LIGHT */
 };
 
 static struct uk_fdtab init_fdtab = {
@@ -45,13 +60,17 @@ static struct uk_fdtab init_fdtab = {
 			.size = UK_FDTAB_SIZE,
 			.bitmap = (unsigned long *)init_bmap
 		},
-		.map = init_fdmap
-	}
+		.chunks = init_chunks
+	},
+#if CONFIG_LIBPOSIX_FDTAB_LIGHT
+	.users = 1,
+#endif /* CONFIG_LIBPOSIX_FDTAB_LIGHT */
 };
 
 static int init_posix_fdtab(struct uk_init_ctx *ictx __unused)
 {
 	init_fdtab.alloc = uk_alloc_get_default();
+	init_fdtab.fmap.alloc = init_fdtab.alloc;
 	/* Consider skipping init for .map (static vars are inited to 0) */
 	uk_fmap_init(&init_fdtab.fmap);
 	return 0;
@@ -63,6 +82,35 @@ static inline struct uk_fdtab *_active_tab(void)
 	return &init_fdtab;
 }
 
+#if CONFIG_LIBPOSIX_FDTAB_LIGHT
+/*
+ * While a single thread uses the table, nobody else can close its files,
+ * so lookups on its behalf need no references.
+ */
+static inline int fdtab_exclusive(struct uk_fdtab *tab)
+{
+	return UK_READ_ONCE(tab->users) == 1;
+}
+
+/* Every cloned thread shares the table of its parent */
+static int fdtab_clone(const struct clone_args *cl_args __unused,
+		       size_t cl_args_len __unused,
+		       struct uk_thread *child __unused,
+		       struct uk_thread *parent __unused)
+{
+	uk_inc(&_active_tab()->users);
+	return 0;
+}
+
+static void fdtab_clone_term(__u64 cl_flags __unused,
+			     struct uk_thread *child __unused)
+{
+	uk_dec(&_active_tab()->users);
+}
+
+UK_POSIX_CLONE_HANDLER(0x0, false, fdtab_clone, fdtab_clone_term);
+#endif /* CONFIG_LIBPOSIX_FDTAB_LIGHT */
+
 /* Encode flags in entry pointer using the least significant bits */
 /* made available by the open file structure's alignment */
 struct fdval {
@@ -158,6 +206,19 @@ void file_rel(struct uk_fdtab *tab, void *p, int flags __maybe_unused)
 
 #endif /* !CONFIG_LIBPOSIX_FDTAB_LEGACY_SHIM */
 
+/* Puts `entry` at the lowest free fd >= `min` */
+static int fdtab_put(struct uk_fdtab *tab, const void *entry, int min)
+{
+	int fd;
+
+	fd = uk_fmap_put(&tab->fmap, entry, min);
+	if (unlikely(fd < 0))
+		return fd;
+	if (fd >= UK_FDTAB_SIZE)
+		return -ENFILE;
+	return fd;
+}
+
 /* Ops */
 
 int uk_fdtab_open(const struct uk_file *f, unsigned int mode)
@@ -184,14 +245,31 @@ int uk_fdtab_open(const struct uk_file *f, unsigned int mode)
 	/* Place the file in fdtab */
 	flags = (mode & O_CLOEXEC) ? UK_FDTAB_CLOEXEC : 0;
 	entry = fdtab_encode(of, flags);
-	fd = uk_fmap_put(&tab->fmap, entry, 0);
-	if (fd >= UK_FDTAB_SIZE)
+	fd = fdtab_put(tab, entry, 0);
+	if (unlikely(fd < 0))
 		goto err_out;
 	return fd;
 err_out:
 	/* Release open file & file ref */
 	ofile_rel(tab, of);
-	return -ENFILE;
+	return fd;
+}
+
+int uk_fdtab_install(struct uk_ofile *of, int flags)
+{
+	struct uk_fdtab *tab;
+	const void *entry;
+	int fd;
+
+	UK_ASSERT(of);
+
+	tab = _active_tab();
+	ofile_acq(of);
+	entry = fdtab_encode(of, (flags & O_CLOEXEC) ? UK_FDTAB_CLOEXEC : 0);
+	fd = fdtab_put(tab, entry, 0);
+	if (unlikely(fd < 0))
+		ofile_rel(tab, of);
+	return fd;
 }
 
 int uk_fdtab_setflags(int fd, int flags)
@@ -247,14 +325,14 @@ int uk_fdtab_legacy_open(struct vfscore_file *vf)
 
 	fhold(vf);
 	entry = fdtab_encode(vf, UK_FDTAB_VFSCORE);
-	fd = uk_fmap_put(&tab->fmap, entry, 0);
-	if (fd >= UK_FDTAB_SIZE)
+	fd = fdtab_put(tab, entry, 0);
+	if (unlikely(fd < 0))
 		goto err_out;
 	vf->fd = fd;
 	return fd;
 err_out:
 	fdrop(vf);
-	return -ENFILE;
+	return fd;
 }
 
 struct vfscore_file *uk_fdtab_legacy_get(int fd)
@@ -314,6 +392,30 @@ int uk_fdtab_shim_get(int fd, union uk_shim_file *out)
 	}
 	return -1;
 }
+
+int uk_fdtab_shim_get_light(int fd, union uk_shim_file *out, int *flags)
+{
+#if CONFIG_LIBPOSIX_FDTAB_LIGHT
+	struct uk_fdtab *tab = _active_tab();
+	struct fdval v;
+	void *p;
+
+	if (fdtab_exclusive(tab)) {
+		p = uk_fmap_lookup(&tab->fmap, fd);
+		if (!p)
+			return -1;
+		v = fdtab_decode(p);
+		/* Legacy files are always referenced, vfscore drops them */
+		if (!(v.flags & UK_FDTAB_VFSCORE)) {
+			*flags = UK_FDTAB_F_LIGHT;
+			out->ofile = (struct uk_ofile *)v.p;
+			return UK_SHIM_OFILE;
+		}
+	}
+#endif /* CONFIG_LIBPOSIX_FDTAB_LIGHT */
+	*flags = 0;
+	return uk_fdtab_shim_get(fd, out);
+}
 #endif /* CONFIG_LIBPOSIX_FDTAB_LEGACY_SHIM */
 
 static struct fdval _fdtab_get(struct uk_fdtab *tab, int fd)
@@ -355,6 +457,30 @@ void uk_fdtab_ret(struct uk_ofile *of)
 	ofile_rel(_active_tab(), of);
 }
 
+struct uk_ofile *uk_fdtab_get_light(int fd, int *flags)
+{
+#if CONFIG_LIBPOSIX_FDTAB_LIGHT
+	struct uk_fdtab *tab = _active_tab();
+	struct fdval v;
+	void *p;
+
+	if (fdtab_exclusive(tab)) {
+		p = uk_fmap_lookup(&tab->fmap, fd);
+		if (!p)
+			return NULL;
+		v = fdtab_decode(p);
+#if CONFIG_LIBPOSIX_FDTAB_LEGACY_SHIM
+		if (v.flags & UK_FDTAB_VFSCORE)
+			return NULL;
+#endif /* CONFIG_LIBPOSIX_FDTAB_LEGACY_SHIM */
+		*flags = UK_FDTAB_F_LIGHT;
+		return (struct uk_ofile *)v.p;
+	}
+#endif /* CONFIG_LIBPOSIX_FDTAB_LIGHT */
+	*flags = 0;
+	return uk_fdtab_get(fd);
+}
+
 static void fdtab_cleanup(int all)
 {
 	struct uk_fdtab *tab = _active_tab();
@@ -447,7 +573,11 @@ int uk_sys_dup3(int oldfd, int newfd, int flags)
 	prevp = NULL;
 	newent = fdtab_encode(dup.p, dup.flags);
 	r = uk_fmap_xchg(&tab->fmap, newfd, newent, &prevp);
-	UK_ASSERT(!r); /* newfd should be in range */
+	if (unlikely(r)) {
+		UK_ASSERT(r == -ENOMEM); /* newfd should be in range */
+		file_rel(tab, dup.p, dup.flags);
+		return r;
+	}
 	if (prevp) {
 		struct fdval prevv = fdtab_decode(prevp);
 
@@ -487,11 +617,9 @@ int uk_sys_dup_min(int oldfd, int min, int flags)
 	dup.flags |= flags ? UK_FDTAB_CLOEXEC : 0;
 
 	newent = fdtab_encode(dup.p, dup.flags);
-	fd = uk_fmap_put(&tab->fmap, newent, min);
-	if (fd >= UK_FDTAB_SIZE) {
+	fd = fdtab_put(tab, newent, min);
+	if (unlikely(fd < 0))
 		file_rel(tab, dup.p, dup.flags);
-		return -ENFILE;
-	}
 	return fd;
 }
 
@@ -9,8 +9,10 @@
 #ifndef __UK_FDTAB_FMAP_H__
 #define __UK_FDTAB_FMAP_H__
 
+#include <errno.h>
 #include <string.h>
 
+#include <uk/alloc.h>
 #include <uk/atomic.h>
 #include <uk/assert.h>
 #include <uk/bitops.h>
@@ -138,25 +140,36 @@ static inline int uk_bmap_request(const struct uk_bmap *bm, int min)
 	return pos;
 }
 
+/**
+ * Number of entries per chunk of the map.
+ */
+#define UK_FMAP_CHUNK CONFIG_LIBPOSIX_FDTAB_INITFDS
+
 /**
  * Data structure mapping between integers and open file descriptions.
+ *
+ * The map of pointers is split into chunks of `UK_FMAP_CHUNK` entries that are
+ * allocated when first needed. Chunks are never moved nor freed, so the map
+ * grows without locking out concurrent operations.
  */
 struct uk_fmap {
 	/* Bitmap describing which file descriptors are free */
 	struct uk_bmap bmap;
-	/* Map of pointers to open file descriptions */
-	void *volatile *map;
+	/* Chunks of pointers to open file descriptions, NULL if not allocated */
+	void *volatile *volatile *chunks;
+	/* Allocator for new chunks */
+	struct uk_alloc *alloc;
 };
 
 /**
- * Gets the size of the map in bytes.
+ * Gets the number of chunks needed for a map.
  *
  * @param s
  *   Number of elements in the map
  * @return
- *   Size of the map in bytes
+ *   Number of chunks
  */
-#define UK_FMAP_SZ(s) ((s) * sizeof(void *))
+#define UK_FMAP_NCHUNKS(s) DIV_ROUND_UP(s, UK_FMAP_CHUNK)
 
 /**
  * Checks if the index given is in the range of the map.
@@ -173,17 +186,63 @@ struct uk_fmap {
 /**
  * Initializes the memory for a uk_fmap.
  *
- * The `size` field must be correctly set and the map buffers allocated.
+ * The `size` field must be correctly set, the bitmap and chunk array
+ * allocated, and the first chunk set. Other chunks must be NULL.
  *
  * @param m
  *   fmap to be initialized
  */
 static inline void uk_fmap_init(const struct uk_fmap *m)
 {
-	memset((void *)m->map, 0, m->bmap.size * sizeof(void *));
+	UK_ASSERT(m->chunks[0]);
+	memset((void *)m->chunks[0], 0, UK_FMAP_CHUNK * sizeof(void *));
 	uk_bmap_init(&m->bmap);
 }
 
+/**
+ * Returns the slot for `idx`, or NULL if its chunk is not allocated yet.
+ */
+static inline
+void *volatile *_fmap_slot(const struct uk_fmap *m, int idx)
+{
+	void *volatile *chunk;
+
+	chunk = uk_load_n(&m->chunks[idx / UK_FMAP_CHUNK]);
+	if (!chunk)
+		return NULL;
+	return &chunk[idx % UK_FMAP_CHUNK];
+}
+
+/**
+ * Returns the slot for `idx`, allocating its chunk if needed.
+ * Only call for indices reserved in the bitmap.
+ *
+ * @return
+ *   The slot, or NULL if out of memory
+ */
+static inline
+void *volatile *_fmap_slot_alloc(const struct uk_fmap *m, int idx)
+{
+	void *volatile *chunk;
+	void *volatile *exp;
+
+	chunk = _fmap_slot(m, idx);
+	if (likely(chunk))
+		return chunk;
+
+	chunk = uk_calloc(m->alloc, UK_FMAP_CHUNK, sizeof(void *));
+	if (unlikely(!chunk))
+		return NULL;
+	exp = NULL;
+	if (!uk_compare_exchange_n(&m->chunks[idx / UK_FMAP_CHUNK],
+				   &exp, chunk)) {
+		/* Lost race with another allocation, use theirs */
+		uk_free(m->alloc, (void *)chunk);
+		chunk = exp;
+	}
+	return &chunk[idx % UK_FMAP_CHUNK];
+}
+
 /**
  * Looks up and returns the entry at `idx`.
  *
@@ -201,13 +260,15 @@ static inline void uk_fmap_init(const struct uk_fmap *m)
  */
 static inline void *uk_fmap_lookup(const struct uk_fmap *m, int idx)
 {
+	void *volatile *slot;
 	void *got;
 
 	if (!_FMAP_INRANGE(m, idx))
 		return NULL;
 
 	do {
-		got = m->map[idx];
+		slot = _fmap_slot(m, idx);
+		got = slot ? *slot : NULL;
 		if (!got) {
 			if (uk_bmap_isfree(&m->bmap, idx))
 				break; /* Entry is actually free */
@@ -227,11 +288,13 @@ static inline void *uk_fmap_lookup(const struct uk_fmap *m, int idx)
  * @param min
  *   Start value from which we search the next free index
  * @return
- *   newly allocated index, or out of range if map full
+ *   newly allocated index, out of range if map full,
+ *   or -ENOMEM if a new chunk could not be allocated
  */
 static inline
 int uk_fmap_put(const struct uk_fmap *m, const void *p, int min)
 {
+	void *volatile *slot;
 	void *got __maybe_unused;
 	int pos;
 
@@ -239,7 +302,12 @@ int uk_fmap_put(const struct uk_fmap *m, const void *p, int min)
 	if (!_FMAP_INRANGE(m, pos))
 		return pos; /* Map full */
 
-	got = uk_exchange_n(&m->map[pos], (void *)p);
+	slot = _fmap_slot_alloc(m, pos);
+	if (unlikely(!slot)) {
+		(void)uk_bmap_free(&m->bmap, pos);
+		return -ENOMEM;
+	}
+	got = uk_exchange_n(slot, (void *)p);
 	UK_ASSERT(got == NULL); /* There can't be stuff in there, abort */
 
 	return pos;
@@ -257,6 +325,7 @@ int uk_fmap_put(const struct uk_fmap *m, const void *p, int min)
  */
 static inline void *uk_fmap_take(const struct uk_fmap *m, int idx)
 {
+	void *volatile *slot;
 	int v __maybe_unused;
 	void *got;
 
@@ -268,7 +337,8 @@ static inline void *uk_fmap_take(const struct uk_fmap *m, int idx)
 			return NULL; /* Already free */
 
 		/* At most one take thread gets the previous non-NULL value */
-		got = uk_exchange_n(&m->map[idx], NULL);
+		slot = _fmap_slot(m, idx);
+		got = slot ? uk_exchange_n(slot, NULL) : NULL;
 		if (!got)
 			/* We lost the race with a (critical) take, retry */
 			uk_sched_yield();
@@ -297,12 +367,14 @@ static inline void *uk_fmap_take(const struct uk_fmap *m, int idx)
 static inline
 void *uk_fmap_critical_take(const struct uk_fmap *m, int idx)
 {
+	void *volatile *slot;
 	void *got;
 
 	if (!_FMAP_INRANGE(m, idx))
 		return NULL;
 	do {
-		got = uk_exchange_n(&m->map[idx], NULL);
+		slot = _fmap_slot(m, idx);
+		got = slot ? uk_exchange_n(slot, NULL) : NULL;
 		if (!got) {
 			if (uk_bmap_isfree(&m->bmap, idx))
 				/* idx is actually empty */
@@ -332,13 +404,17 @@ void *uk_fmap_critical_take(const struct uk_fmap *m, int idx)
 static inline
 int uk_fmap_critical_put(const struct uk_fmap *m, int idx, const void *p)
 {
+	void *volatile *slot;
 	void *got __maybe_unused;
 
 	if (!_FMAP_INRANGE(m, idx))
 		return -1;
 
+	/* The chunk exists, we took an entry out of it */
+	slot = _fmap_slot(m, idx);
+	UK_ASSERT(slot);
 	(void)uk_bmap_reserve(&m->bmap, idx);
-	got = uk_exchange_n(&m->map[idx], p);
+	got = uk_exchange_n(slot, p);
 	UK_ASSERT(got == NULL);
 	return 0;
 }
@@ -358,12 +434,14 @@ int uk_fmap_critical_put(const struct uk_fmap *m, int idx, const void *p)
  * @param prev
  *   Previous entry that has been replaced
  * @return
- *   0 on success, non-zero if `idx` out of range
+ *   0 on success, -ENOMEM if a new chunk could not be allocated,
+ *   other non-zero if `idx` out of range
  */
 static inline
 int uk_fmap_xchg(const struct uk_fmap *m, int idx,
 		 const void *p, void **prev)
 {
+	void *volatile *slot;
 	void *got;
 
 	if (!_FMAP_INRANGE(m, idx))
@@ -385,7 +463,13 @@ int uk_fmap_xchg(const struct uk_fmap *m, int idx,
 			uk_sched_yield();
 		} else {
 			/* idx was free, we're basically a put now */
-			got = uk_exchange_n(&m->map[idx], p);
+			slot = _fmap_slot_alloc(m, idx);
+			if (unlikely(!slot)) {
+				(void)uk_bmap_free(&m->bmap, idx);
+				return -ENOMEM;
+			}
+			got = uk_exchange_n(slot, p);
+			*prev = NULL;
 			UK_ASSERT(got == NULL);
 			return 0;
 		}
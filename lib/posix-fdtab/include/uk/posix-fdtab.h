@@ -29,6 +29,22 @@
  */
 int uk_fdtab_open(const struct uk_file *f, unsigned int mode);
 
+/**
+ * Associates a new file descriptor with the existing open file description
+ * `of`, which then shares its position and mode with all other descriptors
+ * referring to it (e.g., file descriptors passed over AF_UNIX sockets).
+ *
+ * The caller keeps its own reference to `of`.
+ *
+ * @param of
+ *   Open file description to install
+ * @param flags
+ *   File descriptor flags. Currently only supports O_CLOEXEC.
+ * @return
+ *   The newly allocated file descriptor, < 0 on failure.
+ */
+int uk_fdtab_install(struct uk_ofile *of, int flags);
+
 /**
  * Gets the open file description associated with descriptor `fd`.
  *
@@ -49,6 +65,38 @@ struct uk_ofile *uk_fdtab_get(int fd);
  */
 void uk_fdtab_ret(struct uk_ofile *of);
 
+/* Set by uk_fdtab_get_light if no reference was taken */
+#define UK_FDTAB_F_LIGHT 0x1
+
+/**
+ * Like uk_fdtab_get, but skips locking and reference counting as long as the
+ * calling thread is the only user of the table (see LIBPOSIX_FDTAB_LIGHT).
+ * The returned open file must not outlive the caller's system call and must
+ * be returned with uk_fdtab_ret_light.
+ *
+ * @param fd
+ *   File descriptor to look up
+ * @param flags
+ *   Set to UK_FDTAB_F_LIGHT if no reference was taken, 0 otherwise
+ * @return
+ *   Open file or NULL if `fd` is not an open file descriptor.
+ */
+struct uk_ofile *uk_fdtab_get_light(int fd, int *flags);
+
+/**
+ * Returns an open file obtained through uk_fdtab_get_light.
+ *
+ * @param of
+ *   Open file description to be returned
+ * @param flags
+ *   Flags set by the lookup
+ */
+static inline void uk_fdtab_ret_light(struct uk_ofile *of, int flags)
+{
+	if (!(flags & UK_FDTAB_F_LIGHT))
+		uk_fdtab_ret(of);
+}
+
 /**
  * Sets flags on file descriptor. Currently only supports O_CLOEXEC.
  *
@@ -107,6 +155,21 @@ union uk_shim_file {
  */
 int uk_fdtab_shim_get(int fd, union uk_shim_file *out);
 
+/**
+ * Same as uk_fdtab_shim_get, but follows the rules of uk_fdtab_get_light for
+ * uk_ofile results. Legacy files are always referenced.
+ *
+ * @param fd
+ *   File descriptor to look up
+ * @param out
+ *   Open file description, of type either uk_ofile or vfscore_file
+ * @param flags
+ *   Set to UK_FDTAB_F_LIGHT if no reference was taken, 0 otherwise
+ * @return
+ *   Same as uk_fdtab_shim_get
+ */
+int uk_fdtab_shim_get_light(int fd, union uk_shim_file *out, int *flags);
+
 #define UK_SHIM_OFILE  0
 #define UK_SHIM_LEGACY 1
 
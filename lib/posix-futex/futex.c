@@ -76,6 +76,28 @@ struct uk_futex {
 static UK_LIST_HEAD(futex_list);
 static uk_spinlock futex_list_lock = UK_SPINLOCK_INITIALIZER();
 
+#if CONFIG_LIBPOSIX_FUTEX_SPIN > 0
+/**
+ * Poll the futex word for a bounded time while other lcpus can change it.
+ *
+ * @return 1 if the futex word no longer contains val, 0 otherwise
+ */
+static int futex_spin(uint32_t *uaddr, uint32_t val)
+{
+	unsigned int i;
+
+	if (ukplat_lcpu_count() < 2)
+		return 0;
+
+	for (i = 0; i < CONFIG_LIBPOSIX_FUTEX_SPIN; ++i) {
+		if (uk_load_n(uaddr) != val)
+			return 1;
+		ukarch_spinwait();
+	}
+	return 0;
+}
+#endif /* CONFIG_LIBPOSIX_FUTEX_SPIN > 0 */
+
 /**
  * Prepare to wait on a futex.
  *
@@ -108,6 +130,14 @@ static int futex_wait(uint32_t *uaddr, uint32_t val, const __nsec *timeout)
 		return -EAGAIN;
 	}
 
+#if CONFIG_LIBPOSIX_FUTEX_SPIN > 0
+	if (futex_spin(uaddr, val)) {
+		uk_pr_debug("FUTEX_WAIT: Futex changed while spinning (uaddr: %p)\n",
+			    uaddr);
+		return -EAGAIN;
+	}
+#endif /* CONFIG_LIBPOSIX_FUTEX_SPIN > 0 */
+
 	/* Futex word _does_ contain expected val */
 	uk_pr_debug("FUTEX_WAIT: Condition met (*uaddr == %"PRIu32", uaddr: %p)\n",
 			val, uaddr);
@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+/* io_uring compatible asynchronous I/O */
+
+#ifndef __UK_POSIX_IOURING_H__
+#define __UK_POSIX_IOURING_H__
+
+#include <sys/types.h>
+#include <linux/io_uring.h>
+
+#include <uk/config.h>
+#include <uk/file.h>
+#if CONFIG_LIBUKVMEM
+#include <uk/vmem.h>
+#endif /* CONFIG_LIBUKVMEM */
+
+/* File creation */
+
+/**
+ * Creates a ring with `entries` submission queue entries, as requested by the
+ * setup parameters `p`. On success, `p` is updated with the actual sizes,
+ * features and the offsets of the ring fields (see io_uring_setup(2)).
+ *
+ * @return Ring file or ERR2PTR(-errno)
+ */
+struct uk_file *uk_iouring_create(unsigned int entries,
+				  struct io_uring_params *p);
+
+/**
+ * Gets the ring memory of `f` that userspace maps at `off`
+ * (IORING_OFF_SQ_RING, IORING_OFF_CQ_RING or IORING_OFF_SQES). The memory
+ * stays valid as long as a reference to `f` is held.
+ *
+ * @return Address of the memory, ERR2PTR(-ENODEV) if `f` is not a ring, or
+ *    ERR2PTR(-EINVAL) if `off` and `len` do not match any ring memory
+ */
+void *uk_iouring_map(const struct uk_file *f, off_t off, size_t len);
+
+#if CONFIG_LIBUKVMEM
+/**
+ * Maps the ring memory of `f` at `off` (see uk_iouring_map) into `vas`. The
+ * mapping holds its own reference to the ring, so the memory stays valid until
+ * it is unmapped, even if `f` is closed first.
+ *
+ * @param vaddr
+ *   Address to map at or __VADDR_ANY; receives the address of the mapping
+ * @param attr
+ *   Page attributes of the mapping (see PAGE_ATTR_*)
+ * @param flags
+ *   Additional mapping flags (see UK_VMA_MAP_*)
+ *
+ * @return 0 on success, -ENODEV if `f` is not a ring, -EINVAL if `off` and
+ *    `len` do not match any ring memory, or another negative errno code
+ */
+int uk_iouring_vma_map(struct uk_vas *vas, const struct uk_file *f, off_t off,
+		       size_t len, unsigned long attr, unsigned long flags,
+		       __vaddr_t *vaddr);
+#endif /* CONFIG_LIBUKVMEM */
+
+/* Internal syscalls */
+
+int uk_sys_io_uring_setup(unsigned int entries, struct io_uring_params *p);
+
+int uk_sys_io_uring_enter(const struct uk_file *f, unsigned int to_submit,
+			  unsigned int min_complete, unsigned int flags,
+			  const void *arg, size_t argsz);
+
+int uk_sys_io_uring_register(const struct uk_file *f, unsigned int opcode,
+			     void *arg, unsigned int nr_args);
+
+#endif /* __UK_POSIX_IOURING_H__ */
@@ -0,0 +1,1179 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+
+#include <uk/alloc.h>
+#include <uk/arch/lcpu.h>
+#include <uk/arch/limits.h>
+#include <uk/assert.h>
+#include <uk/atomic.h>
+#include <uk/errptr.h>
+#include <uk/essentials.h>
+#include <uk/file/nops.h>
+#include <uk/list.h>
+#include <uk/mutex.h>
+#include <uk/plat/time.h>
+#include <uk/posix-fd.h>
+#include <uk/posix-fdio.h>
+#include <uk/posix-fdtab.h>
+#include <uk/posix-iouring.h>
+#include <uk/sched.h>
+#include <uk/semaphore.h>
+#include <uk/spinlock.h>
+#include <uk/syscall.h>
+#include <uk/timeutil.h>
+
+#if CONFIG_LIBUKVMEM
+#include <uk/arch/paging.h>
+#include <uk/plat/io.h>
+#include <uk/plat/paging.h>
+#include <uk/vmem.h>
+#endif /* CONFIG_LIBUKVMEM */
+
+#if CONFIG_LIBVFSCORE
+#include <vfscore/file.h>
+#include <vfscore/syscalls.h>
+#endif /* CONFIG_LIBVFSCORE */
+
+
+#define IOURING_MAX_ENTRIES CONFIG_LIBPOSIX_IOURING_MAX_ENTRIES
+#define IOURING_MAX_CQ_ENTRIES (2 * IOURING_MAX_ENTRIES)
+
+#if !POWER_OF_2(IOURING_MAX_ENTRIES)
+#error "CONFIG_LIBPOSIX_IOURING_MAX_ENTRIES must be a power of two"
+#endif
+
+#define IOURING_SETUP_FLAGS \
+	(IORING_SETUP_CQSIZE|IORING_SETUP_CLAMP|IORING_SETUP_SUBMIT_ALL| \
+	 IORING_SETUP_COOP_TASKRUN|IORING_SETUP_TASKRUN_FLAG| \
+	 IORING_SETUP_SINGLE_ISSUER|IORING_SETUP_DEFER_TASKRUN)
+
+#define IOURING_FEATURES \
+	(IORING_FEAT_SINGLE_MMAP|IORING_FEAT_SUBMIT_STABLE| \
+	 IORING_FEAT_RW_CUR_POS|IORING_FEAT_FAST_POLL| \
+	 IORING_FEAT_POLL_32BITS|IORING_FEAT_EXT_ARG|IORING_FEAT_CQE_SKIP)
+
+#define IOURING_SQE_FLAGS (IOSQE_ASYNC|IOSQE_CQE_SKIP_SUCCESS)
+
+#define IOURING_ENTER_FLAGS \
+	(IORING_ENTER_GETEVENTS|IORING_ENTER_SQ_WAKEUP| \
+	 IORING_ENTER_SQ_WAIT|IORING_ENTER_EXT_ARG)
+
+static const char IOURING_VOLID[] = "iouring_vol";
+
+static const __u8 iouring_ops[] = {
+	IORING_OP_NOP,
+	IORING_OP_READV,
+	IORING_OP_WRITEV,
+	IORING_OP_FSYNC,
+	IORING_OP_POLL_ADD,
+	IORING_OP_POLL_REMOVE,
+	IORING_OP_ASYNC_CANCEL,
+	IORING_OP_CLOSE,
+	IORING_OP_READ,
+	IORING_OP_WRITE,
+	IORING_OP_SEND,
+	IORING_OP_RECV
+};
+
+
+/* Ring fields shared with userspace; head and tail of each queue sit on
+ * their own cache line, as they are written by different sides.
+ */
+struct iouring_hdr {
+	struct {
+		__u32 head;
+		__u32 tail;
+		__u32 ring_mask;
+		__u32 ring_entries;
+		__u32 flags;
+		__u32 dropped;
+	} sq __align(CACHE_LINE_SIZE);
+	struct {
+		__u32 head;
+		__u32 tail;
+		__u32 ring_mask;
+		__u32 ring_entries;
+		__u32 overflow;
+		__u32 flags;
+	} cq __align(CACHE_LINE_SIZE);
+};
+
+#define IOURING_CQES_OFF ALIGN_UP(sizeof(struct iouring_hdr), CACHE_LINE_SIZE)
+
+struct iouring {
+	struct uk_alloc *a;
+	struct iouring_hdr *hdr; /* Followed by CQEs & SQ index array */
+	struct io_uring_cqe *cqes;
+	__u32 *sq_array;
+	struct io_uring_sqe *sqes;
+	size_t rings_sz;
+	size_t sqes_sz;
+	__u32 sq_entries;
+	__u32 cq_entries;
+	uk_spinlock lock; /* Serializes CQE posting & `reqs` */
+	struct uk_list_head reqs;
+	int refs; /* One for the file, each request in flight & each mapping */
+	int closed;
+};
+
+struct iouring_alloc {
+	struct uk_file f;
+	uk_file_refcnt frefcnt;
+	struct uk_file_state fstate;
+	struct iouring node;
+};
+
+/* Request states; a request is owned by whoever moves it out of ARMED */
+#define IOURING_REQ_IDLE   0 /* Being run */
+#define IOURING_REQ_ARMING 1 /* Registering for file events */
+#define IOURING_REQ_FIRED  2 /* Events arrived while arming */
+#define IOURING_REQ_ARMED  3 /* Waiting for file events */
+#define IOURING_REQ_QUEUED 4 /* Waiting for a worker */
+
+struct iouring_req {
+	struct iouring_req *next; /* Worker queue or cancellation list */
+	struct uk_list_head link; /* In ring->reqs */
+	struct iouring *ring;
+	struct io_uring_sqe sqe;
+	union uk_shim_file sf;
+	int legacy;
+	int state;
+	struct uk_pollq *pollq; /* Set while `tick` is registered */
+	struct uk_poll_chain tick;
+	int iovcnt;
+	struct iovec iov[];
+};
+
+/* Worker threads, shared by all rings */
+static struct {
+	uk_spinlock lock;
+	struct iouring_req *head;
+	struct iouring_req **tail;
+	struct uk_semaphore sem;
+	int started;
+} iouring_wq = {
+	.lock = UK_SPINLOCK_INITIALIZER(),
+	.head = NULL,
+	.tail = &iouring_wq.head,
+	.started = 0
+};
+
+static void iouring_req_run(struct iouring_req *req);
+
+/* Internal */
+
+static inline const struct uk_file *iouring_file(struct iouring *ring)
+{
+	return &__containerof(ring, struct iouring_alloc, node)->f;
+}
+
+static void iouring_put(struct iouring *ring)
+{
+	if (uk_dec(&ring->refs) == 1) {
+		struct iouring_alloc *al = __containerof(ring,
+							 struct iouring_alloc,
+							 node);
+
+		uk_free(ring->a, ring->sqes);
+		uk_free(ring->a, ring->hdr);
+		uk_free(ring->a, al);
+	}
+}
+
+static inline __u32 iouring_cq_ready(struct iouring *ring)
+{
+	return uk_load_n(&ring->hdr->cq.tail) - uk_load_n(&ring->hdr->cq.head);
+}
+
+/* Posts the completion of `sqe` with result `res` */
+static void iouring_complete(struct iouring *ring,
+			     const struct io_uring_sqe *sqe, int res)
+{
+	struct iouring_hdr *h = ring->hdr;
+	const struct uk_file *f;
+	struct io_uring_cqe *cqe;
+	__u32 tail;
+
+	if (res >= 0 && (sqe->flags & IOSQE_CQE_SKIP_SUCCESS))
+		return;
+
+	uk_spin_lock(&ring->lock);
+	tail = h->cq.tail;
+	if (unlikely(tail - uk_load_n(&h->cq.head) >= ring->cq_entries)) {
+		/* The completion is lost */
+		uk_store_n(&h->cq.overflow, h->cq.overflow + 1);
+	} else {
+		cqe = &ring->cqes[tail & h->cq.ring_mask];
+		cqe->user_data = sqe->user_data;
+		cqe->res = res;
+		cqe->flags = 0;
+		uk_store_n(&h->cq.tail, tail + 1);
+	}
+	uk_spin_unlock(&ring->lock);
+
+	/* Waiters clear POLLIN before re-checking the tail, see iouring_wait */
+	f = iouring_file(ring);
+	if (!uk_file_poll_immediate(f, UKFD_POLLIN))
+		uk_file_event_set(f, UKFD_POLLIN);
+}
+
+static void iouring_req_done(struct iouring_req *req, int res)
+{
+	struct iouring *ring = req->ring;
+
+	uk_spin_lock(&ring->lock);
+	uk_list_del(&req->link);
+	uk_spin_unlock(&ring->lock);
+
+	iouring_complete(ring, &req->sqe, res);
+	/* Legacy files are released by the vfscore call */
+	if (!req->legacy)
+		uk_fdtab_ret(req->sf.ofile);
+	uk_free(ring->a, req);
+	iouring_put(ring);
+}
+
+/* Worker queue */
+
+static void iouring_wq_push(struct iouring_req *req)
+{
+	req->next = NULL;
+	uk_spin_lock(&iouring_wq.lock);
+	*iouring_wq.tail = req;
+	iouring_wq.tail = &req->next;
+	uk_spin_unlock(&iouring_wq.lock);
+	uk_semaphore_up(&iouring_wq.sem);
+}
+
+static struct iouring_req *iouring_wq_pop(void)
+{
+	struct iouring_req *req;
+
+	uk_semaphore_down(&iouring_wq.sem);
+	uk_spin_lock(&iouring_wq.lock);
+	req = iouring_wq.head;
+	UK_ASSERT(req);
+	iouring_wq.head = req->next;
+	if (!iouring_wq.head)
+		iouring_wq.tail = &iouring_wq.head;
+	uk_spin_unlock(&iouring_wq.lock);
+	return req;
+}
+
+static __noreturn void iouring_worker(void *arg __unused)
+{
+	struct iouring_req *req;
+
+	for (;;) {
+		req = iouring_wq_pop();
+		if (req->pollq) {
+			uk_pollq_unregister(req->pollq, &req->tick);
+			req->pollq = NULL;
+		}
+		uk_store_n(&req->state, IOURING_REQ_IDLE);
+		iouring_req_run(req);
+	}
+}
+
+static int iouring_wq_start(void)
+{
+	static struct uk_mutex lock = UK_MUTEX_INITIALIZER(lock);
+	int n = 0;
+
+	if (likely(uk_load_n(&iouring_wq.started)))
+		return 0;
+
+	uk_mutex_lock(&lock);
+	if (!iouring_wq.started) {
+		uk_semaphore_init(&iouring_wq.sem, 0);
+		for (; n < CONFIG_LIBPOSIX_IOURING_WORKERS; n++)
+			if (unlikely(!uk_sched_thread_create(uk_sched_current(),
+							     iouring_worker,
+							     NULL,
+							     "iouring_worker")))
+				break;
+		/* A smaller pool still makes progress */
+		if (likely(n))
+			uk_store_n(&iouring_wq.started, 1);
+	} else {
+		n = 1;
+	}
+	uk_mutex_unlock(&lock);
+	return n ? 0 : -ENOMEM;
+}
+
+/* Cancellation */
+
+/**
+ * Cancels the first armed request submitted with `user_data`, or all armed
+ * requests if `all` is set. Requests that are running or about to run
+ * cannot be cancelled.
+ *
+ * @return 0 if a request was cancelled, -EALREADY if matching requests are
+ *    running, -ENOENT if none match
+ */
+static int iouring_cancel(struct iouring *ring, __u64 user_data, int all)
+{
+	struct iouring_req *claimed = NULL;
+	struct iouring_req *req;
+	int ret = -ENOENT;
+	int exp;
+
+	uk_spin_lock(&ring->lock);
+	uk_list_for_each_entry(req, &ring->reqs, link) {
+		if (!all && req->sqe.user_data != user_data)
+			continue;
+		exp = IOURING_REQ_ARMED;
+		if (uk_compare_exchange_n(&req->state, &exp,
+					  IOURING_REQ_IDLE)) {
+			req->next = claimed;
+			claimed = req;
+			ret = 0;
+			if (!all)
+				break;
+		} else if (ret) {
+			ret = -EALREADY;
+		}
+	}
+	uk_spin_unlock(&ring->lock);
+
+	while ((req = claimed)) {
+		claimed = req->next;
+		uk_pollq_unregister(req->pollq, &req->tick);
+		req->pollq = NULL;
+		iouring_req_done(req, -ECANCELED);
+	}
+	return ret;
+}
+
+/* Readiness */
+
+/* Called on events of the request file, with its propagation lock held */
+static void iouring_req_wake(uk_pollevent ev __unused,
+			     enum uk_poll_chain_op op,
+			     struct uk_poll_chain *tick)
+{
+	struct iouring_req *req = (struct iouring_req *)tick->arg;
+	int exp;
+
+	if (op != UK_POLL_CHAINOP_SET)
+		return;
+
+	exp = IOURING_REQ_ARMED;
+	if (uk_compare_exchange_n(&req->state, &exp, IOURING_REQ_QUEUED)) {
+		/* Unregistering must not happen from here; the worker does */
+		iouring_wq_push(req);
+		return;
+	}
+	exp = IOURING_REQ_ARMING;
+	(void)uk_compare_exchange_n(&req->state, &exp, IOURING_REQ_FIRED);
+}
+
+/**
+ * Waits for `ev` on the request file without blocking.
+ *
+ * @return 1 if the request was armed and must not be touched anymore,
+ *    0 if events arrived meanwhile and the request should be retried
+ */
+static int iouring_req_arm(struct iouring_req *req, uk_pollevent ev)
+{
+	struct uk_pollq *q = &req->sf.ofile->file->state->pollq;
+	struct iouring *ring = req->ring;
+	int exp;
+
+	req->tick = UK_POLL_CHAIN_CALLBACK(ev | UKFD_POLL_ALWAYS,
+					   iouring_req_wake, req);
+	uk_store_n(&req->state, IOURING_REQ_ARMING);
+	if (uk_pollq_poll_register(q, &req->tick, 0)) {
+		uk_store_n(&req->state, IOURING_REQ_IDLE);
+		return 0;
+	}
+	req->pollq = q;
+
+	/* Once armed, `req` and its ring reference may go away any time */
+	uk_inc(&ring->refs);
+	exp = IOURING_REQ_ARMING;
+	if (likely(uk_compare_exchange_n(&req->state, &exp,
+					 IOURING_REQ_ARMED))) {
+		/* Closing the ring cancels armed requests, see iouring_release;
+		 * catch up if it did so before we got here.
+		 */
+		if (unlikely(uk_load_n(&ring->closed)))
+			iouring_cancel(ring, 0, 1);
+		iouring_put(ring);
+		return 1;
+	}
+	iouring_put(ring);
+	UK_ASSERT(exp == IOURING_REQ_FIRED);
+	uk_pollq_unregister(q, &req->tick);
+	req->pollq = NULL;
+	uk_store_n(&req->state, IOURING_REQ_IDLE);
+	return 0;
+}
+
+/* Issuing */
+
+#if CONFIG_LIBVFSCORE
+/* Runs on a worker, as legacy files may block; consumes the file reference */
+static int iouring_req_issue_legacy(struct iouring_req *req)
+{
+	const struct io_uring_sqe *sqe = &req->sqe;
+	struct vfscore_file *vf = req->sf.vfile;
+	off_t off = (off_t)sqe->off;
+
+	switch (sqe->opcode) {
+	case IORING_OP_READV:
+	case IORING_OP_READ:
+		if (off == -1)
+			return vfscore_readv(vf, req->iov, req->iovcnt);
+		return vfscore_preadv(vf, req->iov, req->iovcnt, off);
+	case IORING_OP_RECV:
+		return vfscore_readv(vf, req->iov, req->iovcnt);
+	case IORING_OP_WRITEV:
+	case IORING_OP_WRITE:
+		if (off == -1)
+			return vfscore_writev(vf, req->iov, req->iovcnt);
+		return vfscore_pwritev(vf, req->iov, req->iovcnt, off);
+	case IORING_OP_SEND:
+		return vfscore_writev(vf, req->iov, req->iovcnt);
+	default:
+		fdrop(vf);
+		return -EOPNOTSUPP;
+	}
+}
+#endif /* CONFIG_LIBVFSCORE */
+
+/**
+ * Attempts the operation of `req` without blocking.
+ * If it would block and the request may wait, `*ev` is set to the events to
+ * wait for before retrying.
+ *
+ * @return Result of the operation, -EAGAIN if it would block
+ */
+static int iouring_req_issue(struct iouring_req *req, uk_pollevent *ev)
+{
+	const struct io_uring_sqe *sqe = &req->sqe;
+	struct uk_ofile *of = req->sf.ofile;
+	off_t off = (off_t)sqe->off;
+	int nowait;
+	int flags;
+	ssize_t r;
+
+#if CONFIG_LIBVFSCORE
+	if (req->legacy)
+		return iouring_req_issue_legacy(req);
+#endif /* CONFIG_LIBVFSCORE */
+
+	switch (sqe->opcode) {
+	case IORING_OP_SEND:
+	case IORING_OP_RECV:
+		off = -1;
+		flags = 0;
+		nowait = sqe->msg_flags & MSG_DONTWAIT;
+		break;
+	case IORING_OP_POLL_ADD:
+		r = uk_file_poll_immediate(of->file,
+					   sqe->poll32_events|UKFD_POLL_ALWAYS);
+		if (!r) {
+			*ev = sqe->poll32_events;
+			r = -EAGAIN;
+		}
+		return r;
+	case IORING_OP_FSYNC:
+		if (sqe->fsync_flags & IORING_FSYNC_DATASYNC)
+			return uk_sys_fdatasync(of);
+		return uk_sys_fsync(of);
+	default:
+		flags = sqe->rw_flags;
+		nowait = flags & RWF_NOWAIT;
+	}
+	nowait = nowait || (of->mode & O_NONBLOCK);
+
+	switch (sqe->opcode) {
+	case IORING_OP_READV:
+	case IORING_OP_READ:
+	case IORING_OP_RECV:
+		r = uk_sys_preadv2(of, req->iov, req->iovcnt, off,
+				   flags|RWF_NOWAIT);
+		if (r == -EAGAIN && !nowait)
+			*ev = UKFD_POLLIN;
+		break;
+	default:
+		r = uk_sys_pwritev2(of, req->iov, req->iovcnt, off,
+				    flags|RWF_NOWAIT);
+		if (r == -EAGAIN && !nowait)
+			*ev = UKFD_POLLOUT;
+	}
+	return r;
+}
+
+/* Runs `req` until it completes or waits for file events */
+static void iouring_req_run(struct iouring_req *req)
+{
+	uk_pollevent ev;
+	int r;
+
+	for (;;) {
+		ev = 0;
+		r = iouring_req_issue(req, &ev);
+		if (r != -EAGAIN || !ev)
+			break;
+		if (iouring_req_arm(req, ev))
+			return;
+	}
+	iouring_req_done(req, r);
+}
+
+/* Submission */
+
+/* Closing a ring from within a ring could free it mid-submission */
+static int iouring_close(int fd)
+{
+	struct uk_ofile *of;
+	int isring;
+
+	of = uk_fdtab_get(fd);
+	if (of) {
+		isring = of->file->vol == IOURING_VOLID;
+		uk_fdtab_ret(of);
+		if (unlikely(isring))
+			return -EBADF;
+	}
+	return uk_sys_close(fd);
+}
+
+/**
+ * Submits one SQE. Operations that cannot fail and cancellations complete
+ * right away, without allocating a request.
+ *
+ * @return 0 if the SQE was consumed, -EAGAIN if out of memory
+ */
+static int iouring_submit_one(struct iouring *ring,
+			      const struct io_uring_sqe *sqe)
+{
+	struct iouring_req *req;
+	unsigned int iovcnt;
+	int r;
+
+	if (unlikely(sqe->flags & ~IOURING_SQE_FLAGS)) {
+		iouring_complete(ring, sqe, -EINVAL);
+		return 0;
+	}
+
+	switch (sqe->opcode) {
+	case IORING_OP_NOP:
+		iouring_complete(ring, sqe, 0);
+		return 0;
+	case IORING_OP_CLOSE:
+		iouring_complete(ring, sqe, iouring_close(sqe->fd));
+		return 0;
+	case IORING_OP_POLL_REMOVE:
+	case IORING_OP_ASYNC_CANCEL:
+		iouring_complete(ring, sqe, iouring_cancel(ring, sqe->addr, 0));
+		return 0;
+	case IORING_OP_READV:
+	case IORING_OP_WRITEV:
+		iovcnt = sqe->len;
+		r = (iovcnt > UIO_MAXIOV) ? -EINVAL :
+		    (iovcnt && !sqe->addr) ? -EFAULT : 0;
+		break;
+	case IORING_OP_SEND:
+	case IORING_OP_RECV:
+		iovcnt = 1;
+		r = (sqe->msg_flags & ~(MSG_DONTWAIT|MSG_NOSIGNAL)) ?
+		    -EINVAL : 0;
+		break;
+	case IORING_OP_READ:
+	case IORING_OP_WRITE:
+		iovcnt = 1;
+		r = 0;
+		break;
+	case IORING_OP_POLL_ADD:
+		/* Multishot polls and poll updates are not supported */
+		iovcnt = 0;
+		r = sqe->len ? -EINVAL : 0;
+		break;
+	case IORING_OP_FSYNC:
+		iovcnt = 0;
+		r = (sqe->fsync_flags & ~IORING_FSYNC_DATASYNC) ? -EINVAL : 0;
+		break;
+	default:
+		iovcnt = 0;
+		r = -EINVAL;
+	}
+	if (unlikely(r)) {
+		iouring_complete(ring, sqe, r);
+		return 0;
+	}
+
+	req = uk_malloc(ring->a, sizeof(*req) + iovcnt * sizeof(req->iov[0]));
+	if (unlikely(!req))
+		return -EAGAIN;
+
+	/* Copy iovecs, userspace may reuse them once submitted */
+	switch (sqe->opcode) {
+	case IORING_OP_READV:
+	case IORING_OP_WRITEV:
+		if (iovcnt)
+			memcpy(req->iov, (const void *)(uintptr_t)sqe->addr,
+			       iovcnt * sizeof(req->iov[0]));
+		break;
+	case IORING_OP_POLL_ADD:
+	case IORING_OP_FSYNC:
+		break;
+	default:
+		req->iov[0].iov_base = (void *)(uintptr_t)sqe->addr;
+		req->iov[0].iov_len = sqe->len;
+	}
+	req->iovcnt = iovcnt;
+
+	r = uk_fdtab_shim_get(sqe->fd, &req->sf);
+	if (unlikely(r < 0)) {
+		uk_free(ring->a, req);
+		iouring_complete(ring, sqe, -EBADF);
+		return 0;
+	}
+	req->legacy = (r == UK_SHIM_LEGACY);
+	/* An armed poll would keep the ring open forever */
+	if (unlikely(sqe->opcode == IORING_OP_POLL_ADD && !req->legacy &&
+		     req->sf.ofile->file == iouring_file(ring))) {
+		uk_fdtab_ret(req->sf.ofile);
+		uk_free(ring->a, req);
+		iouring_complete(ring, sqe, -EINVAL);
+		return 0;
+	}
+	req->ring = ring;
+	req->sqe = *sqe;
+	req->pollq = NULL;
+	req->state = IOURING_REQ_IDLE;
+
+	uk_inc(&ring->refs);
+	uk_spin_lock(&ring->lock);
+	uk_list_add_tail(&req->link, &ring->reqs);
+	uk_spin_unlock(&ring->lock);
+
+	if (req->legacy || sqe->opcode == IORING_OP_FSYNC ||
+	    (sqe->flags & IOSQE_ASYNC)) {
+		req->state = IOURING_REQ_QUEUED;
+		iouring_wq_push(req);
+	} else {
+		iouring_req_run(req);
+	}
+	return 0;
+}
+
+/* Must be called with the ring file write-locked */
+static int iouring_submit(struct iouring *ring, unsigned int to_submit)
+{
+	struct iouring_hdr *h = ring->hdr;
+	struct io_uring_sqe sqe;
+	unsigned int n = 0;
+	__u32 head, tail;
+	__u32 idx;
+	int r = 0;
+
+	head = h->sq.head;
+	tail = uk_load_n(&h->sq.tail);
+	while (n < to_submit && head != tail) {
+		idx = ring->sq_array[head & h->sq.ring_mask];
+		if (unlikely(idx >= ring->sq_entries)) {
+			uk_store_n(&h->sq.dropped, h->sq.dropped + 1);
+			head++;
+			continue;
+		}
+		/* The SQE may be reused as soon as the head moves past it */
+		sqe = ring->sqes[idx];
+		r = iouring_submit_one(ring, &sqe);
+		if (unlikely(r))
+			break;
+		head++;
+		n++;
+	}
+	uk_store_n(&h->sq.head, head);
+	return n ? (int)n : r;
+}
+
+/* Waits until `min_complete` CQEs are ready or `deadline` passes */
+static int iouring_wait(const struct uk_file *f, unsigned int min_complete,
+			__nsec deadline)
+{
+	struct iouring *ring = (struct iouring *)f->node;
+	int ret = 0;
+
+	min_complete = MIN(min_complete, ring->cq_entries);
+	while (iouring_cq_ready(ring) < min_complete) {
+		uk_file_event_clear(f, UKFD_POLLIN);
+		if (iouring_cq_ready(ring) >= min_complete)
+			break;
+		if (!uk_file_poll_until(f, UKFD_POLLIN, deadline)) {
+			ret = -ETIME;
+			break;
+		}
+	}
+	/* Keep the ring readable for others */
+	if (iouring_cq_ready(ring))
+		uk_file_event_set(f, UKFD_POLLIN);
+	return ret;
+}
+
+/* File ops */
+
+static void iouring_release(const struct uk_file *f, int what)
+{
+	struct iouring *ring;
+
+	UK_ASSERT(f->vol == IOURING_VOLID);
+	ring = (struct iouring *)f->node;
+	if (what & UK_FILE_RELEASE_RES) {
+		/* Armed requests would only complete on events that may never
+		 * come; requests already running complete on their own.
+		 */
+		uk_store_n(&ring->closed, 1);
+		iouring_cancel(ring, 0, 1);
+	}
+	if (what & UK_FILE_RELEASE_OBJ)
+		iouring_put(ring);
+}
+
+static const struct uk_file_ops iouring_fops = {
+	.read = uk_file_nop_read,
+	.write = uk_file_nop_write,
+	.getstat = uk_file_nop_getstat,
+	.setstat = uk_file_nop_setstat,
+	.ctl = uk_file_nop_ctl
+};
+
+/* File creation */
+
+static __u32 iouring_roundup(__u32 n)
+{
+	__u32 r = 1;
+
+	while (r < n)
+		r <<= 1;
+	return r;
+}
+
+struct uk_file *uk_iouring_create(unsigned int entries,
+				  struct io_uring_params *p)
+{
+	struct uk_alloc *a;
+	struct iouring_alloc *al;
+	struct iouring *ring;
+	size_t array_off;
+	__u32 sq, cq;
+
+	if (unlikely(p->flags & ~IOURING_SETUP_FLAGS))
+		return ERR2PTR(-EINVAL);
+	if (unlikely(!entries))
+		return ERR2PTR(-EINVAL);
+	if (entries > IOURING_MAX_ENTRIES) {
+		if (!(p->flags & IORING_SETUP_CLAMP))
+			return ERR2PTR(-EINVAL);
+		entries = IOURING_MAX_ENTRIES;
+	}
+	sq = iouring_roundup(entries);
+
+	if (p->flags & IORING_SETUP_CQSIZE) {
+		if (unlikely(!p->cq_entries))
+			return ERR2PTR(-EINVAL);
+		cq = p->cq_entries;
+		if (cq > IOURING_MAX_CQ_ENTRIES) {
+			if (!(p->flags & IORING_SETUP_CLAMP))
+				return ERR2PTR(-EINVAL);
+			cq = IOURING_MAX_CQ_ENTRIES;
+		}
+		cq = iouring_roundup(cq);
+		if (unlikely(cq < sq))
+			return ERR2PTR(-EINVAL);
+	} else {
+		cq = 2 * sq;
+	}
+
+	/* Alloc stuff */
+	a = uk_alloc_get_default();
+	al = uk_malloc(a, sizeof(*al));
+	if (unlikely(!al))
+		return ERR2PTR(-ENOMEM);
+
+	ring = &al->node;
+	array_off = IOURING_CQES_OFF + cq * sizeof(struct io_uring_cqe);
+	*ring = (struct iouring){
+		.a = a,
+		/* Whole pages, as userspace maps them */
+		.rings_sz = ALIGN_UP(array_off + sq * sizeof(__u32),
+				     __PAGE_SIZE),
+		.sqes_sz = ALIGN_UP(sq * sizeof(struct io_uring_sqe),
+				    __PAGE_SIZE),
+		.sq_entries = sq,
+		.cq_entries = cq,
+		.refs = 1,
+		.closed = 0
+	};
+	ring->hdr = uk_memalign(a, __PAGE_SIZE, ring->rings_sz);
+	if (unlikely(!ring->hdr))
+		goto err_free_al;
+	ring->sqes = uk_memalign(a, __PAGE_SIZE, ring->sqes_sz);
+	if (unlikely(!ring->sqes))
+		goto err_free_hdr;
+	memset(ring->hdr, 0, ring->rings_sz);
+	memset(ring->sqes, 0, ring->sqes_sz);
+	ring->cqes = (struct io_uring_cqe *)((char *)ring->hdr +
+					     IOURING_CQES_OFF);
+	ring->sq_array = (__u32 *)((char *)ring->hdr + array_off);
+	ring->hdr->sq.ring_mask = sq - 1;
+	ring->hdr->sq.ring_entries = sq;
+	ring->hdr->cq.ring_mask = cq - 1;
+	ring->hdr->cq.ring_entries = cq;
+	uk_spin_init(&ring->lock);
+	UK_INIT_LIST_HEAD(&ring->reqs);
+
+	al->fstate = UK_FILE_STATE_INIT_VALUE(al->fstate);
+	al->frefcnt = UK_FILE_REFCNT_INIT_VALUE(al->frefcnt);
+	al->f = (struct uk_file){
+		.vol = IOURING_VOLID,
+		.node = ring,
+		.refcnt = &al->frefcnt,
+		.state = &al->fstate,
+		.ops = &iouring_fops,
+		._release = iouring_release
+	};
+	/* Submission never blocks */
+	uk_file_event_set(&al->f, UKFD_POLLOUT);
+
+	/* Report layout */
+	p->sq_entries = sq;
+	p->cq_entries = cq;
+	p->features = IOURING_FEATURES;
+	p->sq_off = (struct io_sqring_offsets){
+		.head = __offsetof(struct iouring_hdr, sq.head),
+		.tail = __offsetof(struct iouring_hdr, sq.tail),
+		.ring_mask = __offsetof(struct iouring_hdr, sq.ring_mask),
+		.ring_entries = __offsetof(struct iouring_hdr, sq.ring_entries),
+		.flags = __offsetof(struct iouring_hdr, sq.flags),
+		.dropped = __offsetof(struct iouring_hdr, sq.dropped),
+		.array = array_off
+	};
+	p->cq_off = (struct io_cqring_offsets){
+		.head = __offsetof(struct iouring_hdr, cq.head),
+		.tail = __offsetof(struct iouring_hdr, cq.tail),
+		.ring_mask = __offsetof(struct iouring_hdr, cq.ring_mask),
+		.ring_entries = __offsetof(struct iouring_hdr, cq.ring_entries),
+		.overflow = __offsetof(struct iouring_hdr, cq.overflow),
+		.cqes = IOURING_CQES_OFF,
+		.flags = __offsetof(struct iouring_hdr, cq.flags)
+	};
+	return &al->f;
+
+err_free_hdr:
+	uk_free(a, ring->hdr);
+err_free_al:
+	uk_free(a, al);
+	return ERR2PTR(-ENOMEM);
+}
+
+void *uk_iouring_map(const struct uk_file *f, off_t off, size_t len)
+{
+	struct iouring *ring;
+
+	if (f->vol != IOURING_VOLID)
+		return ERR2PTR(-ENODEV);
+
+	ring = (struct iouring *)f->node;
+	switch (off) {
+	case IORING_OFF_SQ_RING:
+	case IORING_OFF_CQ_RING:
+		if (unlikely(len > ring->rings_sz))
+			return ERR2PTR(-EINVAL);
+		return ring->hdr;
+	case IORING_OFF_SQES:
+		if (unlikely(len > ring->sqes_sz))
+			return ERR2PTR(-EINVAL);
+		return ring->sqes;
+	default:
+		return ERR2PTR(-EINVAL);
+	}
+}
+
+#if CONFIG_LIBUKVMEM
+/* Userspace mappings of ring memory; each holds a ring reference */
+
+struct iouring_vma {
+	struct uk_vma base;
+	struct iouring *ring;
+	__vaddr_t kaddr; /* Ring memory backing the start of the VMA */
+};
+
+static int iouring_vma_new(struct uk_vas *vas, __vaddr_t vaddr __unused,
+			   __sz len __unused, void *data,
+			   unsigned long attr __unused,
+			   unsigned long *flags __unused, struct uk_vma **vma)
+{
+	struct iouring_vma *args = (struct iouring_vma *)data;
+	struct iouring_vma *v;
+
+	UK_ASSERT(args);
+	UK_ASSERT(PAGE_ALIGNED(args->kaddr));
+
+	v = uk_malloc(vas->a, sizeof(*v));
+	if (unlikely(!v))
+		return -ENOMEM;
+
+	v->ring = args->ring;
+	v->kaddr = args->kaddr;
+	v->base.name = "io_uring";
+	uk_inc(&v->ring->refs);
+
+	UK_ASSERT(vma);
+	*vma = &v->base;
+	return 0;
+}
+
+static void iouring_vma_destroy(struct uk_vma *vma)
+{
+	iouring_put(((struct iouring_vma *)vma)->ring);
+}
+
+static int iouring_vma_fault(struct uk_vma *vma, struct uk_vm_fault *fault)
+{
+	struct iouring_vma *v = (struct iouring_vma *)vma;
+
+	/* Ring memory is only contiguous in the virtual address space */
+	UK_ASSERT(fault->len == PAGE_SIZE);
+	UK_ASSERT(fault->vbase >= vma->start && fault->vbase < vma->end);
+
+	fault->paddr = ukplat_virt_to_phys((void *)(v->kaddr + fault->vbase -
+						    vma->start));
+	return 0;
+}
+
+static int iouring_vma_unmap(struct uk_vma *vma, __vaddr_t vaddr, __sz len)
+{
+	UK_ASSERT(vaddr >= vma->start);
+	UK_ASSERT(vaddr + len <= vma->end);
+
+	/* The pages belong to the ring and go with its last reference */
+	return ukplat_page_unmap(vma->vas->pt, vaddr, len >> PAGE_SHIFT,
+				 PAGE_FLAG_KEEP_FRAMES);
+}
+
+static int iouring_vma_split(struct uk_vma *vma, __vaddr_t vaddr,
+			     struct uk_vma **new_vma)
+{
+	struct iouring_vma *v = (struct iouring_vma *)vma;
+	struct iouring_vma *nv;
+
+	UK_ASSERT(vaddr > vma->start && vaddr < vma->end);
+
+	nv = uk_malloc(vma->vas->a, sizeof(*nv));
+	if (unlikely(!nv))
+		return -ENOMEM;
+
+	nv->ring = v->ring;
+	nv->kaddr = v->kaddr + (vaddr - vma->start);
+	uk_inc(&nv->ring->refs);
+
+	UK_ASSERT(new_vma);
+	*new_vma = &nv->base;
+	return 0;
+}
+
+static int iouring_vma_merge(struct uk_vma *vma, struct uk_vma *next)
+{
+	struct iouring_vma *v = (struct iouring_vma *)vma;
+	struct iouring_vma *nv = (struct iouring_vma *)next;
+
+	UK_ASSERT(next->start == vma->end);
+
+	/* The reference of `next` is dropped when it is destroyed */
+	if (nv->ring != v->ring ||
+	    nv->kaddr != v->kaddr + (next->start - vma->start))
+		return -EPERM;
+	return 0;
+}
+
+static int iouring_vma_set_attr(struct uk_vma *vma, unsigned long attr)
+{
+	return ukplat_page_set_attr(vma->vas->pt, vma->start,
+				    (vma->end - vma->start) >> PAGE_SHIFT,
+				    attr, 0);
+}
+
+static const struct uk_vma_ops iouring_vma_ops = {
+	.get_base = NULL,
+	.new = iouring_vma_new,
+	.destroy = iouring_vma_destroy,
+	.fault = iouring_vma_fault,
+	.unmap = iouring_vma_unmap,
+	.split = iouring_vma_split,
+	.merge = iouring_vma_merge,
+	.set_attr = iouring_vma_set_attr,
+	.advise = NULL
+};
+
+int uk_iouring_vma_map(struct uk_vas *vas, const struct uk_file *f, off_t off,
+		       size_t len, unsigned long attr, unsigned long flags,
+		       __vaddr_t *vaddr)
+{
+	struct iouring_vma args;
+	void *mem;
+
+	mem = uk_iouring_map(f, off, len);
+	if (PTRISERR(mem))
+		return PTR2ERR(mem);
+
+	args.ring = (struct iouring *)f->node;
+	args.kaddr = (__vaddr_t)mem;
+	/* Pages of the ring are not physically contiguous */
+	flags |= UK_VMA_MAP_SIZE(PAGE_SHIFT) | UK_VMA_MAP_POPULATE;
+	return uk_vma_map(vas, vaddr, PAGE_ALIGN_UP(len), attr, flags, NULL,
+			  &iouring_vma_ops, &args);
+}
+#endif /* CONFIG_LIBUKVMEM */
+
+/* Internal syscalls */
+
+int uk_sys_io_uring_setup(unsigned int entries, struct io_uring_params *p)
+{
+	struct uk_file *f;
+	int r;
+
+	if (unlikely(!p))
+		return -EFAULT;
+	for (unsigned int i = 0; i < ARRAY_SIZE(p->resv); i++)
+		if (unlikely(p->resv[i]))
+			return -EINVAL;
+
+	r = iouring_wq_start();
+	if (unlikely(r))
+		return r;
+
+	f = uk_iouring_create(entries, p);
+	if (unlikely(PTRISERR(f)))
+		return PTR2ERR(f);
+
+	r = uk_fdtab_open(f, O_RDWR|O_CLOEXEC|UKFD_O_NOSEEK);
+	uk_file_release(f);
+	return r;
+}
+
+int uk_sys_io_uring_enter(const struct uk_file *f, unsigned int to_submit,
+			  unsigned int min_complete, unsigned int flags,
+			  const void *arg, size_t argsz)
+{
+	const struct io_uring_getevents_arg *ext;
+	__nsec deadline = 0;
+	int submitted = 0;
+	int r;
+
+	if (unlikely(f->vol != IOURING_VOLID))
+		return -EOPNOTSUPP;
+	if (unlikely(flags & ~IOURING_ENTER_FLAGS))
+		return -EINVAL;
+
+	/* Signal masks are ignored */
+	if (flags & IORING_ENTER_EXT_ARG) {
+		if (unlikely(argsz != sizeof(*ext)))
+			return -EINVAL;
+		if (unlikely(!arg))
+			return -EFAULT;
+		ext = (const struct io_uring_getevents_arg *)arg;
+		if (ext->ts)
+			deadline = ukplat_monotonic_clock() +
+				   uk_time_spec_to_nsec((const struct timespec *)
+							(uintptr_t)ext->ts);
+	}
+
+	if (to_submit) {
+		uk_file_wlock(f);
+		submitted = iouring_submit((struct iouring *)f->node,
+					   to_submit);
+		uk_file_wunlock(f);
+		if (unlikely(submitted < 0))
+			return submitted;
+	}
+
+	if (flags & IORING_ENTER_GETEVENTS) {
+		r = iouring_wait(f, min_complete, deadline);
+		if (unlikely(r) && !submitted)
+			return r;
+	}
+	return submitted;
+}
+
+static int iouring_probe(struct io_uring_probe *p, unsigned int nr_args)
+{
+	if (unlikely(!p))
+		return -EFAULT;
+
+	nr_args = MIN(nr_args, (unsigned int)IORING_OP_LAST);
+	memset(p, 0, sizeof(*p) + nr_args * sizeof(p->ops[0]));
+	p->last_op = IORING_OP_LAST - 1;
+	p->ops_len = nr_args;
+	for (unsigned int i = 0; i < nr_args; i++)
+		p->ops[i].op = i;
+	for (unsigned int i = 0; i < ARRAY_SIZE(iouring_ops); i++)
+		if (iouring_ops[i] < nr_args)
+			p->ops[iouring_ops[i]].flags = IO_URING_OP_SUPPORTED;
+	return 0;
+}
+
+int uk_sys_io_uring_register(const struct uk_file *f, unsigned int opcode,
+			     void *arg, unsigned int nr_args)
+{
+	if (unlikely(f->vol != IOURING_VOLID))
+		return -EOPNOTSUPP;
+
+	switch (opcode) {
+	case IORING_REGISTER_PROBE:
+		return iouring_probe((struct io_uring_probe *)arg, nr_args);
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Syscalls */
+
+UK_SYSCALL_R_DEFINE(int, io_uring_setup, unsigned int, entries,
+		    struct io_uring_params *, p)
+{
+	return uk_sys_io_uring_setup(entries, p);
+}
+
+UK_SYSCALL_R_DEFINE(int, io_uring_enter, unsigned int, fd,
+		    unsigned int, to_submit, unsigned int, min_complete,
+		    unsigned int, flags, const void *, arg, size_t, argsz)
+{
+	int r;
+	struct uk_ofile *of;
+
+	of = uk_fdtab_get(fd);
+	if (unlikely(!of))
+		return -EBADF;
+	r = uk_sys_io_uring_enter(of->file, to_submit, min_complete, flags,
+				  arg, argsz);
+	uk_fdtab_ret(of);
+	return r;
+}
+
+UK_SYSCALL_R_DEFINE(int, io_uring_register, unsigned int, fd,
+		    unsigned int, opcode, void *, arg, unsigned int, nr_args)
+{
+	int r;
+	struct uk_ofile *of;
+
+	of = uk_fdtab_get(fd);
+	if (unlikely(!of))
+		return -EBADF;
+	r = uk_sys_io_uring_register(of->file, opcode, arg, nr_args);
+	uk_fdtab_ret(of);
+	return r;
+}
@@ -0,0 +1,233 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <string.h>
+#include <time.h>
+#if CONFIG_LIBPOSIX_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /* CONFIG_LIBPOSIX_MMAP */
+
+#include <uk/config.h>
+#include <uk/errptr.h>
+#include <uk/posix-fd.h>
+#include <uk/posix-fdtab.h>
+#include <uk/posix-iouring.h>
+#include <uk/test.h>
+
+struct iouring_test {
+	int fd;
+	struct uk_ofile *of;
+	struct io_uring_params p;
+	char *rings;
+	struct io_uring_sqe *sqes;
+};
+
+static int iouring_test_setup(struct iouring_test *t)
+{
+	memset(&t->p, 0, sizeof(t->p));
+	t->fd = uk_sys_io_uring_setup(4, &t->p);
+	if (t->fd < 0)
+		return t->fd;
+	t->of = uk_fdtab_get(t->fd);
+	t->rings = uk_iouring_map(t->of->file, IORING_OFF_SQ_RING,
+				  t->p.sq_off.array +
+				  t->p.sq_entries * sizeof(__u32));
+	t->sqes = uk_iouring_map(t->of->file, IORING_OFF_SQES,
+				 t->p.sq_entries * sizeof(*t->sqes));
+	return 0;
+}
+
+static void iouring_test_teardown(struct iouring_test *t)
+{
+	uk_fdtab_ret(t->of);
+	uk_sys_close(t->fd);
+}
+
+#define RING_U32(t, off) (*(__u32 *)((t)->rings + (off)))
+
+/* Queues one SQE and returns it for filling in */
+static struct io_uring_sqe *iouring_test_sqe(struct iouring_test *t)
+{
+	__u32 tail = RING_U32(t, t->p.sq_off.tail);
+	__u32 idx = tail & RING_U32(t, t->p.sq_off.ring_mask);
+	__u32 *array = &RING_U32(t, t->p.sq_off.array);
+
+	array[idx] = idx;
+	memset(&t->sqes[idx], 0, sizeof(t->sqes[idx]));
+	RING_U32(t, t->p.sq_off.tail) = tail + 1;
+	return &t->sqes[idx];
+}
+
+/* Takes the next CQE off the ring, returns 0 if there is none */
+static int iouring_test_cqe(struct iouring_test *t, struct io_uring_cqe *out)
+{
+	__u32 head = RING_U32(t, t->p.cq_off.head);
+	struct io_uring_cqe *cqes;
+
+	if (head == RING_U32(t, t->p.cq_off.tail))
+		return 0;
+	cqes = (struct io_uring_cqe *)(t->rings + t->p.cq_off.cqes);
+	*out = cqes[head & RING_U32(t, t->p.cq_off.ring_mask)];
+	RING_U32(t, t->p.cq_off.head) = head + 1;
+	return 1;
+}
+
+UK_TESTCASE(posix_iouring, setup_nop)
+{
+	struct iouring_test t;
+	struct io_uring_sqe *sqe;
+	struct io_uring_cqe cqe;
+
+	UK_TEST_EXPECT_ZERO(iouring_test_setup(&t));
+	UK_TEST_EXPECT_SNUM_EQ(t.p.sq_entries, 4);
+	UK_TEST_EXPECT_SNUM_EQ(t.p.cq_entries, 8);
+	UK_TEST_EXPECT(!PTRISERR(t.rings));
+	UK_TEST_EXPECT(!PTRISERR(t.sqes));
+
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = 42;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 1,
+						     IORING_ENTER_GETEVENTS,
+						     NULL, 0), 1);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.user_data, 42);
+	UK_TEST_EXPECT_ZERO(cqe.res);
+	UK_TEST_EXPECT(!iouring_test_cqe(&t, &cqe));
+
+	iouring_test_teardown(&t);
+}
+
+UK_TESTCASE(posix_iouring, poll_cancel)
+{
+	struct timespec ts = { .tv_sec = 0, .tv_nsec = 1000000 };
+	struct io_uring_getevents_arg arg = {
+		.ts = (__u64)(uintptr_t)&ts
+	};
+	struct iouring_test t, other;
+	struct io_uring_sqe *sqe;
+	struct io_uring_cqe cqe;
+
+	UK_TEST_EXPECT_ZERO(iouring_test_setup(&t));
+	UK_TEST_EXPECT_ZERO(iouring_test_setup(&other));
+
+	/* A ring may not poll itself */
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = t.fd;
+	sqe->poll32_events = EPOLLIN;
+	sqe->user_data = 6;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 1,
+						     IORING_ENTER_GETEVENTS,
+						     NULL, 0), 1);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.res, -EINVAL);
+
+	/* Nothing ever raises POLLPRI on a ring */
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = other.fd;
+	sqe->poll32_events = EPOLLPRI;
+	sqe->user_data = 7;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 1,
+						     IORING_ENTER_GETEVENTS |
+						     IORING_ENTER_EXT_ARG,
+						     &arg, sizeof(arg)), 1);
+	UK_TEST_EXPECT(!iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 0, 1,
+						     IORING_ENTER_GETEVENTS |
+						     IORING_ENTER_EXT_ARG,
+						     &arg, sizeof(arg)),
+			       -ETIME);
+
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->addr = 7;
+	sqe->user_data = 8;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 2,
+						     IORING_ENTER_GETEVENTS,
+						     NULL, 0), 1);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.user_data, 7);
+	UK_TEST_EXPECT_SNUM_EQ(cqe.res, -ECANCELED);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.user_data, 8);
+	UK_TEST_EXPECT_ZERO(cqe.res);
+
+	/* Rings cannot be closed through a ring */
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_CLOSE;
+	sqe->fd = other.fd;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 1,
+						     IORING_ENTER_GETEVENTS,
+						     NULL, 0), 1);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.res, -EBADF);
+
+	iouring_test_teardown(&other);
+	iouring_test_teardown(&t);
+}
+
+#if CONFIG_LIBPOSIX_MMAP
+UK_TESTCASE(posix_iouring, mmap_close)
+{
+	struct iouring_test t;
+	struct io_uring_sqe *sqe;
+	struct io_uring_cqe cqe;
+	size_t rings_len, sqes_len;
+	void *rings, *sqes;
+
+	UK_TEST_EXPECT_ZERO(iouring_test_setup(&t));
+	rings_len = t.p.sq_off.array + t.p.sq_entries * sizeof(__u32);
+	sqes_len = t.p.sq_entries * sizeof(*t.sqes);
+
+	/* Unmapping leaves the ring alone */
+	rings = mmap(NULL, rings_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+		     t.fd, IORING_OFF_SQ_RING);
+	UK_TEST_EXPECT(rings != MAP_FAILED);
+	UK_TEST_EXPECT_ZERO(munmap(rings, rings_len));
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = 9;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 1,
+						     IORING_ENTER_GETEVENTS,
+						     NULL, 0), 1);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.user_data, 9);
+
+	/* Mappings share the ring memory and outlive the ring fd */
+	rings = mmap(NULL, rings_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+		     t.fd, IORING_OFF_SQ_RING);
+	sqes = mmap(NULL, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+		    t.fd, IORING_OFF_SQES);
+	UK_TEST_EXPECT(rings != MAP_FAILED);
+	UK_TEST_EXPECT(sqes != MAP_FAILED);
+	if (rings == MAP_FAILED || sqes == MAP_FAILED) {
+		iouring_test_teardown(&t);
+		return;
+	}
+	t.rings = rings;
+	t.sqes = sqes;
+	sqe = iouring_test_sqe(&t);
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = 10;
+	UK_TEST_EXPECT_SNUM_EQ(uk_sys_io_uring_enter(t.of->file, 1, 1,
+						     IORING_ENTER_GETEVENTS,
+						     NULL, 0), 1);
+	UK_TEST_EXPECT(iouring_test_cqe(&t, &cqe));
+	UK_TEST_EXPECT_SNUM_EQ(cqe.user_data, 10);
+
+	uk_fdtab_ret(t.of);
+	UK_TEST_EXPECT_ZERO(close(t.fd));
+	UK_TEST_EXPECT_SNUM_EQ(RING_U32(&t, t.p.sq_off.ring_entries), 4);
+	memset(sqes, 0, sqes_len);
+	UK_TEST_EXPECT_ZERO(munmap(rings, rings_len));
+	UK_TEST_EXPECT_ZERO(munmap(sqes, sqes_len));
+}
+#endif /* CONFIG_LIBPOSIX_MMAP */
+
+uk_testsuite_register(posix_iouring, NULL);
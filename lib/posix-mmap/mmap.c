@@ -15,6 +15,10 @@
 #include <uk/arch/limits.h>
 #include <uk/arch/lcpu.h>
 #include <uk/vmem.h>
+#if CONFIG_LIBPOSIX_IOURING
+#include <uk/posix-fdtab.h>
+#include <uk/posix-iouring.h>
+#endif /* CONFIG_LIBPOSIX_IOURING */
 
 #ifndef MAP_UNINITIALIZED
 #define MAP_UNINITIALIZED 0x4000000
@@ -40,6 +44,31 @@ static inline unsigned long prot_to_attr(int prot)
 	return attr;
 }
 
+#if CONFIG_LIBPOSIX_IOURING
+/* io_uring ring memory is shared with userspace through its own VMAs */
+static int do_mmap_iouring(struct uk_vas *vas, __vaddr_t *vaddr, size_t len,
+			   unsigned long vattr, unsigned long vflags, int fd,
+			   off_t offset)
+{
+	struct uk_ofile *of;
+	int rc;
+
+	of = uk_fdtab_get(fd);
+	if (!of)
+		return -ENODEV;
+	rc = uk_iouring_vma_map(vas, of->file, offset, len, vattr, vflags,
+				vaddr);
+	if (unlikely(rc) && rc != -ENODEV && *vaddr != __VADDR_ANY) {
+		/* addr was meant as a hint, see do_mmap */
+		*vaddr = __VADDR_ANY;
+		rc = uk_iouring_vma_map(vas, of->file, offset, len, vattr,
+					vflags, vaddr);
+	}
+	uk_fdtab_ret(of);
+	return rc;
+}
+#endif /* CONFIG_LIBPOSIX_IOURING */
+
 static int do_mmap(void **addr, size_t len, int prot, int flags, int fd,
 		   off_t offset)
 {
@@ -122,6 +151,15 @@ static int do_mmap(void **addr, size_t len, int prot, int flags, int fd,
 		vargs = NULL;
 		vops  = &uk_vma_anon_ops;
 	} else {
+#if CONFIG_LIBPOSIX_IOURING
+		rc = do_mmap_iouring(vas, &vaddr, len, vattr, vflags, fd,
+				     offset);
+		if (rc != -ENODEV) {
+			if (likely(rc == 0))
+				*addr = (void *)vaddr;
+			return rc;
+		}
+#endif /* CONFIG_LIBPOSIX_IOURING */
 #ifdef CONFIG_LIBVFSCORE
 		if ((flags & MAP_SHARED) ||
 		    (flags & MAP_SHARED_VALIDATE) == MAP_SHARED_VALIDATE)
@@ -254,6 +292,12 @@ UK_SYSCALL_R_DEFINE(int, madvise, void *, addr, size_t, len, int, advice)
 	case MADV_DONTNEED:
 		vadvice |= UK_VMA_ADV_DONTNEED;
 		break;
+	case MADV_HUGEPAGE:
+		vadvice |= UK_VMA_ADV_HUGEPAGE;
+		break;
+	case MADV_NOHUGEPAGE:
+		vadvice |= UK_VMA_ADV_NOHUGEPAGE;
+		break;
 	default:
 		/* Just ignore unsupported advices for now. The call to
 		 * uk_vma_advise() does not have an effect but will validate
@@ -445,6 +445,67 @@ typedef int (*posix_socket_ioctl_func_t)(posix_sock *sock,
  */
 typedef void (*posix_socket_poll_func_t)(posix_sock *sock);
 
+/**
+ * Optional: Poll the receive path of the socket once without blocking.
+ * Called by blocking receives with SO_BUSY_POLL set before the thread is put
+ * to sleep. The driver processes pending input of the receive queue that the
+ * socket maps to (e.g., by calling uk_netdev_rx_one()) and updates the socket
+ * events as usual.
+ *
+ * @param sock Reference to the socket
+ *
+ * @return >0 if input was processed, 0 if there was none, -errno otherwise
+ */
+typedef int (*posix_socket_busy_poll_func_t)(posix_sock *sock);
+
+/**
+ * Optional: Report the receive queue that the flow of the socket maps to.
+ * The value is returned to applications with SO_INCOMING_NAPI_ID so that
+ * they can distribute connections among threads by queue.
+ *
+ * @param sock Reference to the socket
+ *
+ * @return A non-zero identifier of the receive queue,
+ *    0 if the queue is not known (yet)
+ */
+typedef unsigned int (*posix_socket_rx_queue_func_t)(posix_sock *sock);
+
+struct mmsghdr;
+
+/**
+ * Optional: Send multiple messages on a socket with a single call. The
+ * driver sets `msg_len` of every message that it sent. Like sendmsg, the
+ * function does not block. Without this callback, the messages are sent one
+ * by one with sendmsg.
+ *
+ * @param sock Reference to the socket
+ * @param msgvec Array of messages to send
+ * @param vlen Number of messages in `msgvec`
+ * @param flags Bitwise OR of zero or more flags for the socket
+ *
+ * @return The number of messages sent (>0) on success,
+ *    -errno if not even the first message could be sent
+ */
+typedef int (*posix_socket_sendmmsg_func_t)(posix_sock *sock,
+		struct mmsghdr *msgvec, unsigned int vlen, int flags);
+
+/**
+ * Optional: Receive multiple messages from a socket with a single call. The
+ * driver returns as many messages as are pending, up to `vlen`, and sets
+ * `msg_len` of each. Like recvmsg, the function does not block. Without this
+ * callback, the messages are received one by one with recvmsg.
+ *
+ * @param sock Reference to the socket
+ * @param msgvec Array of messages to receive into
+ * @param vlen Number of messages in `msgvec`
+ * @param flags Bitwise OR of zero or more flags for the socket
+ *
+ * @return The number of messages received (>0) on success,
+ *    -errno if not even the first message could be received
+ */
+typedef int (*posix_socket_recvmmsg_func_t)(posix_sock *sock,
+		struct mmsghdr *msgvec, unsigned int vlen, int flags);
+
 /**
  * A structure containing the functions exported by a Unikraft socket driver
  */
@@ -474,6 +535,12 @@ struct posix_socket_ops {
 	posix_socket_close_func_t	close;
 	posix_socket_ioctl_func_t	ioctl;
 	posix_socket_poll_func_t	poll;
+	/* Receive queue integration */
+	posix_socket_busy_poll_func_t	busy_poll;
+	posix_socket_rx_queue_func_t	rx_queue;
+	/* Batched I/O (optional) */
+	posix_socket_sendmmsg_func_t	sendmmsg;
+	posix_socket_recvmmsg_func_t	recvmmsg;
 };
 
 static inline void *
@@ -685,6 +752,46 @@ posix_socket_poll(posix_sock *sock)
 	d->ops->poll(sock);
 }
 
+static inline int
+posix_socket_busy_poll(posix_sock *sock)
+{
+	struct posix_socket_driver *d = posix_sock_get_driver(sock);
+
+	if (!d->ops->busy_poll)
+		return -ENOTSUP;
+	return d->ops->busy_poll(sock);
+}
+
+static inline unsigned int
+posix_socket_rx_queue(posix_sock *sock)
+{
+	struct posix_socket_driver *d = posix_sock_get_driver(sock);
+
+	if (!d->ops->rx_queue)
+		return 0;
+	return d->ops->rx_queue(sock);
+}
+
+static inline int
+posix_socket_sendmmsg(posix_sock *sock, struct mmsghdr *msgvec,
+		      unsigned int vlen, int flags)
+{
+	struct posix_socket_driver *d = posix_sock_get_driver(sock);
+
+	UK_ASSERT(d->ops->sendmmsg);
+	return d->ops->sendmmsg(sock, msgvec, vlen, flags);
+}
+
+static inline int
+posix_socket_recvmmsg(posix_sock *sock, struct mmsghdr *msgvec,
+		      unsigned int vlen, int flags)
+{
+	struct posix_socket_driver *d = posix_sock_get_driver(sock);
+
+	UK_ASSERT(d->ops->recvmmsg);
+	return d->ops->recvmmsg(sock, msgvec, vlen, flags);
+}
+
 /**
  * Return the driver to the corresponding AF family number
  *
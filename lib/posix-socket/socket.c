@@ -52,6 +52,12 @@
 #include <uk/syscall.h>
 #include <uk/essentials.h>
 #include <errno.h>
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+#include <uk/plat/time.h>
+#if CONFIG_LIBUKSCHED
+#include <uk/sched.h>
+#endif /* CONFIG_LIBUKSCHED */
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
 
 #include "events.h"
 
@@ -71,17 +77,22 @@ struct socket_alloc {
 #if CONFIG_LIBPOSIX_SOCKET_EVENTS
 	struct uk_socket_event_data evd;
 #endif /* CONFIG_LIBPOSIX_SOCKET_EVENTS */
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+	/* Busy-poll period of blocking receives in us (SO_BUSY_POLL) */
+	unsigned int busy_poll;
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
 };
 
 
-static struct uk_ofile *socketfd_get(int fd)
+/* Returns the socket with uk_fdtab_ret_light(of, *flags) when done */
+static struct uk_ofile *socketfd_get(int fd, int *flags)
 {
-	struct uk_ofile *of = uk_fdtab_get(fd);
+	struct uk_ofile *of = uk_fdtab_get_light(fd, flags);
 
 	if (unlikely(!of))
 		return ERR2PTR(-EBADF);
 	if (unlikely(of->file->vol != POSIX_SOCKET_VOLID)) {
-		uk_fdtab_ret(of);
+		uk_fdtab_ret_light(of, *flags);
 		return ERR2PTR(-ENOTSOCK);
 	}
 	return of;
@@ -152,6 +163,56 @@ socket_write(const struct uk_file *sock,
 	return ret;
 }
 
+/*
+ * Sends a batch of messages with the sendmmsg callback of the driver, or one
+ * by one with sendmsg if the driver has none. Must be called with the file
+ * read-locked.
+ */
+static int
+socket_sendmmsg(const struct uk_file *sock, struct mmsghdr *msgvec,
+		unsigned int vlen, int flags)
+{
+	struct posix_socket_driver *d = posix_sock_get_driver(sock);
+	unsigned int i;
+	ssize_t ret;
+
+	if (d->ops->sendmmsg)
+		return posix_socket_sendmmsg(sock, msgvec, vlen, flags);
+
+	for (i = 0; i < vlen; ++i) {
+		ret = posix_socket_sendmsg(sock, &msgvec[i].msg_hdr, flags);
+		if (unlikely(ret < 0))
+			return i ? (int)i : (int)ret;
+		msgvec[i].msg_len = (unsigned int)ret;
+	}
+	return (int)vlen;
+}
+
+/*
+ * Receives a batch of messages with the recvmmsg callback of the driver, or
+ * one by one with recvmsg if the driver has none. Must be called with the
+ * file read-locked.
+ */
+static int
+socket_recvmmsg(const struct uk_file *sock, struct mmsghdr *msgvec,
+		unsigned int vlen, int flags)
+{
+	struct posix_socket_driver *d = posix_sock_get_driver(sock);
+	unsigned int i;
+	ssize_t ret;
+
+	if (d->ops->recvmmsg)
+		return posix_socket_recvmmsg(sock, msgvec, vlen, flags);
+
+	for (i = 0; i < vlen; ++i) {
+		ret = posix_socket_recvmsg(sock, &msgvec[i].msg_hdr, flags);
+		if (ret < 0)
+			return i ? (int)i : (int)ret;
+		msgvec[i].msg_len = (unsigned int)ret;
+	}
+	return (int)vlen;
+}
+
 static int
 socket_ctl(const struct uk_file *sock, int fam, int req,
 	   uintptr_t arg1, uintptr_t arg2 __unused, uintptr_t arg3 __unused)
@@ -239,9 +300,114 @@ static void _socket_init(struct socket_alloc *al,
 		.state = &al->fstate,
 		._release = socket_release
 	};
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+	al->busy_poll = CONFIG_LIBPOSIX_SOCKET_BUSY_POLL_DEFAULT;
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
 	posix_socket_poll(&al->f);
 }
 
+/*
+ * Waits until the socket becomes readable. With SO_BUSY_POLL set, the receive
+ * path of the driver is polled for the busy-poll period first.
+ */
+static void socket_wait_in(const struct uk_file *sock)
+{
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+	struct socket_alloc *al = __containerof(sock, struct socket_alloc, f);
+	__nsec deadline;
+	int rc;
+
+	if (al->busy_poll) {
+		deadline = ukplat_monotonic_clock() +
+			   ukarch_time_usec_to_nsec((__nsec) al->busy_poll);
+		do {
+			if (uk_file_poll_immediate(sock, UKFD_POLLIN))
+				return;
+
+			uk_file_rlock(sock);
+			rc = posix_socket_busy_poll(sock);
+			uk_file_runlock(sock);
+			if (unlikely(rc < 0))
+				break;
+#if CONFIG_LIBUKSCHED
+			/* Let the netdev dispatcher run if it owns the queue */
+			if (rc == 0)
+				uk_sched_yield();
+#endif /* CONFIG_LIBUKSCHED */
+		} while (ukplat_monotonic_clock() < deadline);
+	}
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
+	(void)uk_file_poll(sock, UKFD_POLLIN);
+}
+
+/*
+ * Socket options that are handled independently of the driver.
+ * Returns 1 if `optname` is not one of them.
+ */
+static int socket_getsockopt_common(const struct uk_file *sock, int level,
+				    int optname, void *restrict optval,
+				    socklen_t *restrict optlen)
+{
+	struct socket_alloc *al __maybe_unused;
+	int val;
+
+	if (level != SOL_SOCKET)
+		return 1;
+
+	switch (optname) {
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+	case SO_BUSY_POLL:
+		al = __containerof(sock, struct socket_alloc, f);
+		val = (int)al->busy_poll;
+		break;
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
+	case SO_INCOMING_NAPI_ID:
+		val = (int)posix_socket_rx_queue(sock);
+		break;
+	default:
+		return 1;
+	}
+
+	if (unlikely(!optval || !optlen))
+		return -EFAULT;
+	if (unlikely(*optlen < sizeof(val)))
+		return -EINVAL;
+	*(int *)optval = val;
+	*optlen = sizeof(val);
+	return 0;
+}
+
+static int socket_setsockopt_common(const struct uk_file *sock __maybe_unused,
+				    int level, int optname,
+				    const void *optval __maybe_unused,
+				    socklen_t optlen __maybe_unused)
+{
+	struct socket_alloc *al __maybe_unused;
+	int val __maybe_unused;
+
+	if (level != SOL_SOCKET)
+		return 1;
+
+	switch (optname) {
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+	case SO_BUSY_POLL:
+		if (unlikely(!optval))
+			return -EFAULT;
+		if (unlikely(optlen < sizeof(val)))
+			return -EINVAL;
+		val = *(const int *)optval;
+		if (unlikely(val < 0))
+			return -EINVAL;
+
+		al = __containerof(sock, struct socket_alloc, f);
+		al->busy_poll = (unsigned int)val;
+		return 0;
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
+	default:
+		return 1;
+	}
+}
+
 
 struct uk_file *uk_socket_create(int family, int type, int protocol)
 {
@@ -340,6 +506,9 @@ const struct uk_file *uk_socket_accept(const struct uk_file *sock, int blocking,
 	_socket_init(al, n->driver, new_data);
 
 	al_listener = __containerof(sock, struct socket_alloc, f);
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+	al->busy_poll = al_listener->busy_poll;
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
 #if CONFIG_LIBPOSIX_SOCKET_EVENTS
 	uk_socket_evd_init_from(&al->evd, &al_listener->evd);
 	uk_socket_evd_laddr_set_from(&al->evd, &al_listener->evd);
@@ -386,10 +555,11 @@ int do_accept4(int sock, struct sockaddr *addr, socklen_t *addr_len,
 	int ret;
 	unsigned int mode;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_accept(sock, addr, addr_len);
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -398,7 +568,7 @@ int do_accept4(int sock, struct sockaddr *addr, socklen_t *addr_len,
 	mode = of->mode;
 	ret = uk_sys_accept(of->file, _SHOULD_BLOCK(mode),
 			    addr, addr_len, flags);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret >= 0)
@@ -431,13 +601,14 @@ UK_SYSCALL_R_DEFINE(int, bind, int, sock, const struct sockaddr *, addr,
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_bind(sock, addr, addr_len);
 
 	if (unlikely(!addr))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -446,7 +617,7 @@ UK_SYSCALL_R_DEFINE(int, bind, int, sock, const struct sockaddr *, addr,
 	uk_file_wlock(of->file);
 	ret = posix_socket_bind(of->file, addr, addr_len);
 	uk_file_wunlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret) {
@@ -472,6 +643,7 @@ UK_SYSCALL_R_DEFINE(int, shutdown, int, sock, int, how)
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_shutdown(sock, how);
 
@@ -480,7 +652,7 @@ UK_SYSCALL_R_DEFINE(int, shutdown, int, sock, int, how)
 		goto out;
 	}
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -489,7 +661,7 @@ UK_SYSCALL_R_DEFINE(int, shutdown, int, sock, int, how)
 	uk_file_wlock(of->file);
 	ret = posix_socket_shutdown(of->file, how);
 	uk_file_wunlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret)
@@ -510,10 +682,11 @@ UK_SYSCALL_R_DEFINE(int, getpeername, int, sock,
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_getpeername(sock, addr, addr_len);
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -522,7 +695,7 @@ UK_SYSCALL_R_DEFINE(int, getpeername, int, sock,
 	uk_file_rlock(of->file);
 	ret = posix_socket_getpeername(of->file, addr, addr_len);
 	uk_file_runlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret)
@@ -543,10 +716,11 @@ UK_SYSCALL_R_DEFINE(int, getsockname, int, sock,
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_getsockname(sock, addr, addr_len);
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -555,7 +729,7 @@ UK_SYSCALL_R_DEFINE(int, getsockname, int, sock,
 	uk_file_rlock(of->file);
 	ret = posix_socket_getsockname(of->file, addr, addr_len);
 	uk_file_runlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret)
@@ -575,19 +749,24 @@ UK_SYSCALL_R_DEFINE(int, getsockopt, int, sock, int, level, int, optname,
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_getsockopt(sock, level, optname, optval, optlen);
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
 	}
 
 	uk_file_rlock(of->file);
-	ret = posix_socket_getsockopt(of->file, level, optname, optval, optlen);
+	ret = socket_getsockopt_common(of->file, level, optname,
+				       optval, optlen);
+	if (ret == 1)
+		ret = posix_socket_getsockopt(of->file, level, optname,
+					      optval, optlen);
 	uk_file_runlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret)
@@ -607,22 +786,27 @@ UK_SYSCALL_R_DEFINE(int, setsockopt, int, sock, int, level, int, optname,
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_setsockopt(sock, level, optname, optval, optlen);
 
 	if (unlikely(!optval))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
 	}
 
 	uk_file_rlock(of->file);
-	ret = posix_socket_setsockopt(of->file, level, optname, optval, optlen);
+	ret = socket_setsockopt_common(of->file, level, optname,
+				       optval, optlen);
+	if (ret == 1)
+		ret = posix_socket_setsockopt(of->file, level, optname,
+					      optval, optlen);
 	uk_file_runlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret)
@@ -643,13 +827,14 @@ UK_SYSCALL_R_DEFINE(int, connect, int, sock, const struct sockaddr *, addr,
 	int ret;
 	unsigned int mode;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_connect(sock, addr, addr_len);
 
 	if (unlikely(!addr))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -669,7 +854,7 @@ UK_SYSCALL_R_DEFINE(int, connect, int, sock, const struct sockaddr *, addr,
 					&ret, &_opsz);
 		uk_file_runlock(of->file);
 	}
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret && ret != -EINPROGRESS) {
@@ -693,10 +878,11 @@ UK_SYSCALL_R_DEFINE(int, listen, int, sock, int, backlog)
 {
 	int ret;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_listen(sock, backlog);
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -705,7 +891,7 @@ UK_SYSCALL_R_DEFINE(int, listen, int, sock, int, backlog)
 	uk_file_wlock(of->file);
 	ret = posix_socket_listen(of->file, backlog);
 	uk_file_wunlock(of->file);
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret) {
@@ -732,13 +918,14 @@ UK_SYSCALL_R_DEFINE(ssize_t, recvfrom, int, sock, void *, buf, size_t, len,
 	ssize_t ret;
 	unsigned int mode;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_recvfrom(sock, buf, len, flags, from, fromlen);
 
 	if (unlikely(!buf))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -752,9 +939,9 @@ UK_SYSCALL_R_DEFINE(ssize_t, recvfrom, int, sock, void *, buf, size_t, len,
 		uk_file_runlock(of->file);
 		if (!_SHOULD_BLOCK(mode) || !_ERR_BLOCK(ret))
 			break;
-		(void)uk_file_poll(of->file, UKFD_POLLIN);
+		socket_wait_in(of->file);
 	}
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret < 0 && ret != -EAGAIN)
@@ -782,13 +969,14 @@ UK_SYSCALL_R_DEFINE(ssize_t, recvmsg, int, sock, struct msghdr *, msg,
 	ssize_t ret;
 	unsigned int mode;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_recvmsg(sock, msg, flags);
 
 	if (unlikely(!msg || !msg->msg_iov))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -801,9 +989,9 @@ UK_SYSCALL_R_DEFINE(ssize_t, recvmsg, int, sock, struct msghdr *, msg,
 		uk_file_runlock(of->file);
 		if (!_SHOULD_BLOCK(mode) || !_ERR_BLOCK(ret))
 			break;
-		(void)uk_file_poll(of->file, UKFD_POLLIN);
+		socket_wait_in(of->file);
 	}
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret < 0 && ret != -EAGAIN)
@@ -824,13 +1012,14 @@ UK_SYSCALL_R_DEFINE(ssize_t, sendmsg, int, sock, const struct msghdr *, msg,
 	ssize_t ret;
 	unsigned int mode;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_sendmsg(sock, msg, flags);
 
 	if (unlikely(!msg || !msg->msg_iov))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -845,7 +1034,7 @@ UK_SYSCALL_R_DEFINE(ssize_t, sendmsg, int, sock, const struct msghdr *, msg,
 			break;
 		(void)uk_file_poll(of->file, UKFD_POLLOUT);
 	}
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret < 0 && ret != -EAGAIN)
@@ -855,6 +1044,154 @@ out:
 	return ret;
 }
 
+UK_TRACEPOINT(trace_posix_socket_sendmmsg, "%d %p %u %u", int,
+	      struct mmsghdr *, unsigned int, unsigned int);
+UK_TRACEPOINT(trace_posix_socket_sendmmsg_ret, "%d", int);
+UK_TRACEPOINT(trace_posix_socket_sendmmsg_err, "%d", int);
+
+/*
+ * Blocking sockets wait until all messages are sent. Non-blocking sockets
+ * return the number of messages that could be sent without blocking.
+ */
+UK_SYSCALL_R_DEFINE(int, sendmmsg, int, sock, struct mmsghdr *, msgvec,
+		    unsigned int, vlen, unsigned int, flags)
+{
+	int ret = 0;
+	unsigned int sent = 0;
+	unsigned int mode;
+	struct uk_ofile *of;
+	int ofl;
+
+	trace_posix_socket_sendmmsg(sock, msgvec, vlen, flags);
+
+	if (unlikely(!msgvec))
+		return -EFAULT;
+	if (vlen > UIO_MAXIOV)
+		vlen = UIO_MAXIOV;
+
+	of = socketfd_get(sock, &ofl);
+	if (unlikely(PTRISERR(of))) {
+		ret = PTR2ERR(of);
+		goto out;
+	}
+
+	mode = of->mode;
+	if (flags & MSG_DONTWAIT)
+		mode |= O_NONBLOCK;
+	while (sent < vlen) {
+		uk_file_rlock(of->file);
+		ret = socket_sendmmsg(of->file, msgvec + sent, vlen - sent,
+				      (int)flags);
+		uk_file_runlock(of->file);
+		if (ret > 0) {
+			sent += ret;
+			continue;
+		}
+		if (!_SHOULD_BLOCK(mode) || !_ERR_BLOCK(ret))
+			break;
+		(void)uk_file_poll(of->file, UKFD_POLLOUT);
+	}
+	uk_fdtab_ret_light(of, ofl);
+
+	/* Errors after the first message are reported by the next call */
+	if (sent)
+		ret = (int)sent;
+
+out:
+	if (ret < 0 && ret != -EAGAIN)
+		trace_posix_socket_sendmmsg_err(ret);
+	else
+		trace_posix_socket_sendmmsg_ret(ret);
+	return ret;
+}
+
+UK_TRACEPOINT(trace_posix_socket_recvmmsg, "%d %p %u %u %p", int,
+	      struct mmsghdr *, unsigned int, unsigned int, struct timespec *);
+UK_TRACEPOINT(trace_posix_socket_recvmmsg_ret, "%d", int);
+UK_TRACEPOINT(trace_posix_socket_recvmmsg_err, "%d", int);
+
+/*
+ * Blocking sockets wait until `vlen` messages were received, or only for the
+ * first one with MSG_WAITFORONE. As on Linux, the timeout is checked after
+ * each received batch, so a call does not time out while no data arrives.
+ */
+UK_SYSCALL_R_DEFINE(int, recvmmsg, int, sock, struct mmsghdr *, msgvec,
+		    unsigned int, vlen, unsigned int, flags,
+		    struct timespec *, timeout)
+{
+	int ret = 0;
+	unsigned int received = 0;
+	unsigned int mode;
+	bool waitforone;
+	__nsec deadline = 0;
+	__nsec now;
+	struct uk_ofile *of;
+	int ofl;
+
+	trace_posix_socket_recvmmsg(sock, msgvec, vlen, flags, timeout);
+
+	if (unlikely(!msgvec))
+		return -EFAULT;
+	if (timeout) {
+		if (unlikely(timeout->tv_sec < 0 || timeout->tv_nsec < 0 ||
+			     timeout->tv_nsec >= ukarch_time_sec_to_nsec(1)))
+			return -EINVAL;
+		deadline = ukplat_monotonic_clock() +
+			   ukarch_time_sec_to_nsec((__nsec)timeout->tv_sec) +
+			   (__nsec)timeout->tv_nsec;
+	}
+	if (vlen > UIO_MAXIOV)
+		vlen = UIO_MAXIOV;
+
+	of = socketfd_get(sock, &ofl);
+	if (unlikely(PTRISERR(of))) {
+		ret = PTR2ERR(of);
+		goto out;
+	}
+
+	mode = of->mode;
+	if (flags & MSG_DONTWAIT)
+		mode |= O_NONBLOCK;
+	waitforone = flags & MSG_WAITFORONE;
+	flags &= ~MSG_WAITFORONE;
+	while (received < vlen) {
+		uk_file_rlock(of->file);
+		ret = socket_recvmmsg(of->file, msgvec + received,
+				      vlen - received, (int)flags);
+		uk_file_runlock(of->file);
+		if (ret > 0) {
+			received += ret;
+			if (waitforone)
+				mode |= O_NONBLOCK;
+			if (timeout && ukplat_monotonic_clock() >= deadline)
+				break;
+			continue;
+		}
+		if (!_SHOULD_BLOCK(mode) || !_ERR_BLOCK(ret))
+			break;
+		socket_wait_in(of->file);
+	}
+	uk_fdtab_ret_light(of, ofl);
+
+	if (timeout) {
+		now = ukplat_monotonic_clock();
+		now = (now < deadline) ? deadline - now : 0;
+		timeout->tv_sec = ukarch_time_nsec_to_sec(now);
+		timeout->tv_nsec = ukarch_time_subsec(now);
+	}
+
+	/* Errors after the first message are reported by the next call */
+	if (received)
+		ret = (int)received;
+
+out:
+	if (ret < 0 && ret != -EAGAIN)
+		trace_posix_socket_recvmmsg_err(ret);
+	else
+		trace_posix_socket_recvmmsg_ret(ret);
+	return ret;
+}
+
 UK_TRACEPOINT(trace_posix_socket_sendto, "%d %p %d %d %p %d",
 	      int, const void *, size_t, int,
 	      const struct sockaddr *, socklen_t);
@@ -868,13 +1205,14 @@ UK_SYSCALL_R_DEFINE(ssize_t, sendto, int, sock, const void *, buf, size_t, len,
 	ssize_t ret;
 	unsigned int mode;
 	struct uk_ofile *of;
+	int ofl;
 
 	trace_posix_socket_sendto(sock, buf, len, flags, dest_addr, addrlen);
 
 	if (unlikely(!buf))
 		return -EFAULT;
 
-	of = socketfd_get(sock);
+	of = socketfd_get(sock, &ofl);
 	if (unlikely(PTRISERR(of))) {
 		ret = PTR2ERR(of);
 		goto out;
@@ -890,7 +1228,7 @@ UK_SYSCALL_R_DEFINE(ssize_t, sendto, int, sock, const void *, buf, size_t, len,
 			break;
 		(void)uk_file_poll(of->file, UKFD_POLLOUT);
 	}
-	uk_fdtab_ret(of);
+	uk_fdtab_ret_light(of, ofl);
 
 out:
 	if (ret < 0 && ret != -EAGAIN)
@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <uk/config.h>
+#include <uk/socket_driver.h>
+#include <uk/test.h>
+#if CONFIG_LIBUKSCHED
+#include <uk/sched.h>
+#include <uk/thread.h>
+#endif /* CONFIG_LIBUKSCHED */
+
+#if CONFIG_LIBPOSIX_SOCKET_BUSY_POLL
+/* Stub driver with a receive path that only the test feeds */
+#define STUB_AF AF_APPLETALK
+
+static struct stub_state {
+	posix_sock *sock;
+	unsigned int polls; /* busy_poll calls */
+	unsigned int ready_after; /* Polls until input arrives; 0 for never */
+	int ready;
+} stub;
+
+static void *stub_create(struct posix_socket_driver *d __unused,
+			 int family __unused, int type __unused,
+			 int protocol __unused)
+{
+	return &stub;
+}
+
+static int stub_close(posix_sock *sock __unused)
+{
+	return 0;
+}
+
+static void stub_poll(posix_sock *sock __unused)
+{
+}
+
+static int stub_getsockopt(posix_sock *sock __unused, int level __unused,
+			   int optname __unused, void *restrict optval __unused,
+			   socklen_t *restrict optlen __unused)
+{
+	return -ENOPROTOOPT;
+}
+
+static int stub_setsockopt(posix_sock *sock __unused, int level __unused,
+			   int optname __unused, const void *optval __unused,
+			   socklen_t optlen __unused)
+{
+	return -ENOPROTOOPT;
+}
+
+static ssize_t stub_recvfrom(posix_sock *sock, void *restrict buf, size_t len,
+			     int flags __unused, struct sockaddr *from __unused,
+			     socklen_t *restrict fromlen __unused)
+{
+	stub.sock = sock;
+	if (!stub.ready)
+		return -EAGAIN;
+
+	stub.ready = 0;
+	posix_sock_event_clear(sock, UKFD_POLLIN);
+	if (len)
+		*(char *)buf = 'x';
+	return 1;
+}
+
+static int stub_busy_poll(posix_sock *sock)
+{
+	if (++stub.polls != stub.ready_after)
+		return 0;
+
+	stub.ready = 1;
+	posix_sock_event_set(sock, UKFD_POLLIN);
+	return 1;
+}
+
+static struct posix_socket_ops stub_ops = {
+	.create = stub_create,
+	.getsockopt = stub_getsockopt,
+	.setsockopt = stub_setsockopt,
+	.recvfrom = stub_recvfrom,
+	.close = stub_close,
+	.poll = stub_poll,
+	.busy_poll = stub_busy_poll
+};
+
+POSIX_SOCKET_FAMILY_REGISTER(STUB_AF, &stub_ops);
+
+static int stub_socket(unsigned int ready_after, int busy_poll)
+{
+	int fd;
+
+	stub = (struct stub_state){ .ready_after = ready_after };
+	fd = socket(STUB_AF, SOCK_DGRAM, 0);
+	if (fd >= 0 &&
+	    setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll,
+		       sizeof(busy_poll))) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+UK_TESTCASE(posix_socket, busy_poll_spin)
+{
+	char c = 0;
+	int val;
+	socklen_t len = sizeof(val);
+	int fd;
+
+	fd = stub_socket(3, 1000000);
+	UK_TEST_EXPECT(fd >= 0);
+	if (fd < 0)
+		return;
+
+	UK_TEST_EXPECT_SNUM_EQ(setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL,
+					  NULL, sizeof(int)), -1);
+	UK_TEST_EXPECT_SNUM_EQ(errno, EFAULT);
+	UK_TEST_EXPECT_ZERO(getsockopt(fd, SOL_SOCKET, SO_BUSY_POLL,
+				       &val, &len));
+	UK_TEST_EXPECT_SNUM_EQ(val, 1000000);
+
+	/* Input arrives while spinning, the receive never sleeps */
+	UK_TEST_EXPECT_SNUM_EQ(recv(fd, &c, 1, 0), 1);
+	UK_TEST_EXPECT_SNUM_EQ(c, 'x');
+	UK_TEST_EXPECT_SNUM_EQ(stub.polls, 3);
+
+	close(fd);
+}
+
+#if CONFIG_LIBUKSCHED
+static __noreturn void stub_feeder_func(void *arg)
+{
+	struct uk_thread *receiver = (struct uk_thread *)arg;
+
+	/* Wait until the receiver gave up spinning and went to sleep */
+	while (!stub.sock || uk_thread_is_runnable(receiver))
+		uk_sched_yield();
+
+	stub.ready = 1;
+	posix_sock_event_set(stub.sock, UKFD_POLLIN);
+	uk_sched_thread_exit();
+}
+
+UK_TESTCASE(posix_socket, busy_poll_block)
+{
+	struct uk_thread *feeder;
+	char c = 0;
+	int fd;
+
+	fd = stub_socket(0, 1);
+	UK_TEST_EXPECT(fd >= 0);
+	if (fd < 0)
+		return;
+
+	feeder = uk_sched_thread_create(uk_sched_current(), stub_feeder_func,
+					uk_thread_current(), "Feeder");
+	UK_TEST_EXPECT_NOT_NULL(feeder);
+	if (!feeder)
+		goto out;
+
+	/* No input while spinning, the receive sleeps until it arrives */
+	UK_TEST_EXPECT_SNUM_EQ(recv(fd, &c, 1, 0), 1);
+	UK_TEST_EXPECT_SNUM_EQ(c, 'x');
+	UK_TEST_EXPECT(stub.polls >= 1);
+
+	while (!uk_thread_is_exited(feeder))
+		uk_sched_yield();
+out:
+	close(fd);
+}
+#endif /* CONFIG_LIBUKSCHED */
+#endif /* CONFIG_LIBPOSIX_SOCKET_BUSY_POLL */
+
+uk_testsuite_register(posix_socket, NULL);
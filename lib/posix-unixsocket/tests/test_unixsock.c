@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <uk/posix-pipe.h>
+#include <uk/sched.h>
+#include <uk/test.h>
+
+struct rights_sender {
+	int sock;
+	int fd;
+	ssize_t ret;
+};
+
+/* Sends `fd` over `sock` once the receiver had the chance to block */
+static __noreturn void rights_sender_func(void *arg)
+{
+	struct rights_sender *s = (struct rights_sender *)arg;
+	char ctl[CMSG_SPACE(sizeof(int))];
+	char c = 'x';
+	struct iovec iov = {
+		.iov_base = &c,
+		.iov_len = 1
+	};
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = ctl,
+		.msg_controllen = sizeof(ctl)
+	};
+	struct cmsghdr *cmsg;
+
+	uk_sched_yield();
+
+	memset(ctl, 0, sizeof(ctl));
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &s->fd, sizeof(int));
+	s->ret = sendmsg(s->sock, &msg, 0);
+	uk_sched_thread_exit();
+}
+
+UK_TESTCASE(posix_unixsocket, recvmsg_rights_blocking)
+{
+	struct rights_sender s;
+	struct uk_thread *sender;
+	char ctl[CMSG_SPACE(sizeof(int))];
+	char c = 0;
+	struct iovec iov = {
+		.iov_base = &c,
+		.iov_len = 1
+	};
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = ctl,
+		.msg_controllen = sizeof(ctl)
+	};
+	struct cmsghdr *cmsg;
+	int sv[2], p[2];
+	int fd;
+
+	UK_TEST_EXPECT_ZERO(socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+	UK_TEST_EXPECT_ZERO(uk_sys_pipe(p, 0));
+
+	s = (struct rights_sender){
+		.sock = sv[0],
+		.fd = p[0],
+		.ret = -1
+	};
+	sender = uk_sched_thread_create(uk_sched_current(),
+					rights_sender_func, &s, "Sender");
+	UK_TEST_EXPECT_NOT_NULL(sender);
+	if (!sender)
+		goto out;
+
+	/* Blocks until the sender runs; the fd must survive the retry */
+	UK_TEST_EXPECT_SNUM_EQ(recvmsg(sv[1], &msg, 0), 1);
+	UK_TEST_EXPECT_SNUM_EQ(c, 'x');
+	UK_TEST_EXPECT_SNUM_EQ(msg.msg_controllen, CMSG_SPACE(sizeof(int)));
+	UK_TEST_EXPECT_ZERO(msg.msg_flags & MSG_CTRUNC);
+
+	while (!uk_thread_is_exited(sender))
+		uk_sched_yield();
+	UK_TEST_EXPECT_SNUM_EQ(s.ret, 1);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	UK_TEST_EXPECT_NOT_NULL(cmsg);
+	if (!cmsg)
+		goto out;
+	UK_TEST_EXPECT_SNUM_EQ(cmsg->cmsg_level, SOL_SOCKET);
+	UK_TEST_EXPECT_SNUM_EQ(cmsg->cmsg_type, SCM_RIGHTS);
+	memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+	/* The received fd is the read end of the pipe */
+	UK_TEST_EXPECT_SNUM_EQ(write(p[1], "y", 1), 1);
+	UK_TEST_EXPECT_SNUM_EQ(read(fd, &c, 1), 1);
+	UK_TEST_EXPECT_SNUM_EQ(c, 'y');
+	close(fd);
+
+out:
+	close(p[0]);
+	close(p[1]);
+	close(sv[0]);
+	close(sv[1]);
+}
+
+uk_testsuite_register(posix_unixsocket, NULL);
@@ -0,0 +1,378 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <string.h>
+
+#include <uk/assert.h>
+#include <uk/atomic.h>
+#include <uk/essentials.h>
+#include <uk/file/nops.h>
+#include <uk/posix-fd.h>
+#include <uk/posix-fdtab.h>
+
+#include "unixsock-stream.h"
+
+
+#define USTREAM_LIMIT CONFIG_LIBPOSIX_UNIXSOCKET_STREAM_BUFSIZE
+
+/* Data is queued in chunks that are allocated as needed and freed as soon as
+ * they are read. Small writes get small chunks, later writes fill them up.
+ */
+struct ustream_chunk {
+	struct ustream_chunk *next;
+	struct unix_rights *rights; /* Sent along with the first byte */
+	__u32 start;
+	__u32 end;
+	__u32 size;
+	char buf[];
+};
+
+#define USTREAM_CHUNK_MIN ((size_t)256)
+#define USTREAM_CHUNK_MAX (4096 - sizeof(struct ustream_chunk))
+
+struct unix_stream {
+	struct uk_alloc *a;
+	struct ustream_chunk *head;
+	struct ustream_chunk *tail;
+	size_t used;
+	unsigned int flags;
+};
+
+#define USTREAM_HUP 1
+#define USTREAM_FIN 2
+
+struct ustream_alloc {
+	struct uk_file rf;
+	struct uk_file wf;
+	uk_file_refcnt rref;
+	uk_file_refcnt wref;
+	struct uk_file_state fstate;
+	struct unix_stream node;
+};
+
+static const char USTREAM_VOLID[] = "unix_stream_vol";
+
+/* Position within an iovec array */
+struct ustream_iovc {
+	const struct iovec *iov;
+	size_t off;
+};
+
+
+struct unix_rights *unix_rights_alloc(struct uk_alloc *a, unsigned int count)
+{
+	struct unix_rights *r;
+
+	r = uk_malloc(a, sizeof(*r) + count * sizeof(r->of[0]));
+	if (unlikely(!r))
+		return NULL;
+	r->a = a;
+	r->count = 0;
+	return r;
+}
+
+void unix_rights_free(struct unix_rights *r)
+{
+	for (unsigned int i = 0; i < r->count; i++)
+		uk_fdtab_ret(r->of[i]);
+	uk_free(r->a, r);
+}
+
+
+static ssize_t _iovsz(const struct iovec *iov, int iovcnt)
+{
+	size_t ret = 0;
+
+	for (int i = 0; i < iovcnt; i++)
+		if (iov[i].iov_len) {
+			if (likely(iov[i].iov_base))
+				ret += iov[i].iov_len;
+			else
+				return -EFAULT;
+		}
+	return ret;
+}
+
+/* Copies `n` bytes from the iovec position into `buf` and advances it */
+static void ustream_iov_in(struct ustream_iovc *c, char *buf, size_t n)
+{
+	size_t len;
+
+	while (n) {
+		len = MIN(c->iov->iov_len - c->off, n);
+		memcpy(buf, (const char *)c->iov->iov_base + c->off, len);
+		buf += len;
+		n -= len;
+		c->off += len;
+		if (c->off == c->iov->iov_len) {
+			c->iov++;
+			c->off = 0;
+		}
+	}
+}
+
+/* Copies `n` bytes from `buf` to the iovec position and advances it */
+static void ustream_iov_out(struct ustream_iovc *c, const char *buf, size_t n)
+{
+	size_t len;
+
+	while (n) {
+		len = MIN(c->iov->iov_len - c->off, n);
+		memcpy((char *)c->iov->iov_base + c->off, buf, len);
+		buf += len;
+		n -= len;
+		c->off += len;
+		if (c->off == c->iov->iov_len) {
+			c->iov++;
+			c->off = 0;
+		}
+	}
+}
+
+static void ustream_chunk_free(struct unix_stream *d, struct ustream_chunk *ch)
+{
+	if (ch->rights)
+		unix_rights_free(ch->rights);
+	uk_free(d->a, ch);
+}
+
+
+ssize_t unix_stream_send(const struct uk_file *f,
+			 const struct iovec *iov, int iovcnt,
+			 struct unix_rights *rights)
+{
+	struct ustream_iovc c = { .iov = iov, .off = 0 };
+	struct ustream_chunk *ch;
+	struct unix_stream *d;
+	ssize_t towrite;
+	size_t written = 0;
+	size_t n;
+
+	UK_ASSERT(f->vol == USTREAM_VOLID);
+
+	d = (struct unix_stream *)f->node;
+	if (unlikely(d->flags & USTREAM_HUP))
+		return -EPIPE;
+
+	towrite = _iovsz(iov, iovcnt);
+	if (unlikely(towrite <= 0))
+		return towrite;
+
+	if (d->used >= USTREAM_LIMIT) {
+		uk_file_event_clear(f, UKFD_POLLOUT);
+		return -EAGAIN;
+	}
+	towrite = MIN((size_t)towrite, USTREAM_LIMIT - d->used);
+
+	/* Top up the last chunk, unless files must start a new one */
+	ch = d->tail;
+	if (ch && !rights && ch->end < ch->size) {
+		n = MIN((size_t)towrite, ch->size - ch->end);
+		ustream_iov_in(&c, &ch->buf[ch->end], n);
+		ch->end += n;
+		written = n;
+	}
+
+	while (written < (size_t)towrite) {
+		n = MIN((size_t)towrite - written, USTREAM_CHUNK_MAX);
+		ch = uk_malloc(d->a, sizeof(*ch) + MAX(n, USTREAM_CHUNK_MIN));
+		if (unlikely(!ch))
+			break;
+		ch->next = NULL;
+		ch->rights = NULL;
+		ch->start = 0;
+		ch->end = n;
+		ch->size = MAX(n, USTREAM_CHUNK_MIN);
+		ustream_iov_in(&c, ch->buf, n);
+		if (rights) {
+			UK_ASSERT(!written);
+			ch->rights = rights;
+			rights = NULL;
+		}
+
+		if (d->tail)
+			d->tail->next = ch;
+		else
+			d->head = ch;
+		d->tail = ch;
+		written += n;
+	}
+	if (unlikely(!written))
+		return -ENOMEM;
+
+	if (!d->used)
+		uk_file_event_set(f, UKFD_POLLIN);
+	d->used += written;
+	if (d->used >= USTREAM_LIMIT)
+		uk_file_event_clear(f, UKFD_POLLOUT);
+	return written;
+}
+
+ssize_t unix_stream_recv(const struct uk_file *f,
+			 const struct iovec *iov, int iovcnt,
+			 struct unix_rights **rights)
+{
+	struct ustream_iovc c = { .iov = iov, .off = 0 };
+	struct unix_rights *got = NULL;
+	struct ustream_chunk *ch;
+	struct unix_stream *d;
+	ssize_t toread;
+	size_t done = 0;
+	size_t n;
+
+	UK_ASSERT(f->vol == USTREAM_VOLID);
+
+	toread = _iovsz(iov, iovcnt);
+	if (unlikely(toread <= 0))
+		return toread;
+
+	d = (struct unix_stream *)f->node;
+	if (!d->head) {
+		uk_file_event_clear(f, UKFD_POLLIN);
+		return (d->flags & USTREAM_HUP) ? 0 : -EAGAIN;
+	}
+
+	while ((ch = d->head) && done < (size_t)toread) {
+		if (ch->rights) {
+			/* Files mark a message boundary */
+			if (done)
+				break;
+			got = ch->rights;
+			ch->rights = NULL;
+		}
+
+		n = MIN((size_t)toread - done, ch->end - ch->start);
+		ustream_iov_out(&c, &ch->buf[ch->start], n);
+		ch->start += n;
+		done += n;
+		if (ch->start < ch->end)
+			break;
+
+		d->head = ch->next;
+		if (!d->head)
+			d->tail = NULL;
+		ustream_chunk_free(d, ch);
+	}
+	UK_ASSERT(done);
+
+	d->used -= done;
+	if (!d->used)
+		uk_file_event_clear(f, UKFD_POLLIN);
+	uk_file_event_set(f, UKFD_POLLOUT);
+
+	if (got) {
+		if (rights)
+			*rights = got;
+		else
+			unix_rights_free(got);
+	}
+	return done;
+}
+
+
+static ssize_t ustream_read(const struct uk_file *f,
+			    const struct iovec *iov, int iovcnt,
+			    off_t off, long flags __unused)
+{
+	if (unlikely(off))
+		return -ESPIPE;
+	return unix_stream_recv(f, iov, iovcnt, NULL);
+}
+
+static ssize_t ustream_write(const struct uk_file *f,
+			     const struct iovec *iov, int iovcnt,
+			     off_t off, long flags __unused)
+{
+	if (unlikely(off))
+		return -ESPIPE;
+	return unix_stream_send(f, iov, iovcnt, NULL);
+}
+
+static const struct uk_file_ops rstream_ops = {
+	.read = ustream_read,
+	.write = uk_file_nop_write,
+	.getstat = uk_file_nop_getstat,
+	.setstat = uk_file_nop_setstat,
+	.ctl = uk_file_nop_ctl
+};
+
+static const struct uk_file_ops wstream_ops = {
+	.read = uk_file_nop_read,
+	.write = ustream_write,
+	.getstat = uk_file_nop_getstat,
+	.setstat = uk_file_nop_setstat,
+	.ctl = uk_file_nop_ctl
+};
+
+static void ustream_release(const struct uk_file *f, int what)
+{
+	struct unix_stream *d;
+
+	UK_ASSERT(f->vol == USTREAM_VOLID);
+	d = (struct unix_stream *)f->node;
+	if (what & UK_FILE_RELEASE_RES) {
+		uk_or(&d->flags, USTREAM_HUP);
+		/* Update w/ EPOLL(HUP|IN) for read & EPOLLERR for write */
+		uk_file_event_set(f, EPOLLHUP|EPOLLIN|EPOLLERR);
+	}
+	if (what & UK_FILE_RELEASE_OBJ) {
+		/* Free everything once both ends are gone */
+		if (uk_or(&d->flags, USTREAM_FIN) & USTREAM_FIN) {
+			struct ustream_alloc *al = __containerof(f->state,
+								 struct ustream_alloc,
+								 fstate);
+			struct ustream_chunk *ch;
+
+			while ((ch = d->head)) {
+				d->head = ch->next;
+				ustream_chunk_free(d, ch);
+			}
+			uk_free(d->a, al);
+		}
+	}
+}
+
+
+int unix_stream_create(struct uk_alloc *a, struct uk_file *ends[2])
+{
+	struct ustream_alloc *al;
+
+	al = uk_malloc(a, sizeof(*al));
+	if (unlikely(!al))
+		return -ENOMEM;
+
+	al->node = (struct unix_stream){
+		.a = a,
+		.head = NULL,
+		.tail = NULL,
+		.used = 0,
+		.flags = 0
+	};
+	al->fstate = UK_FILE_STATE_INIT_VALUE(al->fstate);
+	al->rref = UK_FILE_REFCNT_INIT_VALUE(al->rref);
+	al->wref = UK_FILE_REFCNT_INIT_VALUE(al->wref);
+	al->rf = (struct uk_file){
+		.vol = USTREAM_VOLID,
+		.node = &al->node,
+		.refcnt = &al->rref,
+		.state = &al->fstate,
+		.ops = &rstream_ops,
+		._release = ustream_release
+	};
+	al->wf = (struct uk_file){
+		.vol = USTREAM_VOLID,
+		.node = &al->node,
+		.refcnt = &al->wref,
+		.state = &al->fstate,
+		.ops = &wstream_ops,
+		._release = ustream_release
+	};
+	uk_file_event_set(&al->wf, UKFD_POLLOUT);
+
+	ends[0] = &al->rf;
+	ends[1] = &al->wf;
+	return 0;
+}
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+/* Byte stream transport of connected SOCK_STREAM sockets */
+
+#ifndef __UK_POSIX_UNIXSOCK_STREAM_H__
+#define __UK_POSIX_UNIXSOCK_STREAM_H__
+
+#include <sys/uio.h>
+
+#include <uk/alloc.h>
+#include <uk/file.h>
+#include <uk/ofile.h>
+
+/* Open files in flight (SCM_RIGHTS); holds one reference on each */
+struct unix_rights {
+	struct uk_alloc *a;
+	unsigned int count;
+	struct uk_ofile *of[];
+};
+
+struct unix_rights *unix_rights_alloc(struct uk_alloc *a, unsigned int count);
+
+/* Releases the references held and frees `r` */
+void unix_rights_free(struct unix_rights *r);
+
+/**
+ * Creates a unidirectional stream. Like a pipe, `ends[0]` is the read end
+ * and `ends[1]` the write end, and both raise the same poll events. Unlike a
+ * pipe, buffer space is only allocated while data is queued.
+ */
+int unix_stream_create(struct uk_alloc *a, struct uk_file *ends[2]);
+
+/**
+ * Queues the data of `iov` on the stream, together with the open files of
+ * `rights`, if not NULL. On success, the stream takes over `rights`.
+ * Must be called with the file write-locked.
+ *
+ * @return Number of bytes queued, -EAGAIN if the stream is full,
+ *    -EPIPE if the read end is closed, -errno otherwise
+ */
+ssize_t unix_stream_send(const struct uk_file *f,
+			 const struct iovec *iov, int iovcnt,
+			 struct unix_rights *rights);
+
+/**
+ * Reads queued data into `iov`. Data sent with open files attached is never
+ * merged with preceding data; the files are handed over in `*rights` if
+ * `rights` is not NULL, and released otherwise.
+ * Must be called with the file write-locked.
+ *
+ * @return Number of bytes read, 0 at end of stream,
+ *    -EAGAIN if no data is queued, -errno otherwise
+ */
+ssize_t unix_stream_recv(const struct uk_file *f,
+			 const struct iovec *iov, int iovcnt,
+			 struct unix_rights **rights);
+
+#endif /* __UK_POSIX_UNIXSOCK_STREAM_H__ */
@@ -4,16 +4,19 @@
  * You may not use this file except in compliance with the License.
  */
 
+#include <fcntl.h>
 #include <string.h>
 #include <sys/un.h>
 
 #include <uk/assert.h>
 #include <uk/essentials.h>
 #include <uk/socket_driver.h>
+#include <uk/posix-fdtab.h>
 #include <uk/posix-pipe.h>
 #include <uk/file/pollqueue.h>
 
 #include "unixsock-bind.h"
+#include "unixsock-stream.h"
 
 
 struct unix_listenmsg {
@@ -66,6 +69,9 @@ struct unix_sock_data {
 #define UNIXSOCK_RDEV   0x100
 #define UNIXSOCK_WREV   0x200
 
+/* Max number of files passed in one message, same as on Linux */
+#define UNIXSOCK_SCM_MAX_FD 253
+
 
 static inline
 struct unix_sock_data *unix_sock_alloc(struct posix_socket_driver *d, int type)
@@ -83,6 +89,19 @@ struct unix_sock_data *unix_sock_alloc(struct posix_socket_driver *d, int type)
 	return data;
 }
 
+/*
+ * Creates one direction of a connection. Streams use a lean transport that
+ * only allocates buffer space for queued data; packets go through pipes.
+ */
+static inline
+int unix_sock_channel(struct posix_socket_driver *d, int type,
+		      struct uk_file *ends[2])
+{
+	if (type == SOCK_STREAM)
+		return unix_stream_create(d->allocator, ends);
+	return uk_pipefile_create(ends);
+}
+
 static inline
 void unix_sock_unnamed(struct sockaddr *restrict addr,
 		       socklen_t *restrict addr_len)
@@ -301,10 +320,10 @@ int unix_socket_socketpair(struct posix_socket_driver *d,
 		goto err_free0;
 	}
 
-	ret = uk_pipefile_create(pipes[0]);
+	ret = unix_sock_channel(d, type, pipes[0]);
 	if (unlikely(ret))
 		goto err_free;
-	ret = uk_pipefile_create(pipes[1]);
+	ret = unix_sock_channel(d, type, pipes[1]);
 	if (unlikely(ret))
 		goto err_release;
 
@@ -601,10 +620,12 @@ int unix_sock_connect_stream(posix_sock *file, posix_sock *target)
 		goto err_out;
 	}
 	/* Create pipes */
-	err = uk_pipefile_create(pipes[0]);
+	err = unix_sock_channel(posix_sock_get_driver(file), data->type,
+				pipes[0]);
 	if (unlikely(err))
 		goto err_out;
-	err = uk_pipefile_create(pipes[1]);
+	err = unix_sock_channel(posix_sock_get_driver(file), data->type,
+				pipes[1]);
 	if (unlikely(err))
 		goto err_release;
 
@@ -730,13 +751,125 @@ int unix_socket_listen(posix_sock *file, int backlog)
 	return 0;
 }
 
+/* Equivalent of CMSG_NXTHDR() without its signedness warnings */
+static inline
+struct cmsghdr *unix_sock_cmsg_next(const struct msghdr *msg,
+				    struct cmsghdr *cmsg)
+{
+	size_t off = (size_t)((char *)cmsg - (char *)msg->msg_control);
+
+	if (unlikely(cmsg->cmsg_len < sizeof(*cmsg)))
+		return NULL;
+	off += CMSG_ALIGN(cmsg->cmsg_len);
+	if (off + sizeof(*cmsg) > msg->msg_controllen)
+		return NULL;
+	return (struct cmsghdr *)((char *)msg->msg_control + off);
+}
+
+/* Takes references on the files of an SCM_RIGHTS control message */
+static
+int unix_sock_rights_get(struct uk_alloc *a, const struct msghdr *msg,
+			 struct unix_rights **out)
+{
+	struct unix_rights *r = NULL;
+	struct cmsghdr *cmsg;
+	struct uk_ofile *of;
+	const int *fds;
+	unsigned int n;
+
+	for (cmsg = CMSG_FIRSTHDR(msg);
+	     cmsg;
+	     cmsg = unix_sock_cmsg_next(msg, cmsg)) {
+		/* Other ancillary data is ignored */
+		if (cmsg->cmsg_level != SOL_SOCKET ||
+		    cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+		if (unlikely(r || cmsg->cmsg_len < CMSG_LEN(0) ||
+			     (char *)cmsg + cmsg->cmsg_len >
+			     (char *)msg->msg_control + msg->msg_controllen))
+			goto err_inval;
+
+		n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		if (unlikely(n > UNIXSOCK_SCM_MAX_FD))
+			goto err_inval;
+		if (!n)
+			continue;
+
+		r = unix_rights_alloc(a, n);
+		if (unlikely(!r))
+			return -ENOMEM;
+		fds = (const int *)CMSG_DATA(cmsg);
+		for (unsigned int i = 0; i < n; i++) {
+			of = uk_fdtab_get(fds[i]);
+			if (unlikely(!of)) {
+				unix_rights_free(r);
+				return -EBADF;
+			}
+			r->of[r->count++] = of;
+		}
+	}
+	*out = r;
+	return 0;
+
+err_inval:
+	if (r)
+		unix_rights_free(r);
+	return -EINVAL;
+}
+
+/*
+ * Installs received files as new descriptors and reports them in an
+ * SCM_RIGHTS control message. Files that do not fit are closed.
+ */
+static
+void unix_sock_rights_put(struct msghdr *msg, struct unix_rights *r,
+			  int flags)
+{
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+	unsigned int max, n = 0;
+	int *fds;
+	int fd;
+
+	if (!r) {
+		msg->msg_controllen = 0;
+		return;
+	}
+
+	if (cmsg) {
+		fds = (int *)CMSG_DATA(cmsg);
+		max = (msg->msg_controllen - CMSG_LEN(0)) / sizeof(int);
+		while (n < r->count && n < max) {
+			fd = uk_fdtab_install(r->of[n],
+					      (flags & MSG_CMSG_CLOEXEC)
+						? O_CLOEXEC : 0);
+			if (unlikely(fd < 0))
+				break;
+			fds[n++] = fd;
+		}
+	}
+	if (n) {
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(n * sizeof(int));
+		msg->msg_controllen = MIN(msg->msg_controllen,
+					  CMSG_SPACE(n * sizeof(int)));
+	} else {
+		msg->msg_controllen = 0;
+	}
+	if (n < r->count)
+		msg->msg_flags |= MSG_CTRUNC;
+	unix_rights_free(r);
+}
+
 static
 ssize_t unix_socket_recvmsg(posix_sock *file, struct msghdr *msg, int flags)
 {
 	struct unix_sock_data *data = posix_sock_get_data(file);
+	struct unix_rights *rights = NULL;
 	ssize_t ret;
 
-	if (unlikely(flags)) {
+	/* The driver never blocks, MSG_DONTWAIT is implied */
+	if (unlikely(flags & ~(MSG_DONTWAIT|MSG_CMSG_CLOEXEC))) {
 		uk_pr_warn("Unsupported recv flags: %x\n", flags);
 		return -ENOSYS;
 	}
@@ -747,9 +880,23 @@ ssize_t unix_socket_recvmsg(posix_sock *file, struct msghdr *msg, int flags)
 			return -EINVAL;
 	}
 
-	uk_file_rlock(data->rpipe);
-	ret = uk_file_read(data->rpipe, msg->msg_iov, msg->msg_iovlen, 0, 0);
-	uk_file_runlock(data->rpipe);
+	if (data->type == SOCK_STREAM) {
+		uk_file_wlock(data->rpipe);
+		ret = unix_stream_recv(data->rpipe,
+				       msg->msg_iov, msg->msg_iovlen,
+				       msg->msg_control ? &rights : NULL);
+		uk_file_wunlock(data->rpipe);
+		/* Keep the control buffer intact for a blocking retry */
+		if (msg->msg_control && ret >= 0) {
+			msg->msg_flags = 0;
+			unix_sock_rights_put(msg, rights, flags);
+		}
+	} else {
+		uk_file_rlock(data->rpipe);
+		ret = uk_file_read(data->rpipe,
+				   msg->msg_iov, msg->msg_iovlen, 0, 0);
+		uk_file_runlock(data->rpipe);
+	}
 	/* Get remote addr */
 	if (msg->msg_name) {
 		if (_SOCK_CONNECTION(data->type))
@@ -759,7 +906,7 @@ ssize_t unix_socket_recvmsg(posix_sock *file, struct msghdr *msg, int flags)
 			/* TODO: impl DGRAM remote addr */
 			unix_sock_unnamed(msg->msg_name, &msg->msg_namelen);
 	}
-	/* We ignore ancillary data & return flags for now */
+	/* Ancillary data & return flags are only supported on streams */
 	return ret;
 }
 
@@ -793,11 +940,12 @@ ssize_t unix_socket_sendmsg(posix_sock *file,
 			    const struct msghdr *msg, int flags)
 {
 	struct unix_sock_data *data = posix_sock_get_data(file);
+	struct unix_rights *rights = NULL;
 	posix_sock *remote = NULL;
 	const struct uk_file *wpipe;
 	ssize_t ret;
 
-	if (unlikely(flags & ~MSG_NOSIGNAL)) {
+	if (unlikely(flags & ~(MSG_NOSIGNAL|MSG_DONTWAIT))) {
 		uk_pr_warn("Unsupported send flags: %x\n", flags);
 		return -ENOSYS;
 	}
@@ -844,11 +992,26 @@ ssize_t unix_socket_sendmsg(posix_sock *file,
 			: (msg->msg_name
 				? -ECONNREFUSED : -ENOTCONN);
 
-	uk_file_wlock(wpipe);
-	ret = uk_file_write(wpipe, msg->msg_iov, msg->msg_iovlen, 0,
-			    data->type != SOCK_STREAM ? O_DIRECT : 0);
-	uk_file_wunlock(wpipe);
-	/* We ignore ancillary data for now */
+	if (data->type == SOCK_STREAM) {
+		ret = unix_sock_rights_get(posix_sock_get_driver(file)->allocator,
+					   msg, &rights);
+		if (unlikely(ret))
+			return ret;
+
+		uk_file_wlock(wpipe);
+		ret = unix_stream_send(wpipe, msg->msg_iov, msg->msg_iovlen,
+				       rights);
+		uk_file_wunlock(wpipe);
+		/* The stream owns the files once data was queued */
+		if (rights && ret <= 0)
+			unix_rights_free(rights);
+	} else {
+		uk_file_wlock(wpipe);
+		ret = uk_file_write(wpipe, msg->msg_iov, msg->msg_iovlen, 0,
+				    O_DIRECT);
+		uk_file_wunlock(wpipe);
+		/* We ignore ancillary data of packets for now */
+	}
 
 	/* 0-length datagrams will be silently lost; warn */
 	if (!ret && data->type != SOCK_STREAM)
@@ -128,6 +128,7 @@ static void _req_mgmt_init(struct uk_9pdev_req_mgmt *req_mgmt)
 {
 	ukarch_spin_init(&req_mgmt->spinlock);
 	uk_bitmap_zero(req_mgmt->tag_bm, UK_9P_NUMTAGS);
+	req_mgmt->next_tag = 0;
 	UK_INIT_LIST_HEAD(&req_mgmt->req_list);
 	UK_INIT_LIST_HEAD(&req_mgmt->req_free_list);
 }
@@ -135,7 +136,6 @@ static void _req_mgmt_init(struct uk_9pdev_req_mgmt *req_mgmt)
 static void _req_mgmt_add_req_locked(struct uk_9pdev_req_mgmt *req_mgmt,
 				struct uk_9preq *req)
 {
-	uk_bitmap_set(req_mgmt->tag_bm, req->tag, 1);
 	uk_list_add(&req->_list, &req_mgmt->req_list);
 }
 
@@ -157,7 +157,8 @@ _req_mgmt_from_freelist_locked(struct uk_9pdev_req_mgmt *req_mgmt)
 static void _req_mgmt_del_req_locked(struct uk_9pdev_req_mgmt *req_mgmt,
 				struct uk_9preq *req)
 {
-	uk_bitmap_clear(req_mgmt->tag_bm, req->tag, 1);
+	if (req->tag != UK_9P_NOTAG)
+		uk_clear_bit(req->tag, req_mgmt->tag_bm);
 	uk_list_del(&req->_list);
 }
 
@@ -167,9 +168,76 @@ static void _req_mgmt_req_to_freelist_locked(struct uk_9pdev_req_mgmt *req_mgmt,
 	uk_list_add(&req->_list, &req_mgmt->req_free_list);
 }
 
-static uint16_t _req_mgmt_next_tag_locked(struct uk_9pdev_req_mgmt *req_mgmt)
+/*
+ * Allocates a tag without holding the request management spinlock. The search
+ * starts after the most recently allocated tag, so that concurrent callers
+ * rarely compete for the same bit and tags are not reused right away.
+ */
+static int _req_mgmt_alloc_tag(struct uk_9pdev_req_mgmt *req_mgmt,
+			       uint16_t *tag)
+{
+	unsigned long start, t;
+	bool wrapped = false;
+
+	start = UK_READ_ONCE(req_mgmt->next_tag);
+	for (;;) {
+		t = uk_find_next_zero_bit(req_mgmt->tag_bm, UK_9P_NOTAG, start);
+		if (t >= UK_9P_NOTAG) {
+			if (wrapped)
+				return -EAGAIN;
+			wrapped = true;
+			start = 0;
+			continue;
+		}
+
+		if (!uk_test_and_set_bit(t, req_mgmt->tag_bm))
+			break;
+
+		/* Someone else got this tag first, try the next one. */
+		start = t + 1;
+	}
+
+	UK_WRITE_ONCE(req_mgmt->next_tag, (uint16_t)(t + 1));
+	*tag = (uint16_t)t;
+
+	return 0;
+}
+
+static struct uk_9preq *_req_alloc(struct uk_9pdev *dev)
 {
-	return uk_find_next_zero_bit(req_mgmt->tag_bm, UK_9P_NUMTAGS, 0);
+	struct uk_9preq *req;
+
+	req = uk_calloc(dev->a, 1, sizeof(*req));
+	if (req == NULL)
+		return NULL;
+
+	req->_dev = dev;
+	/*
+	 * Duplicate this, instead of using req->_dev, as we can't rely
+	 * on the value of _dev at time of free. Check comment in
+	 * _req_mgmt_cleanup.
+	 */
+	req->_a = dev->a;
+
+	return req;
+}
+
+static int _req_mgmt_prealloc(struct uk_9pdev *dev, unsigned int count)
+{
+	struct uk_9preq *req;
+	unsigned long flags;
+
+	while (count--) {
+		req = _req_alloc(dev);
+		if (req == NULL)
+			return -ENOMEM;
+
+		ukplat_spin_lock_irqsave(&dev->_req_mgmt.spinlock, flags);
+		_req_mgmt_req_to_freelist_locked(&dev->_req_mgmt, req);
+		ukplat_spin_unlock_irqrestore(&dev->_req_mgmt.spinlock, flags);
+	}
+
+	return 0;
 }
 
 static void _req_mgmt_cleanup(struct uk_9pdev_req_mgmt *req_mgmt __unused)
@@ -247,6 +315,14 @@ struct uk_9pdev *uk_9pdev_connect(const struct uk_9pdev_trans *trans,
 	dev->msize = dev->max_msize;
 	dev->state = UK_9PDEV_CONNECTED;
 
+	/*
+	 * Fill the request free-list so that pipelined requests do not have
+	 * to go through the allocator. This is best-effort: requests are
+	 * still allocated on demand if the pool runs dry.
+	 */
+	if (_req_mgmt_prealloc(dev, CONFIG_LIBUK9P_REQ_PREALLOC) < 0)
+		uk_pr_warn("Could not preallocate 9P requests\n");
+
 	return dev;
 
 free_dev:
@@ -330,22 +406,23 @@ struct uk_9preq *uk_9pdev_req_create(struct uk_9pdev *dev, uint8_t type)
 
 	UK_ASSERT(dev);
 
+	if (type == UK_9P_TVERSION) {
+		tag = UK_9P_NOTAG;
+	} else {
+		rc = _req_mgmt_alloc_tag(&dev->_req_mgmt, &tag);
+		if (rc < 0)
+			goto out;
+	}
+
 	ukplat_spin_lock_irqsave(&dev->_req_mgmt.spinlock, flags);
 	if (!(req = _req_mgmt_from_freelist_locked(&dev->_req_mgmt))) {
 		/* Don't allocate with the spinlock held. */
 		ukplat_spin_unlock_irqrestore(&dev->_req_mgmt.spinlock, flags);
-		req = uk_calloc(dev->a, 1, sizeof(*req));
+		req = _req_alloc(dev);
 		if (req == NULL) {
 			rc = -ENOMEM;
-			goto out;
+			goto out_free_tag;
 		}
-		req->_dev = dev;
-		/*
-		 * Duplicate this, instead of using req->_dev, as we can't rely
-		 * on the value of _dev at time of free. Check comment in
-		 * _req_mgmt_cleanup.
-		 */
-		req->_a = dev->a;
 		ukplat_spin_lock_irqsave(&dev->_req_mgmt.spinlock, flags);
 	}
 
@@ -361,11 +438,6 @@ struct uk_9preq *uk_9pdev_req_create(struct uk_9pdev *dev, uint8_t type)
 	req->recv.size = MIN(req->recv.size, dev->msize);
 	req->xmit.size = MIN(req->xmit.size, dev->msize);
 
-	if (type == UK_9P_TVERSION)
-		tag = UK_9P_NOTAG;
-	else
-		tag = _req_mgmt_next_tag_locked(&dev->_req_mgmt);
-
 	req->tag = tag;
 	req->xmit.type = type;
 
@@ -376,6 +448,9 @@ struct uk_9preq *uk_9pdev_req_create(struct uk_9pdev *dev, uint8_t type)
 
 	return req;
 
+out_free_tag:
+	if (tag != UK_9P_NOTAG)
+		uk_clear_bit(tag, dev->_req_mgmt.tag_bm);
 out:
 	return ERR2PTR(rc);
 }
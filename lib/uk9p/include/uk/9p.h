@@ -264,6 +264,90 @@ int64_t uk_9p_read(struct uk_9pdev *dev, struct uk_9pfid *fid,
 int64_t uk_9p_write(struct uk_9pdev *dev, struct uk_9pfid *fid,
 		uint64_t offset, uint32_t count, const char *buf);
 
+/**
+ * Returns the maximum number of bytes that a single Tread request on the given
+ * fid can transfer, given the negotiated msize and the fid's iounit.
+ *
+ * @param dev
+ *   The Unikraft 9P Device.
+ * @param fid
+ *   9P fid to read from.
+ * @return
+ *   Maximum count of a Tread request.
+ */
+uint32_t uk_9p_read_maxcount(struct uk_9pdev *dev, struct uk_9pfid *fid);
+
+/**
+ * Returns the maximum number of bytes that a single Twrite request on the
+ * given fid can transfer, given the negotiated msize and the fid's iounit.
+ *
+ * @param dev
+ *   The Unikraft 9P Device.
+ * @param fid
+ *   9P fid to write to.
+ * @return
+ *   Maximum count of a Twrite request.
+ */
+uint32_t uk_9p_write_maxcount(struct uk_9pdev *dev, struct uk_9pfid *fid);
+
+/**
+ * Sends a Tread request without waiting for the reply. This allows several
+ * reads to be in flight at the same time. The reply must be collected with
+ * uk_9p_rw_wait(), which also releases the request.
+ *
+ * @param dev
+ *   The Unikraft 9P Device.
+ * @param fid
+ *   9P fid to read from.
+ * @param offset
+ *   Offset at which to start reading.
+ * @param count
+ *   Number of bytes to read; at most uk_9p_read_maxcount().
+ * @param buf
+ *   Buffer to read into. Must stay valid until uk_9p_rw_wait() returns.
+ * @return
+ *   - (!ERRPTR): The request in flight.
+ *   - ERRPTR: The error returned by the API.
+ */
+struct uk_9preq *uk_9p_read_submit(struct uk_9pdev *dev, struct uk_9pfid *fid,
+		uint64_t offset, uint32_t count, char *buf);
+
+/**
+ * Sends a Twrite request without waiting for the reply. This allows several
+ * writes to be in flight at the same time. The reply must be collected with
+ * uk_9p_rw_wait(), which also releases the request.
+ *
+ * @param dev
+ *   The Unikraft 9P Device.
+ * @param fid
+ *   9P fid to write to.
+ * @param offset
+ *   Offset at which to start writing.
+ * @param count
+ *   Number of bytes to write; at most uk_9p_write_maxcount().
+ * @param buf
+ *   Data to be written. Must stay valid until uk_9p_rw_wait() returns.
+ * @return
+ *   - (!ERRPTR): The request in flight.
+ *   - ERRPTR: The error returned by the API.
+ */
+struct uk_9preq *uk_9p_write_submit(struct uk_9pdev *dev, struct uk_9pfid *fid,
+		uint64_t offset, uint32_t count, const char *buf);
+
+/**
+ * Waits for the reply of a request sent with uk_9p_read_submit() or
+ * uk_9p_write_submit() and removes the request.
+ *
+ * @param dev
+ *   The Unikraft 9P Device.
+ * @param req
+ *   The request in flight.
+ * @return
+ *   - (>= 0): Amount of bytes read or written.
+ *   - (< 0): An error occurred.
+ */
+int64_t uk_9p_rw_wait(struct uk_9pdev *dev, struct uk_9preq *req);
+
 /**
  * Stats the given fid and places the data into the given stat structure.
  *
@@ -114,7 +114,8 @@ void uk_9pdev_xmit_notify(struct uk_9pdev *dev);
  * @return
  *   If not an error pointer, the created request.
  *   Otherwise, the error in creating the request:
- *   - ENOMEM: No memory for the request or no available tags.
+ *   - ENOMEM: No memory for the request.
+ *   - EAGAIN: All tags are currently in use.
  */
 struct uk_9preq *uk_9pdev_req_create(struct uk_9pdev *dev, uint8_t type);
 
@@ -164,7 +165,8 @@ void uk_9pdev_req_to_freelist(struct uk_9pdev *dev, struct uk_9preq *req);
  * @return
  *   If not an error pointer, the created fid.
  *   Otherwise, the error in creating the fid:
- *   - ENOMEM: No memory for the request or no available tags.
+ *   - ENOMEM: No memory for the request.
+ *   - EAGAIN: All tags are currently in use.
  */
 struct uk_9pfid *uk_9pdev_fid_create(struct uk_9pdev *dev);
 
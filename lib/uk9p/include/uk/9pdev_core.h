@@ -112,10 +112,15 @@ struct uk_9pdev_trans_ops {
  * A structure used for 9p requests' management.
  */
 struct uk_9pdev_req_mgmt {
-	/* Spinlock protecting this data. */
+	/* Spinlock protecting the request lists. */
 	__spinlock                      spinlock;
-	/* Bitmap of available tags. */
+	/*
+	 * Bitmap of available tags. Tags are allocated and released with
+	 * atomic bit operations, without holding the spinlock.
+	 */
 	unsigned long                   tag_bm[UK_BITS_TO_LONGS(UK_9P_NUMTAGS)];
+	/* Hint where to start looking for the next free tag. */
+	uint16_t                        next_tag;
 	/* List of requests allocated and not yet removed. */
 	struct uk_list_head             req_list;
 	/* Free-list of requests. */
@@ -122,6 +122,86 @@ static void main_thread_dtor(struct uk_thread *m);
 static struct uk_vas kernel_vas;
 #endif /* CONFIG_LIBUKBOOT_HEAP_BASE && CONFIG_LIBUKVMEM */
 
+#if CONFIG_LIBUKBOOT_BOOTTIME
+static inline void boottime_stamp(const char *phase)
+{
+	__nsec now = ukplat_monotonic_clock();
+
+	uk_pr_info("Boot phase %-8s done at %"__PRInsec".%03"__PRInsec" ms\n",
+		   phase, ukarch_time_nsec_to_msec(now),
+		   ukarch_time_nsec_to_usec(now) % 1000);
+}
+#else /* CONFIG_LIBUKBOOT_BOOTTIME */
+static inline void boottime_stamp(const char *phase __unused) {}
+#endif /* !CONFIG_LIBUKBOOT_BOOTTIME */
+
+#if CONFIG_LIBUKBOOT_HEAP_BACKGROUND
+#define HEAP_BOOT_PAGES							\
+	((__sz)CONFIG_LIBUKBOOT_HEAP_BACKGROUND_INITIAL << (20 - PAGE_SHIFT))
+#define HEAP_CHUNK_PAGES		((__sz)1 << (30 - PAGE_SHIFT))
+#define HEAP_CHUNK_MIN_PAGES		16
+
+/* End of the mapped part of the heap */
+static __vaddr_t heap_end;
+
+/* Maps the free memory that is left after heap_init() behind the heap and
+ * adds it to the allocator. We map chunks of at most HEAP_CHUNK_PAGES and
+ * yield after each one so that the rest of the system can make progress.
+ * Each chunk becomes a separate region of the allocator. We recompute the
+ * amount of free memory for every chunk because others may allocate frames
+ * in the meantime.
+ */
+static __noreturn void heap_populate(void *arg)
+{
+	struct uk_alloc *a = (struct uk_alloc *)arg;
+	struct uk_pagetable *pt = ukplat_pt_get_active();
+	__nsec start = ukplat_monotonic_clock();
+	__sz free_pages, pages, total = 0;
+	int rc;
+
+	UK_ASSERT(pt);
+
+	for (;;) {
+		free_pages = pt->fa->free_memory >> PAGE_SHIFT;
+		if (free_pages <= PT_PAGES(free_pages))
+			break;
+
+		pages = MIN(free_pages - PT_PAGES(free_pages),
+			    HEAP_CHUNK_PAGES);
+		if (pages < HEAP_CHUNK_MIN_PAGES)
+			break;
+
+		rc = ukplat_page_map(pt, heap_end, __PADDR_ANY, pages,
+				     PAGE_ATTR_PROT_RW, 0);
+		if (unlikely(rc)) {
+			uk_pr_warn("Failed to map heap at %p: %d\n",
+				   (void *)heap_end, rc);
+			break;
+		}
+
+		rc = uk_alloc_addmem(a, (void *)heap_end, pages << PAGE_SHIFT);
+		if (unlikely(rc)) {
+			uk_pr_warn("Failed to add heap at %p: %d\n",
+				   (void *)heap_end, rc);
+			ukplat_page_unmap(pt, heap_end, pages, 0);
+			break;
+		}
+
+		heap_end += pages << PAGE_SHIFT;
+		total += pages;
+
+		uk_sched_yield();
+	}
+
+	uk_pr_info("Populated %"__PRIsz" MiB of heap in %"__PRInsec" ms\n",
+		   total >> (20 - PAGE_SHIFT),
+		   ukarch_time_nsec_to_msec(ukplat_monotonic_clock() - start));
+	boottime_stamp("heap");
+
+	uk_sched_thread_exit();
+}
+#endif /* CONFIG_LIBUKBOOT_HEAP_BACKGROUND */
+
 static struct uk_alloc *heap_init()
 {
 	struct uk_alloc *a = NULL;
@@ -195,6 +275,13 @@ static struct uk_alloc *heap_init()
 #else /* CONFIG_LIBUKVMEM */
 	free_pages  = pt->fa->free_memory >> PAGE_SHIFT;
 	alloc_pages = free_pages - PT_PAGES(free_pages);
+#if CONFIG_LIBUKBOOT_HEAP_BACKGROUND
+	/* Only map the initial part of the heap. The remainder is mapped by
+	 * heap_populate() as soon as the scheduler is up.
+	 */
+	alloc_pages = MIN(alloc_pages, HEAP_BOOT_PAGES);
+	heap_end = heap_base + (alloc_pages << PAGE_SHIFT);
+#endif /* CONFIG_LIBUKBOOT_HEAP_BACKGROUND */
 
 	rc = ukplat_page_map(pt, heap_base, __PADDR_ANY,
 			     alloc_pages, PAGE_ATTR_PROT_RW, 0);
@@ -350,6 +437,7 @@ void uk_boot_entry(void)
 	/* On most platforms the timer depend on an initialized IRQ subsystem */
 	uk_pr_info("Initialize platform time...\n");
 	ukplat_time_init();
+	boottime_stamp("time");
 
 #if CONFIG_LIBUKBOOT_INITSCHED
 	uk_pr_info("Initialize scheduling...\n");
@@ -359,6 +447,13 @@ void uk_boot_entry(void)
 	if (unlikely(!s))
 		UK_CRASH("Failed to initialize scheduling\n");
 	uk_sched_start(s);
+	boottime_stamp("sched");
+
+#if CONFIG_LIBUKBOOT_HEAP_BACKGROUND
+	if (unlikely(!uk_sched_thread_create(s, heap_populate, a,
+					     "heap-populate")))
+		UK_CRASH("Failed to launch heap population\n");
+#endif /* CONFIG_LIBUKBOOT_HEAP_BACKGROUND */
 #endif /* CONFIG_LIBUKBOOT_INITSCHED */
 
 	ictx.cmdline.argc = boot_argc;
@@ -388,6 +483,8 @@ void uk_boot_entry(void)
 		}
 	}
 
+	boottime_stamp("inittab");
+
 #ifdef CONFIG_LIBUKSP
 	uk_stack_chk_guard_setup();
 #endif
@@ -499,6 +596,7 @@ static inline int do_main(int argc, char *argv[])
 	uk_pr_info("])\n");
 #endif /* CONFIG_LIBUKDEBUG_PRINTK_INFO */
 
+	boottime_stamp("main");
 	ret = main(argc, argv);
 	uk_pr_info("main returned %d\n", ret);
 	return ret;
@@ -130,6 +130,29 @@ struct uk_falloc {
 	int (*addmem)(struct uk_falloc *fa, void *metadata, __paddr_t paddr,
 		      unsigned long frames, __vaddr_t dm_off);
 
+	/**
+	 * Allocates a single zero-filled frame from a pool of pre-zeroed
+	 * frames. Can be __NULL if the allocator does not maintain such pool
+	 *
+	 * @param fa the instance of the frame allocator
+	 * @param [out] paddr the physical address of the allocated frame. Not
+	 *    touched on error
+	 *
+	 * @return 0 on success, -ENOMEM if no pre-zeroed frame is available
+	 */
+	int (*falloc_zeroed)(struct uk_falloc *fa, __paddr_t *paddr);
+
+	/**
+	 * Zeroes free frames to refill the pool of pre-zeroed frames. Meant to
+	 * be called when the system is idle. Can be __NULL
+	 *
+	 * @param fa the instance of the frame allocator
+	 * @param budget the maximum number of frames to zero
+	 *
+	 * @return the number of frames that have been added to the pool
+	 */
+	unsigned long (*fzero)(struct uk_falloc *fa, unsigned long budget);
+
 	/** The amount of free memory managed by the allocator in bytes */
 	__sz free_memory;
 
@@ -167,6 +190,8 @@ static inline int _uk_falloc_init_stats(struct uk_falloc *fa __unused)
 		(_fa)->falloc_from_range = (_falloc_from_range_f);	\
 		(_fa)->ffree  = (_ffree_f);				\
 		(_fa)->addmem = (_addmem_f);				\
+		(_fa)->falloc_zeroed = __NULL;				\
+		(_fa)->fzero = __NULL;					\
 		(_fa)->free_memory = 0;					\
 		(_fa)->total_memory = 0;				\
 		_rc = _uk_falloc_init_stats(_fa);			\
@@ -54,6 +54,11 @@
 #define BFA_DIRECT_MAPPED		CONFIG_PAGING_HAVE_DIRECTMAP
 #endif /* !CONFIG_LIBUKFALLOCBUDDY_DEBUG */
 
+/* The pool of pre-zeroed frames needs direct access to the frames */
+#if defined(CONFIG_LIBUKFALLOCBUDDY_ZEROPOOL) && defined(BFA_DIRECT_MAPPED)
+#define BFA_ZEROPOOL			1
+#endif /* CONFIG_LIBUKFALLOCBUDDY_ZEROPOOL && BFA_DIRECT_MAPPED */
+
 #define BFA_MAX_ALLOC_SHIFT		CONFIG_LIBUKFALLOCBUDDY_MAX_ALLOC_ORDER
 #if BFA_MAX_ALLOC_SHIFT < PAGE_SHIFT
 #error The max allocation size must be greater than or equal to the frame size
@@ -166,6 +171,14 @@ struct buddy_framealloc {
 
 	struct uk_list_head free_list[BFA_LEVELS];
 	unsigned int free_list_map;
+
+#ifdef BFA_ZEROPOOL
+	/* Pool of pre-zeroed frames. The frames are allocated in the zone
+	 * bitmaps and do not count as free memory.
+	 */
+	struct uk_list_head zpool;
+	unsigned long zpool_count;
+#endif /* BFA_ZEROPOOL */
 };
 
 /* Forward declarations */
@@ -1200,11 +1213,134 @@ static int bfa_do_alloc_any(struct buddy_framealloc *bfa, __paddr_t *paddr,
 	return 0;
 }
 
+#ifdef BFA_ZEROPOOL
+/* Pre-zeroed frames are linked through the first bytes of the frame, which
+ * have to be cleared again when the frame is taken from the pool.
+ */
+struct bfa_zframe {
+	struct uk_list_head link;
+	struct bfa_zone *zone;
+};
+
+static inline void bfa_zero_frame(void *frame)
+{
+	unsigned long *p = (unsigned long *)frame;
+	unsigned long *end = p + (PAGE_SIZE / sizeof(unsigned long));
+
+	/* Use non-temporal stores so that zeroing does not evict the working
+	 * set of the application from the caches.
+	 */
+#if defined(__x86_64__)
+	for (; p < end; p += 4)
+		__asm__ __volatile__("movnti %1, 0(%0)\n"
+				     "movnti %1, 8(%0)\n"
+				     "movnti %1, 16(%0)\n"
+				     "movnti %1, 24(%0)\n"
+				     : : "r"(p), "r"(0UL) : "memory");
+
+	__asm__ __volatile__("sfence" : : : "memory");
+#elif defined(__aarch64__)
+	for (; p < end; p += 4)
+		__asm__ __volatile__("stnp xzr, xzr, [%0]\n"
+				     "stnp xzr, xzr, [%0, #16]\n"
+				     : : "r"(p) : "memory");
+
+	__asm__ __volatile__("dmb ishst" : : : "memory");
+#else
+	memset(p, 0, PAGE_SIZE);
+#endif
+}
+
+static int bfa_falloc_zeroed(struct uk_falloc *fa, __paddr_t *paddr)
+{
+	struct buddy_framealloc *bfa = (struct buddy_framealloc *)fa;
+	struct bfa_zframe *zf;
+
+	if (uk_list_empty(&bfa->zpool))
+		return -ENOMEM;
+
+	zf = uk_list_first_entry(&bfa->zpool, struct bfa_zframe, link);
+	uk_list_del(&zf->link);
+	bfa->zpool_count--;
+
+	*paddr = bfa_mb_to_paddr(zf->zone, (struct bfa_memblock *)zf);
+	memset(zf, 0, sizeof(*zf));
+
+	return 0;
+}
+
+static unsigned long bfa_fzero(struct uk_falloc *fa, unsigned long budget)
+{
+	struct buddy_framealloc *bfa = (struct buddy_framealloc *)fa;
+	struct bfa_zframe *zf;
+	struct bfa_zone *zone;
+	unsigned long count = 0;
+	__paddr_t paddr;
+
+	while (count < budget &&
+	       bfa->zpool_count < CONFIG_LIBUKFALLOCBUDDY_ZEROPOOL_FRAMES) {
+		if (bfa_do_alloc_any(bfa, &paddr, PAGE_SIZE))
+			break;
+
+		zone = bfa_paddr_to_zone(bfa, paddr);
+		UK_ASSERT(zone);
+
+		zf = (struct bfa_zframe *)bfa_paddr_to_mb(zone, paddr);
+		bfa_zero_frame(zf);
+
+		zf->zone = zone;
+		uk_list_add(&zf->link, &bfa->zpool);
+		bfa->zpool_count++;
+		count++;
+	}
+
+	return count;
+}
+
+/* Returns all pre-zeroed frames to the buddy system so that they can be used
+ * for allocations that cannot be satisfied otherwise
+ */
+static int bfa_zpool_drain(struct buddy_framealloc *bfa)
+{
+	struct bfa_zframe *zf, *tmp;
+	int rc;
+
+	if (uk_list_empty(&bfa->zpool))
+		return 0;
+
+	uk_list_for_each_entry_safe(zf, tmp, &bfa->zpool, link) {
+		uk_list_del(&zf->link);
+		bfa->zpool_count--;
+
+		rc = bfa_do_free(bfa, bfa_mb_to_paddr(zf->zone,
+					(struct bfa_memblock *)zf), PAGE_SIZE);
+		UK_ASSERT(rc == 0);
+	}
+
+	UK_ASSERT(bfa->zpool_count == 0);
+
+	return 1;
+}
+#endif /* BFA_ZEROPOOL */
+
+static int bfa_do_alloc_flat(struct buddy_framealloc *bfa, __paddr_t *paddr,
+			     __sz len)
+{
+	/* If a physical address is given, the caller wants to allocate this
+	 * exact memory range. Otherwise, just take a free one from the list.
+	 */
+	if (*paddr == __PADDR_ANY)
+		return bfa_do_alloc_any(bfa, paddr, len);
+	else
+		return bfa_do_alloc(bfa, *paddr, len);
+}
+
 static int bfa_alloc(struct uk_falloc *fa, __paddr_t *paddr,
 		     unsigned long frames, unsigned long flags __unused)
 {
 	struct buddy_framealloc *bfa = (struct buddy_framealloc *)fa;
 	__sz len;
+	int rc;
 
 	UK_ASSERT(frames > 0);
 	UK_ASSERT(frames <= (__SZ_MAX / PAGE_SIZE));
@@ -1214,13 +1350,14 @@ static int bfa_alloc(struct uk_falloc *fa, __paddr_t *paddr,
 	/* There is only FALLOC_FLAG_ALIGNED which we implicitly fulfill */
 	UK_ASSERT((flags == 0) || (flags == FALLOC_FLAG_ALIGNED));
 
-	/* If a physical address is given, the caller wants to allocate this
-	 * exact memory range. Otherwise, just take a free one from the list.
-	 */
-	if (*paddr == __PADDR_ANY)
-		return bfa_do_alloc_any(bfa, paddr, len);
-	else
-		return bfa_do_alloc(bfa, *paddr, len);
+	rc = bfa_do_alloc_flat(bfa, paddr, len);
+#ifdef BFA_ZEROPOOL
+	/* The memory might be held by the pool of pre-zeroed frames */
+	if (unlikely(rc == -ENOMEM) && bfa_zpool_drain(bfa))
+		rc = bfa_do_alloc_flat(bfa, paddr, len);
+#endif /* BFA_ZEROPOOL */
+
+	return rc;
 }
 
 static int bfa_do_alloc_any_in_range(struct buddy_framealloc *bfa,
@@ -1282,6 +1419,7 @@ static int bfa_alloc_from_range(struct uk_falloc *fa, __paddr_t *paddr,
 {
 	struct buddy_framealloc *bfa = (struct buddy_framealloc *)fa;
 	__sz len;
+	int rc;
 
 	UK_ASSERT(frames > 0);
 	UK_ASSERT(frames <= (__SZ_MAX / PAGE_SIZE));
@@ -1293,7 +1431,14 @@ static int bfa_alloc_from_range(struct uk_falloc *fa, __paddr_t *paddr,
 
 	UK_ASSERT(min <= max);
 
-	return bfa_do_alloc_any_in_range(bfa, paddr, len, min, max);
+	rc = bfa_do_alloc_any_in_range(bfa, paddr, len, min, max);
+#ifdef BFA_ZEROPOOL
+	/* The memory might be held by the pool of pre-zeroed frames */
+	if (unlikely(rc == -ENOMEM) && bfa_zpool_drain(bfa))
+		rc = bfa_do_alloc_any_in_range(bfa, paddr, len, min, max);
+#endif /* BFA_ZEROPOOL */
+
+	return rc;
 }
 
 static struct bfa_memblock *bfa_try_merge(struct buddy_framealloc *bfa,
@@ -1497,6 +1642,14 @@ int uk_fallocbuddy_init(struct uk_falloc *fa)
 
 	bfa->zones = __NULL;
 
+#ifdef BFA_ZEROPOOL
+	UK_INIT_LIST_HEAD(&bfa->zpool);
+	bfa->zpool_count = 0;
+
+	fa->falloc_zeroed = bfa_falloc_zeroed;
+	fa->fzero = bfa_fzero;
+#endif /* BFA_ZEROPOOL */
+
 	return rc;
 }
 
@@ -270,8 +270,12 @@ uk_pollevent _pollq_lock(struct uk_pollq *q, uk_pollevent req,
 	uk_pollevent ev;
 
 	uk_rwlock_rlock(&q->waitlock);
+	/* Mark request in waitmask before checking, as updates only take the
+	 * lock and notify if they see the request there.
+	 */
+	(void)uk_or(&q->waitmask, req);
 	/* Check if events were set while acquiring the lock */
-	if ((ev = uk_pollq_poll_immediate(q, req) & ~exp))
+	if ((ev = uk_load_n(&q->events) & req & ~exp))
 		uk_rwlock_runlock(&q->waitlock);
 	return ev;
 }
@@ -297,8 +301,6 @@ int _pollq_wait(struct uk_pollq *q, uk_pollevent req, __nsec deadline)
 	struct uk_poll_ticket tick;
 	int timeout;
 
-	/* Mark request in waitmask */
-	(void)uk_or(&q->waitmask, req);
 	/* Compete to register */
 
 	__current = uk_thread_current();
@@ -484,9 +486,10 @@ uk_pollevent uk_pollq_poll_register(struct uk_pollq *q,
 
 	if (!force && (ev = uk_pollq_poll_immediate(q, req)))
 		return ev;
-	/* Might need to register */
+	/* Might need to register; mark propmask first, as in _pollq_lock */
 	uk_rwlock_rlock(&q->proplock);
-	if ((ev = uk_pollq_poll_immediate(q, req)) && !force)
+	(void)uk_or(&q->propmask, req);
+	if ((ev = uk_load_n(&q->events) & req) && !force)
 		goto out;
 	_pollq_register(q, tick);
 out:
@@ -515,7 +518,8 @@ uk_pollevent uk_pollq_edge_poll_register(struct uk_pollq *q,
 	uk_pollevent level = uk_pollq_poll_immediate(q, req);
 
 	uk_rwlock_rlock(&q->proplock);
-	if ((ev = uk_pollq_poll_immediate(q, req) & ~level) && !force)
+	(void)uk_or(&q->propmask, req);
+	if ((ev = uk_load_n(&q->events) & req & ~level) && !force)
 		goto out;
 	_pollq_register(q, tick);
 out:
@@ -539,6 +543,8 @@ uk_pollevent uk_pollq_clear(struct uk_pollq *q, uk_pollevent clr);
 
 /**
  * Update events, setting those in `set` and handling notifications.
+ * The wait and chain lists are only walked if anything is registered for
+ * `set`, so repeatedly setting events nobody waits for is cheap.
  *
  * @param q Target queue.
  * @param set Events to set.
@@ -589,4 +595,23 @@ uk_pollevent uk_pollq_assign_n(struct uk_pollq *q, uk_pollevent val, int n);
  */
 #define uk_pollq_assign(q, s) uk_pollq_assign_n(q, s, UK_POLLQ_NOTIFY_ALL)
 
+#if CONFIG_LIBUKFILE_POLLQ_STATS
+/* Statistics */
+
+/* Counters of event updates, summed over all queues */
+struct uk_pollq_stats {
+	unsigned long notified; /* Wait list walked */
+	unsigned long notify_skipped; /* No thread waiting for the events */
+	unsigned long propagated; /* Chain list walked */
+	unsigned long propagate_skipped; /* No chain registered for the events */
+};
+
+/**
+ * Get a snapshot of the poll queue update counters.
+ *
+ * @param dst Where to store the counters.
+ */
+void uk_pollq_get_stats(struct uk_pollq_stats *dst);
+#endif /* CONFIG_LIBUKFILE_POLLQ_STATS */
+
 #endif /* __UKFILE_POLLQUEUE_H__ */
@@ -8,8 +8,35 @@
 
 #include <uk/assert.h>
 
+#if CONFIG_LIBUKFILE_POLLQ_STATS
+static struct uk_pollq_stats pollq_stats;
+
+#define POLLQ_STAT_INC(c) ((void)uk_inc(&pollq_stats.c))
+
+void uk_pollq_get_stats(struct uk_pollq_stats *dst)
+{
+	UK_ASSERT(dst);
+
+	dst->notified = uk_load_n(&pollq_stats.notified);
+	dst->notify_skipped = uk_load_n(&pollq_stats.notify_skipped);
+	dst->propagated = uk_load_n(&pollq_stats.propagated);
+	dst->propagate_skipped = uk_load_n(&pollq_stats.propagate_skipped);
+}
+#else /* !CONFIG_LIBUKFILE_POLLQ_STATS */
+#define POLLQ_STAT_INC(c) do {} while (0)
+#endif /* !CONFIG_LIBUKFILE_POLLQ_STATS */
+
 static void pollq_notify_n(struct uk_pollq *q, uk_pollevent set, int n)
 {
+	/* Waiters mark waitmask before checking events (see _pollq_lock), so
+	 * if nobody waits for `set` now, any later waiter will see the events.
+	 */
+	if (!(uk_load_n(&q->waitmask) & set)) {
+		POLLQ_STAT_INC(notify_skipped);
+		return;
+	}
+	POLLQ_STAT_INC(notified);
+
 	uk_rwlock_wlock(&q->waitlock);
 	if (q->waitmask & set) {
 		/* Walk wait list, wake up & collect */
@@ -45,6 +72,13 @@ done:
 static void pollq_propagate(struct uk_pollq *q,
 			    enum uk_poll_chain_op op, uk_pollevent set)
 {
+	/* Same as for waiters, see uk_pollq_poll_register */
+	if (!(uk_load_n(&q->propmask) & set)) {
+		POLLQ_STAT_INC(propagate_skipped);
+		return;
+	}
+	POLLQ_STAT_INC(propagated);
+
 	uk_rwlock_wlock(&q->proplock);
 	if (q->propmask & set) {
 		uk_pollevent seen;
@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#ifndef __UKARCH_TICKETLOCK_H__
+#define __UKARCH_TICKETLOCK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <uk/arch/lcpu.h>
+
+#ifdef CONFIG_HAVE_SMP
+#include <uk/atomic.h>
+
+/* Unless you know what you are doing, use struct uk_spinlock instead. */
+typedef struct __ticketlock __ticketlock;
+
+struct __align(8) __ticketlock {
+	union {
+		__u32 val;
+		struct {
+			__u16 current; /* currently served */
+			__u16 next;    /* next available ticket */
+		};
+	};
+};
+
+/* Initialize a ticketlock to unlocked state */
+#define UKARCH_TICKETLOCK_INITIALIZER() { { 0 } }
+
+static inline void ukarch_ticket_init(struct __ticketlock *lock)
+{
+	lock->val = 0;
+}
+
+static inline void ukarch_ticket_lock(struct __ticketlock *lock)
+{
+	__u32 r = 0x10000;
+
+	/* Draw a ticket and read the currently served one in a single step */
+	__asm__ __volatile__(
+		"	lock; xaddl	%0, %1\n"
+		: "+r" (r), "+m" (lock->val)
+		:
+		: "memory");
+
+	while ((__u16)(r >> 16) != (__u16)r) {
+		ukarch_spinwait();
+		r = (r & 0xffff0000) | UK_READ_ONCE(lock->current);
+	}
+	barrier();
+}
+
+static inline void ukarch_ticket_unlock(struct __ticketlock *lock)
+{
+	/* Only the owner modifies `current` and x86 does not reorder stores
+	 * with earlier loads or stores, so a plain store releases the lock.
+	 */
+	barrier();
+	UK_WRITE_ONCE(lock->current, (__u16)(lock->current + 1));
+}
+
+static inline int ukarch_ticket_trylock(struct __ticketlock *lock)
+{
+	__u32 old = UK_READ_ONCE(lock->val);
+
+	if ((old & 0xffff) != (old >> 16))
+		return 0;
+	return uk_compare_exchange_n(&lock->val, &old, old + 0x10000);
+}
+
+static inline int ukarch_ticket_is_locked(struct __ticketlock *lock)
+{
+	__u32 val = UK_READ_ONCE(lock->val);
+
+	return (val & 0xffff) != (val >> 16);
+}
+
+#else /* CONFIG_HAVE_SMP */
+
+typedef struct __ticketlock {
+	/* empty */
+} __ticketlock;
+
+#define UKARCH_TICKETLOCK_INITIALIZER()	{}
+#define ukarch_ticket_init(lock)		(void)(lock)
+#define ukarch_ticket_lock(lock)		\
+	do { barrier(); (void)(lock); } while (0)
+#define ukarch_ticket_unlock(lock)	\
+	do { barrier(); (void)(lock); } while (0)
+#define ukarch_ticket_trylock(lock)	({ barrier(); (void)(lock); 1; })
+#define ukarch_ticket_is_locked(lock)	({ barrier(); (void)(lock); 0; })
+
+#endif /* CONFIG_HAVE_SMP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UKARCH_TICKETLOCK_H__ */
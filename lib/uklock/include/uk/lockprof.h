@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#ifndef __UK_LOCKPROF_H__
+#define __UK_LOCKPROF_H__
+
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/arch/time.h>
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+#include <uk/plat/time.h>
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct uk_thread;
+
+/* ukstore entry IDs */
+#define UK_LOCKPROF_STORE_REPORT	0x01
+#define UK_LOCKPROF_STORE_RESET		0x02
+
+/*
+ * Wait time histogram: bucket 0 counts waits below 1us, bucket i waits of
+ * [2^(i-1), 2^i) us, and the last bucket everything above.
+ */
+#define UK_LOCKPROF_HIST_BUCKETS	20
+
+/*
+ * Profile of a lock site, i.e., a call site that acquires a mutex, rwlock or
+ * semaphore in a blocking way. Sites are collected in the .uk_lockprof_site
+ * section.
+ */
+struct uk_lockprof_site {
+	const char *file;
+	unsigned int line;
+	/** Lock operation: "mutex", "rwlock-r", "rwlock-w" or "semaphore" */
+	const char *op;
+
+	/** Successful acquisitions */
+	__u64 acquisitions;
+	/** Acquisitions that had to wait */
+	__u64 contended;
+	/** Time spent waiting (ns) */
+	__u64 wait_total;
+	__u64 wait_max;
+	__u64 wait_hist[UK_LOCKPROF_HIST_BUCKETS];
+	/** Time the lock was held after acquiring it here (ns) */
+	__u64 hold_total;
+	__u64 hold_max;
+	/** Owner of the lock when a thread blocked here the last time.
+	 * Only an identifier, the thread may be gone already.
+	 */
+	const struct uk_thread *last_owner;
+};
+
+/* Holder bookkeeping that is embedded into exclusive locks */
+struct uk_lockprof_hold {
+	struct uk_lockprof_site *site;
+	__nsec since;
+};
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+
+#define UK_LOCKPROF_HOLD_INITIALIZER()	{ NULL, 0 }
+
+extern struct uk_lockprof_site uk_lockprof_site_list_start[];
+extern struct uk_lockprof_site uk_lockprof_site_list_end[];
+
+#define uk_lockprof_site_foreach(itr)					\
+	for ((itr) = uk_lockprof_site_list_start;			\
+	     (itr) < uk_lockprof_site_list_end;				\
+	     (itr)++)
+
+/* Evaluates to the profile of the current call site */
+#define UK_LOCKPROF_SITE(opname)					\
+	({								\
+		static struct uk_lockprof_site __uk_lockprof_site	\
+			__section(".uk_lockprof_site") __used		\
+			__align(8) = {					\
+				.file = __FILE__,			\
+				.line = __LINE__,			\
+				.op = opname				\
+			};						\
+		&__uk_lockprof_site;					\
+	})
+
+/**
+ * @internal
+ * Notes that a thread is about to block at a lock site.
+ * @return start of the wait, to be passed to _uk_lockprof_acquired()
+ */
+static inline __nsec _uk_lockprof_contended(struct uk_lockprof_site *site,
+					     const struct uk_thread *owner)
+{
+	__atomic_fetch_add(&site->contended, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&site->last_owner, owner, __ATOMIC_RELAXED);
+	return ukplat_monotonic_clock();
+}
+
+/**
+ * @internal
+ * Accounts an acquisition at a lock site.
+ * @param wait_start
+ *   Return value of _uk_lockprof_contended(), or 0 if the lock was free
+ */
+void _uk_lockprof_acquired(struct uk_lockprof_site *site, __nsec wait_start);
+
+/**
+ * @internal
+ * Accounts the hold time of an exclusive lock that is released.
+ */
+void _uk_lockprof_released(struct uk_lockprof_hold *hold);
+
+static inline void _uk_lockprof_hold(struct uk_lockprof_hold *hold,
+				     struct uk_lockprof_site *site)
+{
+	hold->site = site;
+	hold->since = ukplat_monotonic_clock();
+}
+
+/**
+ * Resets the profiles of all lock sites.
+ */
+void uk_lockprof_reset(void);
+
+/**
+ * Prints the profiles of all lock sites that were used at least once.
+ */
+void uk_lockprof_print(void);
+
+#else /* !CONFIG_LIBUKLOCK_PROFILE */
+
+#define UK_LOCKPROF_SITE(opname)	NULL
+
+#endif /* !CONFIG_LIBUKLOCK_PROFILE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_LOCKPROF_H__ */
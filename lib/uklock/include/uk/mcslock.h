@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#ifndef __UK_MCSLOCK_H__
+#define __UK_MCSLOCK_H__
+
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/arch/lcpu.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_HAVE_SMP
+#include <uk/atomic.h>
+
+/*
+ * Queued spinlock after Mellor-Crummey and Scott (MCS), in the compact form
+ * that Linux uses for its qspinlock: the lock is a single 32-bit word with
+ * the lock byte and the tail of the queue of waiting lcpus. Every waiter
+ * spins on its own per-lcpu queue node instead of the lock word, so a release
+ * only touches the cache line of the next waiter. Waiters get the lock in
+ * FIFO order. The uncontended lock and unlock are a single atomic operation.
+ */
+
+/* Unless you know what you are doing, use struct uk_spinlock instead. */
+typedef struct __mcslock __mcslock;
+
+struct __align(4) __mcslock {
+	union {
+		__u32 val;
+		struct {
+			__u8 locked; /* set while the lock is held */
+			__u8 __pad;
+			__u16 tail;  /* last queued waiter, 0 if none */
+		};
+	};
+};
+
+#define UK_MCSLOCK_LOCKED	0x000000ffU
+#define UK_MCSLOCK_TAIL_SHIFT	16
+#define UK_MCSLOCK_TAIL_MASK	0xffff0000U
+
+/* Initialize an MCS lock to unlocked state */
+#define UK_MCSLOCK_INITIALIZER() { { 0 } }
+
+/**
+ * @internal
+ * Queues up the calling lcpu and spins until it owns the lock.
+ */
+void _uk_mcs_lock_slow(struct __mcslock *lock);
+
+static inline void uk_mcs_init(struct __mcslock *lock)
+{
+	lock->val = 0;
+}
+
+static inline int uk_mcs_trylock(struct __mcslock *lock)
+{
+	__u32 val = 0;
+
+	/* Do not steal the lock from queued waiters */
+	if (__atomic_load_n(&lock->val, __ATOMIC_RELAXED) != 0)
+		return 0;
+	return uk_compare_exchange_n(&lock->val, &val, 1);
+}
+
+static inline void uk_mcs_lock(struct __mcslock *lock)
+{
+	__u32 val = 0;
+
+	if (likely(uk_compare_exchange_n(&lock->val, &val, 1)))
+		return;
+	_uk_mcs_lock_slow(lock);
+}
+
+static inline void uk_mcs_unlock(struct __mcslock *lock)
+{
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+static inline int uk_mcs_is_locked(struct __mcslock *lock)
+{
+	return __atomic_load_n(&lock->val, __ATOMIC_RELAXED) != 0;
+}
+
+#else /* CONFIG_HAVE_SMP */
+
+typedef struct __mcslock {
+	/* empty */
+} __mcslock;
+
+#define UK_MCSLOCK_INITIALIZER()	{}
+#define uk_mcs_init(lock)		(void)(lock)
+#define uk_mcs_lock(lock)		\
+	do { barrier(); (void)(lock); } while (0)
+#define uk_mcs_unlock(lock)		\
+	do { barrier(); (void)(lock); } while (0)
+#define uk_mcs_trylock(lock)		({ barrier(); (void)(lock); 1; })
+#define uk_mcs_is_locked(lock)		({ barrier(); (void)(lock); 0; })
+
+#endif /* CONFIG_HAVE_SMP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_MCSLOCK_H__ */
@@ -43,6 +43,7 @@
 #include <uk/wait.h>
 #include <uk/wait_types.h>
 #include <uk/plat/time.h>
+#include <uk/lockprof.h>
 
 #ifdef CONFIG_LIBUKLOCK_MUTEX_METRICS
 #include <uk/plat/spinlock.h>
@@ -64,6 +65,9 @@ struct uk_mutex {
 	unsigned int flags;
 	struct uk_thread *owner;
 	struct uk_waitq wait;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	struct uk_lockprof_hold prof;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 };
 
 static inline int uk_mutex_is_recursive(const struct uk_mutex *m)
@@ -98,21 +102,66 @@ extern struct uk_mutex_metrics _uk_mutex_metrics;
 extern __spinlock              _uk_mutex_metrics_lock;
 #endif /* CONFIG_LIBUKLOCK_MUTEX_METRICS */
 
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+#define __UK_MUTEX_PROF_INITIALIZER				\
+	, UK_LOCKPROF_HOLD_INITIALIZER()
+#else /* !CONFIG_LIBUKLOCK_PROFILE */
+#define __UK_MUTEX_PROF_INITIALIZER
+#endif /* !CONFIG_LIBUKLOCK_PROFILE */
+
 #define	UK_MUTEX_INITIALIZER(name)				\
-	{ 0, 0, NULL, __WAIT_QUEUE_INITIALIZER((name).wait) }
+	{ 0, 0, NULL, __WAIT_QUEUE_INITIALIZER((name).wait)	\
+	  __UK_MUTEX_PROF_INITIALIZER }
 
 #define	UK_MUTEX_INITIALIZER_RECURSIVE(name)			\
 	{ 0, UK_MUTEX_CONFIG_RECURSE, 0,			\
-	__WAIT_QUEUE_INITIALIZER((name).wait) }
+	__WAIT_QUEUE_INITIALIZER((name).wait)			\
+	__UK_MUTEX_PROF_INITIALIZER }
 
 void uk_mutex_init_config(struct uk_mutex *m, unsigned int flags);
 void uk_mutex_get_metrics(struct uk_mutex_metrics *dst);
 
 #define uk_mutex_init(m) uk_mutex_init_config(m, 0)
 
-static inline void uk_mutex_lock(struct uk_mutex *m)
+#ifdef CONFIG_LIBUKLOCK_MUTEX_ADAPTIVE
+/*
+ * Spins for the mutex as long as its owner runs on another lcpu, but at most
+ * CONFIG_LIBUKLOCK_MUTEX_SPIN_MAX times. For short critical sections this is
+ * cheaper than blocking and being woken up again. Returns 1 if the mutex was
+ * acquired.
+ */
+static inline int _uk_mutex_spin(struct uk_mutex *m, struct uk_thread *cur)
+{
+	struct uk_thread *owner;
+	unsigned int spins;
+
+	for (spins = 0; spins < CONFIG_LIBUKLOCK_MUTEX_SPIN_MAX; ++spins) {
+		owner = UK_READ_ONCE(m->owner);
+		if (!owner) {
+			if (uk_compare_exchange_sync(&m->owner, NULL,
+						     cur) == cur)
+				return 1;
+			continue;
+		}
+
+		/* The owner is blocked or waits to be scheduled, possibly
+		 * on our lcpu: do not delay it any further.
+		 */
+		if (!uk_thread_is_oncpu(owner))
+			return 0;
+		ukarch_spinwait();
+	}
+	return 0;
+}
+#endif /* CONFIG_LIBUKLOCK_MUTEX_ADAPTIVE */
+
+static inline void _uk_mutex_lock(struct uk_mutex *m,
+				  struct uk_lockprof_site *site __maybe_unused)
 {
 	struct uk_thread *cur;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	__nsec wait_start = 0;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 	UK_ASSERT(m);
 
@@ -127,16 +176,30 @@ static inline void uk_mutex_lock(struct uk_mutex *m)
 
 	UK_ASSERT(m->owner != cur);
 
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	if (m->owner)
+		wait_start = _uk_lockprof_contended(site, m->owner);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
 	for (;;) {
+#ifdef CONFIG_LIBUKLOCK_MUTEX_ADAPTIVE
+		if (_uk_mutex_spin(m, cur))
+			break;
+#endif /* CONFIG_LIBUKLOCK_MUTEX_ADAPTIVE */
+
 		uk_waitq_wait_event(&m->wait, m->owner == NULL);
 
 		/* If there is no owner, we can acquire the lock */
-		if (uk_compare_exchange_sync(&m->owner, NULL, cur) == cur) {
-			UK_ASSERT(m->lock_count == 0);
-			m->lock_count = 1;
+		if (uk_compare_exchange_sync(&m->owner, NULL, cur) == cur)
 			break;
-		}
 	}
+	UK_ASSERT(m->lock_count == 0);
+	m->lock_count = 1;
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	_uk_lockprof_acquired(site, wait_start);
+	_uk_lockprof_hold(&m->prof, site);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 #ifdef CONFIG_LIBUKLOCK_MUTEX_METRICS
 	ukarch_spin_lock(&_uk_mutex_metrics_lock);
@@ -147,6 +210,12 @@ static inline void uk_mutex_lock(struct uk_mutex *m)
 #endif /* CONFIG_LIBUKLOCK_MUTEX_METRICS */
 }
 
+/**
+ * Acquires the mutex, blocking until it becomes available. With
+ * CONFIG_LIBUKLOCK_PROFILE, every call site has its own contention profile.
+ */
+#define uk_mutex_lock(m)	_uk_mutex_lock(m, UK_LOCKPROF_SITE("mutex"))
+
 static inline int uk_mutex_trylock(struct uk_mutex *m)
 {
 	struct uk_thread *cur;
@@ -175,6 +244,9 @@ static inline int uk_mutex_trylock(struct uk_mutex *m)
 		if (uk_compare_exchange_sync(&m->owner, NULL, cur) == cur) {
 			UK_ASSERT(m->lock_count == 0);
 			m->lock_count = 1;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+			m->prof.site = NULL;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 #ifdef CONFIG_LIBUKLOCK_MUTEX_METRICS
 			ukarch_spin_lock(&_uk_mutex_metrics_lock);
@@ -210,6 +282,9 @@ static inline void uk_mutex_unlock(struct uk_mutex *m)
 	UK_ASSERT(m->owner == uk_thread_current());
 
 	if (--m->lock_count == 0) {
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+		_uk_lockprof_released(&m->prof);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 		/* Make sure lock_count is visible before resetting the
 		 * owner. The lock can be acquired afterwards.
 		 */
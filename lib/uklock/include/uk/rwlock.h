@@ -11,6 +11,7 @@
 
 #if CONFIG_LIBUKLOCK_RWLOCK
 #include <uk/essentials.h>
+#include <uk/lockprof.h>
 #include <uk/spinlock.h>
 #include <uk/wait.h>
 
@@ -20,6 +21,13 @@ extern "C" {
 
 #define UK_RWLOCK_CONFIG_WRITE_RECURSE 0x01 /* Recursive locking for writers */
 
+struct uk_thread;
+
+/*
+ * Readers enter and leave with a single atomic operation on `nactive` as long
+ * as no writer holds the lock or waits for it. The spinlock and the wait
+ * queues are only used when there is contention with a writer.
+ */
 struct __align(8) uk_rwlock {
 	/** Number of active readers, -1 if writer active */
 	volatile int nactive;
@@ -29,12 +37,20 @@ struct __align(8) uk_rwlock {
 	volatile unsigned int npending_writes;
 	/** Configuration flag for lock (see UK_RWLOCK_CONFIG_*) */
 	unsigned int config_flags;
+	/** Write recursion depth of the writer */
+	unsigned int wdepth;
+	/** Thread that holds the lock for writing */
+	struct uk_thread *owner;
 	/** Spinlock to synchronize this lock */
 	struct uk_spinlock sl;
 	/** Wait queue for readers */
 	struct uk_waitq shared;
 	/** Wait queue for writers */
 	struct uk_waitq exclusive;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	/** Site where the writer acquired the lock */
+	struct uk_lockprof_hold prof;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 };
 
 static inline int uk_rwlock_is_write_recursive(const struct uk_rwlock *rwl)
@@ -54,12 +70,17 @@ void uk_rwlock_init_config(struct uk_rwlock *rwl, unsigned int config_flags);
 
 #define uk_rwlock_init(rwl) uk_rwlock_init_config(rwl, 0)
 
+void _uk_rwlock_rlock(struct uk_rwlock *rwl, struct uk_lockprof_site *site);
+void _uk_rwlock_wlock(struct uk_rwlock *rwl, struct uk_lockprof_site *site);
+
 #define UK_RWLOCK_INITIALIZER(name, flags) \
 	((struct uk_rwlock){ \
 		.nactive = 0, \
 		.npending_reads = 0, \
 		.npending_writes = 0, \
 		.config_flags = flags, \
+		.wdepth = 0, \
+		.owner = NULL, \
 		.sl = UK_SPINLOCK_INITIALIZER(), \
 		.shared = UK_WAIT_QUEUE_INITIALIZER((name).shared), \
 		.exclusive = UK_WAIT_QUEUE_INITIALIZER((name).exclusive), \
@@ -72,16 +93,20 @@ void uk_rwlock_init_config(struct uk_rwlock *rwl, unsigned int config_flags);
  * @param rwl
  *   Reader-writer lock to be acquired
  */
-void uk_rwlock_rlock(struct uk_rwlock *rwl);
+#define uk_rwlock_rlock(rwl)						\
+	_uk_rwlock_rlock(rwl, UK_LOCKPROF_SITE("rwlock-r"))
 
 /**
  * Acquire the reader-writer lock for writing. Only a single writer can
- * acquire the lock at the same time
+ * acquire the lock at the same time. With UK_RWLOCK_CONFIG_WRITE_RECURSE,
+ * the writer can acquire the lock again; it has to release it as many times
+ * as it acquired it
  *
  * @param rwl
  *   Reader-writer lock to be acquired
  */
-void uk_rwlock_wlock(struct uk_rwlock *rwl);
+#define uk_rwlock_wlock(rwl)						\
+	_uk_rwlock_wlock(rwl, UK_LOCKPROF_SITE("rwlock-w"))
 
 /**
  * Release the reader-writer lock, which has previously been acquired by this
@@ -36,6 +36,7 @@
 #include <uk/wait.h>
 #include <uk/wait_types.h>
 #include <uk/plat/time.h>
+#include <uk/lockprof.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,12 +54,21 @@ struct uk_semaphore {
 
 void uk_semaphore_init(struct uk_semaphore *s, long count);
 
-static inline void uk_semaphore_down(struct uk_semaphore *s)
+static inline void _uk_semaphore_down(struct uk_semaphore *s,
+				      struct uk_lockprof_site *site __maybe_unused)
 {
 	unsigned long irqf;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	__nsec wait_start = 0;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 	UK_ASSERT(s);
 
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	if (s->count <= 0)
+		wait_start = _uk_lockprof_contended(site, NULL);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
 	for (;;) {
 		uk_waitq_wait_event(&s->wait, s->count > 0);
 		uk_spin_lock_irqsave(&(s->sl), irqf);
@@ -71,8 +81,15 @@ static inline void uk_semaphore_down(struct uk_semaphore *s)
 	uk_pr_debug("Decreased semaphore %p to %ld\n", s, s->count);
 #endif
 	uk_spin_unlock_irqrestore(&(s->sl), irqf);
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	_uk_lockprof_acquired(site, wait_start);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 }
 
+#define uk_semaphore_down(s)						\
+	_uk_semaphore_down(s, UK_LOCKPROF_SITE("semaphore"))
+
 static inline int uk_semaphore_down_try(struct uk_semaphore *s)
 {
 	unsigned long irqf;
@@ -93,16 +110,24 @@ static inline int uk_semaphore_down_try(struct uk_semaphore *s)
 	return ret;
 }
 
-/* Returns __NSEC_MAX on timeout, expired time when down was successful */
-static inline __nsec uk_semaphore_down_to(struct uk_semaphore *s,
-					  __nsec timeout)
+static inline __nsec
+_uk_semaphore_down_to(struct uk_semaphore *s, __nsec timeout,
+		      struct uk_lockprof_site *site __maybe_unused)
 {
 	unsigned long irqf;
 	__nsec then = ukplat_monotonic_clock();
 	__nsec deadline;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	__nsec wait_start = 0;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 	UK_ASSERT(s);
 
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	if (s->count <= 0)
+		wait_start = _uk_lockprof_contended(site, NULL);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
 	deadline = then + timeout;
 
 	for (;;) {
@@ -120,6 +145,9 @@ static inline __nsec uk_semaphore_down_to(struct uk_semaphore *s,
 			    s, s->count);
 #endif
 		uk_spin_unlock_irqrestore(&(s->sl), irqf);
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+		_uk_lockprof_acquired(site, wait_start);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 		return ukplat_monotonic_clock() - then;
 	}
 
@@ -130,6 +158,10 @@ static inline __nsec uk_semaphore_down_to(struct uk_semaphore *s,
 	return __NSEC_MAX;
 }
 
+/* Returns __NSEC_MAX on timeout, expired time when down was successful */
+#define uk_semaphore_down_to(s, timeout)				\
+	_uk_semaphore_down_to(s, timeout, UK_LOCKPROF_SITE("semaphore"))
+
 static inline void uk_semaphore_up(struct uk_semaphore *s)
 {
 	unsigned long irqf;
@@ -42,7 +42,42 @@ extern "C" {
 
 /* See uk/arch/spinlock.h for the interface documentation */
 
-#ifndef CONFIG_LIBUKLOCK_TICKETLOCK
+#if defined(CONFIG_LIBUKLOCK_TICKETLOCK)
+
+#ifndef uk_spinlock
+
+#if defined(CONFIG_ARCH_ARM_64)
+#include <uk/arch/arm64/ticketlock.h>
+#elif defined(CONFIG_ARCH_X86_64)
+#include <uk/arch/x86_64/ticketlock.h>
+#endif
+
+#define uk_spinlock __ticketlock
+
+#define UK_SPINLOCK_INITIALIZER()  UKARCH_TICKETLOCK_INITIALIZER()
+#define uk_spin_init(lock)         ukarch_ticket_init(lock)
+#define _uk_spin_lock(lock)        ukarch_ticket_lock(lock)
+#define uk_spin_unlock(lock)       ukarch_ticket_unlock(lock)
+#define _uk_spin_trylock(lock)     ukarch_ticket_trylock(lock)
+#define uk_spin_is_locked(lock)    ukarch_ticket_is_locked(lock)
+#endif /* uk_spinlock */
+
+#elif defined(CONFIG_LIBUKLOCK_MCSLOCK)
+
+#ifndef uk_spinlock
+#include <uk/mcslock.h>
+
+#define uk_spinlock __mcslock
+
+#define UK_SPINLOCK_INITIALIZER()  UK_MCSLOCK_INITIALIZER()
+#define uk_spin_init(lock)         uk_mcs_init(lock)
+#define _uk_spin_lock(lock)        uk_mcs_lock(lock)
+#define uk_spin_unlock(lock)       uk_mcs_unlock(lock)
+#define _uk_spin_trylock(lock)     uk_mcs_trylock(lock)
+#define uk_spin_is_locked(lock)    uk_mcs_is_locked(lock)
+#endif /* uk_spinlock */
+
+#else /* CONFIG_LIBUKLOCK_SPINLOCK */
 
 #ifndef uk_spinlock
 #include <uk/arch/spinlock.h>
@@ -51,31 +86,98 @@ extern "C" {
 
 #define UK_SPINLOCK_INITIALIZER()  UKARCH_SPINLOCK_INITIALIZER()
 #define uk_spin_init(lock)         ukarch_spin_init(lock)
-#define uk_spin_lock(lock)         ukarch_spin_lock(lock)
+#define _uk_spin_lock(lock)        ukarch_spin_lock(lock)
 #define uk_spin_unlock(lock)       ukarch_spin_unlock(lock)
-#define uk_spin_trylock(lock)      ukarch_spin_trylock(lock)
+#define _uk_spin_trylock(lock)     ukarch_spin_trylock(lock)
 #define uk_spin_is_locked(lock)    ukarch_spin_is_locked(lock)
 #endif /* uk_spinlock */
 
-#else	/* CONFIG_LIBUKLOCK_TICKETLOCK */
+#endif /* CONFIG_LIBUKLOCK_SPINLOCK */
 
-#ifndef uk_spinlock
+#ifdef CONFIG_LIBUKLOCK_SPINLOCK_STATS
 
-#ifdef CONFIG_ARCH_ARM_64
-#include <uk/arch/arm64/ticketlock.h>
-#endif
+/*
+ * Every call site of uk_spin_lock() is a lock class with its own counters.
+ * The classes are collected in the .uk_spinlock_class section so that they
+ * can be walked with uk_spinlock_class_foreach().
+ */
+struct uk_spinlock_class {
+	const char *file;
+	unsigned int line;
+	/* Number of times the lock was taken */
+	__u64 acquisitions;
+	/* Number of times the lock was found taken */
+	__u64 contended;
+	/* Cycles spent waiting for the lock in contended acquisitions */
+	__u64 spin_cycles;
+};
+
+extern struct uk_spinlock_class uk_spinlock_class_list_start[];
+extern struct uk_spinlock_class uk_spinlock_class_list_end[];
+
+#define uk_spinlock_class_foreach(itr)					\
+	for ((itr) = uk_spinlock_class_list_start;			\
+	     (itr) < uk_spinlock_class_list_end;			\
+	     (itr)++)
+
+/**
+ * @internal
+ * Takes a lock that was found busy and accounts the time spent waiting.
+ */
+void _uk_spin_lock_contended(uk_spinlock *lock,
+			     struct uk_spinlock_class *cls);
+
+static inline void _uk_spin_lock_stats(uk_spinlock *lock,
+				       struct uk_spinlock_class *cls)
+{
+	__atomic_fetch_add(&cls->acquisitions, 1, __ATOMIC_RELAXED);
+	if (likely(_uk_spin_trylock(lock)))
+		return;
+	_uk_spin_lock_contended(lock, cls);
+}
 
-#define uk_spinlock __ticketlock
+static inline int _uk_spin_trylock_stats(uk_spinlock *lock,
+					 struct uk_spinlock_class *cls)
+{
+	if (!_uk_spin_trylock(lock))
+		return 0;
+	__atomic_fetch_add(&cls->acquisitions, 1, __ATOMIC_RELAXED);
+	return 1;
+}
 
-#define UK_SPINLOCK_INITIALIZER()  UKARCH_TICKETLOCK_INITIALIZER()
-#define uk_spin_init(lock)         ukarch_ticket_init(lock)
-#define uk_spin_lock(lock)         ukarch_ticket_lock(lock)
-#define uk_spin_unlock(lock)       ukarch_ticket_unlock(lock)
-#define uk_spin_trylock(lock)      ukarch_ticket_trylock(lock)
-#define uk_spin_is_locked(lock)    ukarch_ticket_is_locked(lock)
-#endif /* uk_spinlock */
+#define _UK_SPINLOCK_CLASS(name)					\
+	static struct uk_spinlock_class name				\
+	__section(".uk_spinlock_class") __used __align(8) =		\
+	{ .file = __FILE__, .line = __LINE__ }
+
+#define uk_spin_lock(lock)						\
+	do {								\
+		_UK_SPINLOCK_CLASS(__uk_spinlock_class);		\
+		_uk_spin_lock_stats(lock, &__uk_spinlock_class);	\
+	} while (0)
+
+#define uk_spin_trylock(lock)						\
+	({								\
+		_UK_SPINLOCK_CLASS(__uk_spinlock_class);		\
+		_uk_spin_trylock_stats(lock, &__uk_spinlock_class);	\
+	})
+
+/**
+ * Resets the counters of all lock classes.
+ */
+void uk_spinlock_stats_reset(void);
+
+/**
+ * Prints the counters of all lock classes that were used at least once.
+ */
+void uk_spinlock_stats_print(void);
+
+#else /* !CONFIG_LIBUKLOCK_SPINLOCK_STATS */
+
+#define uk_spin_lock(lock)         _uk_spin_lock(lock)
+#define uk_spin_trylock(lock)      _uk_spin_trylock(lock)
 
-#endif	/* CONFIG_LIBUKLOCK_TICKETLOCK */
+#endif /* !CONFIG_LIBUKLOCK_SPINLOCK_STATS */
 
 #define uk_spin_lock_irq(lock)						\
 	do {								\
@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uk/assert.h>
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/lockprof.h>
+#include <uk/print.h>
+#if CONFIG_LIBUKSTORE
+#include <uk/store.h>
+#endif /* CONFIG_LIBUKSTORE */
+
+static inline unsigned int lockprof_hist_bucket(__u64 nsec)
+{
+	__u64 usec = nsec / 1000;
+	unsigned int b;
+
+	if (!usec)
+		return 0;
+	b = 64 - __builtin_clzll(usec);
+	if (b >= UK_LOCKPROF_HIST_BUCKETS)
+		b = UK_LOCKPROF_HIST_BUCKETS - 1;
+	return b;
+}
+
+static inline void lockprof_max(__u64 *max, __u64 val)
+{
+	__u64 cur = __atomic_load_n(max, __ATOMIC_RELAXED);
+
+	while (val > cur &&
+	       !__atomic_compare_exchange_n(max, &cur, val, 1,
+					    __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED))
+		;
+}
+
+void _uk_lockprof_acquired(struct uk_lockprof_site *site, __nsec wait_start)
+{
+	__u64 wait;
+
+	UK_ASSERT(site);
+
+	__atomic_fetch_add(&site->acquisitions, 1, __ATOMIC_RELAXED);
+	if (!wait_start)
+		return;
+
+	wait = ukplat_monotonic_clock() - wait_start;
+	__atomic_fetch_add(&site->wait_total, wait, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&site->wait_hist[lockprof_hist_bucket(wait)], 1,
+			   __ATOMIC_RELAXED);
+	lockprof_max(&site->wait_max, wait);
+}
+
+void _uk_lockprof_released(struct uk_lockprof_hold *hold)
+{
+	__u64 held;
+
+	/* Acquired without a site, e.g., with trylock */
+	if (!hold->site)
+		return;
+
+	held = ukplat_monotonic_clock() - hold->since;
+	__atomic_fetch_add(&hold->site->hold_total, held, __ATOMIC_RELAXED);
+	lockprof_max(&hold->site->hold_max, held);
+	hold->site = NULL;
+}
+
+void uk_lockprof_reset(void)
+{
+	struct uk_lockprof_site *site;
+	const __sz off = __offsetof(struct uk_lockprof_site, acquisitions);
+
+	/* Concurrent updates may survive the reset; that is fine for a
+	 * profiler and saves us from locking the hot paths.
+	 */
+	uk_lockprof_site_foreach(site)
+		memset((char *)site + off, 0, sizeof(*site) - off);
+}
+
+/* Formats the profile of a single site into `buf` and returns the length it
+ * needs, like snprintf()
+ */
+static int lockprof_format_site(char *buf, __sz len,
+				const struct uk_lockprof_site *site)
+{
+	int ret, total;
+	unsigned int i;
+
+	total = snprintf(buf, len,
+			 "%s %s:%u acq %"__PRIu64" cont %"__PRIu64
+			 " wait %"__PRIu64"/%"__PRIu64" hold %"__PRIu64
+			 "/%"__PRIu64" owner %p hist",
+			 site->op, site->file, site->line,
+			 site->acquisitions, site->contended,
+			 site->wait_total, site->wait_max,
+			 site->hold_total, site->hold_max,
+			 site->last_owner);
+	if (unlikely(total < 0))
+		return total;
+
+	for (i = 0; i < UK_LOCKPROF_HIST_BUCKETS; ++i) {
+		if (buf && (__sz)total >= len)
+			buf = NULL;
+		ret = snprintf(buf ? buf + total : NULL,
+			       buf ? len - total : 0,
+			       " %"__PRIu64, site->wait_hist[i]);
+		if (unlikely(ret < 0))
+			return ret;
+		total += ret;
+	}
+	return total;
+}
+
+void uk_lockprof_print(void)
+{
+	struct uk_lockprof_site *site;
+	char buf[512];
+
+	uk_lockprof_site_foreach(site) {
+		if (!__atomic_load_n(&site->acquisitions, __ATOMIC_RELAXED))
+			continue;
+		if (lockprof_format_site(buf, sizeof(buf), site) < 0)
+			continue;
+		uk_pr_info("%s\n", buf);
+	}
+}
+
+#if CONFIG_LIBUKSTORE
+/* Report of all used sites, one line each: operation, site, acquisitions,
+ * contended acquisitions, total/max wait time, total/max hold time (in ns),
+ * last owner and the wait time histogram.
+ */
+static int get_report(void *cookie __unused, char **out)
+{
+	struct uk_lockprof_site *site;
+	__sz len = 1, off = 0;
+	char *str;
+	int ret;
+
+	uk_lockprof_site_foreach(site) {
+		if (!site->acquisitions)
+			continue;
+		ret = lockprof_format_site(NULL, 0, site);
+		if (unlikely(ret < 0))
+			return ret;
+		len += ret + 1;
+	}
+
+	str = malloc(len);
+	if (unlikely(!str))
+		return -ENOMEM;
+
+	/* Sites that are first used while we format are skipped */
+	uk_lockprof_site_foreach(site) {
+		if (!site->acquisitions)
+			continue;
+		ret = lockprof_format_site(str + off, len - off, site);
+		if (unlikely(ret < 0)) {
+			free(str);
+			return ret;
+		}
+		if ((__sz)ret + 1 >= len - off)
+			break;
+		off += ret;
+		str[off++] = '\n';
+	}
+	str[off] = '\0';
+
+	*out = str;
+	return 0;
+}
+UK_STORE_STATIC_ENTRY(UK_LOCKPROF_STORE_REPORT, report, charp,
+		      get_report, NULL);
+
+static int set_reset(void *cookie __unused, __u8 val)
+{
+	if (val)
+		uk_lockprof_reset();
+	return 0;
+}
+UK_STORE_STATIC_ENTRY(UK_LOCKPROF_STORE_RESET, reset, u8,
+		      NULL, set_reset);
+#endif /* CONFIG_LIBUKSTORE */
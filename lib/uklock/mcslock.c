@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/config.h>
+#include <uk/mcslock.h>
+
+#ifdef CONFIG_HAVE_SMP
+#include <stddef.h>
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/plat/lcpu.h>
+
+/* Queue nodes per lcpu: one per context that can nest a lock acquisition
+ * (thread, interrupt, nested interrupt, exception).
+ */
+#define MCS_NODES_MAX		4
+#define MCS_NODE_IDX_BITS	2
+
+struct mcs_node {
+	struct mcs_node *next;
+	int locked;
+	/* Number of nodes in use on this lcpu, only kept in the first node */
+	unsigned int count;
+} __align(CACHE_LINE_SIZE);
+
+static UKPLAT_PER_LCPU_ARRAY_DEFINE(struct mcs_node, mcs_nodes, MCS_NODES_MAX);
+
+UK_CTASSERT(CONFIG_UKPLAT_LCPU_MAXCOUNT <
+	    (1 << (16 - MCS_NODE_IDX_BITS)));
+
+static inline __u32 mcs_encode_tail(__lcpuidx lcpu, unsigned int idx)
+{
+	return (((__u32)lcpu + 1) << MCS_NODE_IDX_BITS | idx)
+		<< UK_MCSLOCK_TAIL_SHIFT;
+}
+
+static inline struct mcs_node *mcs_decode_tail(__u32 tail)
+{
+	__u32 lcpu, idx;
+
+	tail >>= UK_MCSLOCK_TAIL_SHIFT;
+	lcpu = (tail >> MCS_NODE_IDX_BITS) - 1;
+	idx = tail & (MCS_NODES_MAX - 1);
+	return &ukplat_per_lcpu_array(mcs_nodes, lcpu, idx);
+}
+
+void _uk_mcs_lock_slow(struct __mcslock *lock)
+{
+	struct mcs_node *node, *prev, *next;
+	__lcpuidx lcpu = ukplat_lcpu_idx();
+	unsigned int idx;
+	__u32 val, tail;
+
+	idx = ukplat_per_lcpu_array(mcs_nodes, lcpu, 0).count++;
+	barrier();
+
+	/* Deeper nesting than we have nodes for: fall back to spinning on
+	 * the lock word.
+	 */
+	if (unlikely(idx >= MCS_NODES_MAX)) {
+		while (!uk_mcs_trylock(lock))
+			ukarch_spinwait();
+		goto out;
+	}
+
+	node = &ukplat_per_lcpu_array(mcs_nodes, lcpu, idx);
+	node->next = NULL;
+	node->locked = 0;
+	tail = mcs_encode_tail(lcpu, idx);
+
+	/* The lock might have been released while we set up the node */
+	if (uk_mcs_trylock(lock))
+		goto out;
+
+	/* Publish ourselves as the new tail, the node stores must be visible
+	 * before anybody can find the node through the lock word.
+	 */
+	val = __atomic_load_n(&lock->val, __ATOMIC_RELAXED);
+	while (!uk_compare_exchange_n(&lock->val, &val,
+				      (val & ~UK_MCSLOCK_TAIL_MASK) | tail))
+		;
+
+	if (val & UK_MCSLOCK_TAIL_MASK) {
+		/* Link behind the previous waiter and spin on our own node
+		 * until it hands the queue head over to us.
+		 */
+		prev = mcs_decode_tail(val);
+		__atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+		while (!__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE))
+			ukarch_spinwait();
+	}
+
+	/* We are at the head of the queue: wait for the owner to leave */
+	while ((val = __atomic_load_n(&lock->val, __ATOMIC_ACQUIRE))
+	       & UK_MCSLOCK_LOCKED)
+		ukarch_spinwait();
+
+	/* Take the lock. If we are the last waiter, clear the tail as well. */
+	for (;;) {
+		if ((val & UK_MCSLOCK_TAIL_MASK) == tail) {
+			if (uk_compare_exchange_n(&lock->val, &val, 1))
+				goto out;
+		} else {
+			if (uk_compare_exchange_n(&lock->val, &val, val | 1))
+				break;
+		}
+	}
+
+	/* Somebody queued up behind us: make it the new queue head */
+	while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)))
+		ukarch_spinwait();
+	__atomic_store_n(&next->locked, 1, __ATOMIC_RELEASE);
+
+out:
+	barrier();
+	ukplat_per_lcpu_array(mcs_nodes, lcpu, 0).count--;
+}
+#endif /* CONFIG_HAVE_SMP */
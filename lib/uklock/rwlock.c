@@ -7,8 +7,8 @@
 #include <uk/atomic.h>
 #include <uk/assert.h>
 #include <uk/rwlock.h>
-#include <uk/assert.h>
 #include <uk/config.h>
+#include <uk/thread.h>
 
 void uk_rwlock_init_config(struct uk_rwlock *rwl, unsigned int config_flags)
 {
@@ -18,19 +18,60 @@ void uk_rwlock_init_config(struct uk_rwlock *rwl, unsigned int config_flags)
 	rwl->npending_reads = 0;
 	rwl->npending_writes = 0;
 	rwl->config_flags = config_flags;
-
-	/* TODO: The implementation does not support recursive write locking */
-	UK_ASSERT(!uk_rwlock_is_write_recursive(rwl));
+	rwl->owner = NULL;
+	rwl->wdepth = 0;
 
 	uk_spin_init(&rwl->sl);
 	uk_waitq_init(&rwl->shared);
 	uk_waitq_init(&rwl->exclusive);
 }
 
-void uk_rwlock_rlock(struct uk_rwlock *rwl)
+/* Enters as a reader without taking the spinlock. This fails as soon as a
+ * writer holds the lock or waits for it, so that the caller queues up in the
+ * slow path and writers do not starve.
+ */
+static inline int rwlock_rtryenter(struct uk_rwlock *rwl)
 {
+	int nactive = uk_load_n(&rwl->nactive);
+
+	while (nactive >= 0 && uk_load_n(&rwl->npending_writes) == 0) {
+		if (uk_compare_exchange_n(&rwl->nactive, &nactive,
+					  nactive + 1))
+			return 1;
+	}
+	return 0;
+}
+
+/* Enters as the writer. Must be called with the spinlock held so that
+ * writers are serialized; readers of the fast path race with us on nactive.
+ */
+static inline int rwlock_wtryenter(struct uk_rwlock *rwl)
+{
+	int nactive = 0;
+
+	return uk_compare_exchange_n(&rwl->nactive, &nactive, -1);
+}
+
+void _uk_rwlock_rlock(struct uk_rwlock *rwl,
+		      struct uk_lockprof_site *site __maybe_unused)
+{
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	__nsec wait_start;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
 	UK_ASSERT(rwl);
 
+	if (likely(rwlock_rtryenter(rwl))) {
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+		_uk_lockprof_acquired(site, 0);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+		return;
+	}
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	wait_start = _uk_lockprof_contended(site, rwl->owner);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
 	uk_spin_lock(&rwl->sl);
 	rwl->npending_reads++;
 
@@ -52,62 +93,105 @@ void uk_rwlock_rlock(struct uk_rwlock *rwl)
 				     uk_spin_unlock,
 				     &rwl->sl);
 
-	/* Wait in case a writer acquired the lock (in the meantime) */
+	/* Wait in case a writer acquired the lock (in the meantime). Writers
+	 * only enter with the spinlock held, so the lock cannot be taken by a
+	 * writer between the check and the increment.
+	 */
 	uk_waitq_wait_event_locked(&rwl->shared,
 				   rwl->nactive >= 0,
 				   uk_spin_lock,
 				   uk_spin_unlock,
 				   &rwl->sl);
 
-	rwl->nactive++;
+	uk_inc(&rwl->nactive);
 	rwl->npending_reads--;
 	uk_spin_unlock(&rwl->sl);
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	_uk_lockprof_acquired(site, wait_start);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 }
 
-void uk_rwlock_wlock(struct uk_rwlock *rwl)
+void _uk_rwlock_wlock(struct uk_rwlock *rwl,
+		      struct uk_lockprof_site *site __maybe_unused)
 {
+	struct uk_thread *current;
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	__nsec wait_start = 0;
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
+
 	UK_ASSERT(rwl);
 
+	/* Only the owner changes the owner field while holding the lock, so
+	 * we can test it without synchronization.
+	 */
+	current = uk_thread_current();
+	if (current && rwl->owner == current) {
+		UK_ASSERT(uk_rwlock_is_write_recursive(rwl));
+		UK_ASSERT(rwl->nactive == -1);
+		rwl->wdepth++;
+		return;
+	}
+
 	uk_spin_lock(&rwl->sl);
-	rwl->npending_writes++;
+
+	/* Readers that leave without the spinlock check for pending writers
+	 * after decrementing nactive. Announce us with a full barrier before
+	 * we look at nactive so that one of us sees the other.
+	 */
+	uk_inc(&rwl->npending_writes);
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	if (uk_load_n(&rwl->nactive) != 0)
+		wait_start = _uk_lockprof_contended(site, rwl->owner);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 	/* Wait for all readers to have left the lock. New readers will
 	 * block in uk_rwlock_rlock while we are waiting.
 	 */
 	uk_waitq_wait_event_locked(&rwl->exclusive,
-				   rwl->nactive == 0,
+				   rwlock_wtryenter(rwl),
 				   uk_spin_lock,
 				   uk_spin_unlock,
 				   &rwl->sl);
 
 	UK_ASSERT(rwl->npending_writes > 0);
-	UK_ASSERT(rwl->nactive == 0);
+	UK_ASSERT(rwl->nactive == -1);
 
 	rwl->npending_writes--;
-	rwl->nactive = -1;
+	rwl->owner = current;
+	rwl->wdepth = 1;
 	uk_spin_unlock(&rwl->sl);
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	_uk_lockprof_acquired(site, wait_start);
+	_uk_lockprof_hold(&rwl->prof, site);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 }
 
 void uk_rwlock_runlock(struct uk_rwlock *rwl)
 {
-	int wake_writers;
+	int nactive;
 
 	UK_ASSERT(rwl);
 
-	uk_spin_lock(&rwl->sl);
-	UK_ASSERT(rwl->nactive > 0);
-
 	/* Remove this thread from the active readers. We wake up a writer if
 	 * this was the last reader and there are writers waiting. If there
 	 * are no writers pending, readers can always enter. We make sure that
 	 * readers are not starving by prioritizing readers on write unlocks.
 	 */
-	rwl->nactive--;
-	wake_writers = (rwl->nactive == 0 && rwl->npending_writes > 0);
-	uk_spin_unlock(&rwl->sl);
-
-	if (wake_writers)
+	nactive = uk_sub_fetch(&rwl->nactive, 1);
+	UK_ASSERT(nactive >= 0);
+
+	if (nactive == 0 && uk_load_n(&rwl->npending_writes) > 0) {
+		/* The writer announces itself and goes to sleep with the
+		 * spinlock held. Taking it makes sure that the writer is on
+		 * the wait queue (or has entered) before we wake it up.
+		 */
+		uk_spin_lock(&rwl->sl);
+		uk_spin_unlock(&rwl->sl);
 		uk_waitq_wake_up_one(&rwl->exclusive);
+	}
 }
 
 void uk_rwlock_wunlock(struct uk_rwlock *rwl)
@@ -115,15 +199,24 @@ void uk_rwlock_wunlock(struct uk_rwlock *rwl)
 	int wake_readers;
 
 	UK_ASSERT(rwl);
+	UK_ASSERT(rwl->nactive == -1);
+	UK_ASSERT(rwl->wdepth > 0);
+
+	if (--rwl->wdepth > 0)
+		return;
+
+#ifdef CONFIG_LIBUKLOCK_PROFILE
+	_uk_lockprof_released(&rwl->prof);
+#endif /* CONFIG_LIBUKLOCK_PROFILE */
 
 	uk_spin_lock(&rwl->sl);
-	UK_ASSERT(rwl->nactive == -1);
 
 	/* We are the writer. When we unlock we give priority to readers
 	 * instead of writers so they do not starve. We avoid starvation of
 	 * writers in uk_rwlock_rlock().
 	 */
-	rwl->nactive = 0;
+	rwl->owner = NULL;
+	uk_store_n(&rwl->nactive, 0);
 	wake_readers = (rwl->npending_reads > 0);
 	uk_spin_unlock(&rwl->sl);
 
@@ -132,4 +225,3 @@ void uk_rwlock_wunlock(struct uk_rwlock *rwl)
 	else
 		uk_waitq_wake_up_one(&rwl->exclusive);
 }
-
@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/print.h>
+#include <uk/spinlock.h>
+
+static inline __u64 spinlock_stats_cycles(void)
+{
+#if CONFIG_ARCH_X86_64
+	__u32 lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((__u64) hi << 32) | lo;
+#elif CONFIG_ARCH_ARM_64
+	__u64 cnt;
+
+	__asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(cnt));
+	return cnt;
+#else
+	return 0;
+#endif
+}
+
+void _uk_spin_lock_contended(uk_spinlock *lock,
+			     struct uk_spinlock_class *cls)
+{
+	__u64 t0;
+
+	t0 = spinlock_stats_cycles();
+	_uk_spin_lock(lock);
+	__atomic_fetch_add(&cls->spin_cycles, spinlock_stats_cycles() - t0,
+			   __ATOMIC_RELAXED);
+	__atomic_fetch_add(&cls->contended, 1, __ATOMIC_RELAXED);
+}
+
+void uk_spinlock_stats_reset(void)
+{
+	struct uk_spinlock_class *cls;
+
+	uk_spinlock_class_foreach(cls) {
+		__atomic_store_n(&cls->acquisitions, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&cls->contended, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&cls->spin_cycles, 0, __ATOMIC_RELAXED);
+	}
+}
+
+void uk_spinlock_stats_print(void)
+{
+	struct uk_spinlock_class *cls;
+	__u64 acquisitions, contended, spin_cycles;
+
+	uk_spinlock_class_foreach(cls) {
+		acquisitions = __atomic_load_n(&cls->acquisitions,
+					       __ATOMIC_RELAXED);
+		if (!acquisitions)
+			continue;
+		contended = __atomic_load_n(&cls->contended, __ATOMIC_RELAXED);
+		spin_cycles = __atomic_load_n(&cls->spin_cycles,
+					      __ATOMIC_RELAXED);
+
+		uk_pr_info("%s:%u: %"__PRIu64" acquisitions, %"__PRIu64
+			   " contended, %"__PRIu64" spin cycles (%"__PRIu64
+			   " per contended)\n",
+			   cls->file, cls->line, acquisitions, contended,
+			   spin_cycles, contended ? spin_cycles / contended : 0);
+	}
+}
@@ -0,0 +1,341 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <string.h>
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/netdev_gro.h>
+#include <uk/plat/time.h>
+#include "netproto.h"
+
+/* Largest IP payload/total length that can be expressed in the header */
+#define GRO_IP_MAXLEN 0xffff
+
+/* TCP flags that prevent a segment from being merged */
+#define GRO_TH_FLUSH (UK_TH_FIN | UK_TH_SYN | UK_TH_RST | UK_TH_URG | \
+		      UK_TH_ECE | UK_TH_CWR)
+
+/* Parsed headers of a received TCP segment */
+struct gro_seg {
+	struct uk_iphdr *ip;    /* Set for IPv4 */
+	struct uk_ip6_hdr *ip6; /* Set for IPv6 */
+	struct uk_tcphdr *th;
+	uint16_t iphlen;
+	uint16_t thlen;
+	uint16_t paylen;
+};
+
+static inline struct uk_tcphdr *gro_th(struct uk_netbuf *pkt, uint16_t iphlen)
+{
+	return (struct uk_tcphdr *) ((__uptr) pkt->data + UK_ETHER_HDR_LEN
+				     + iphlen);
+}
+
+static inline __sz gro_pktlen(struct uk_netbuf *pkt)
+{
+	struct uk_netbuf *nb;
+	__sz len = 0;
+
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt)
+		len += nb->len;
+	return len;
+}
+
+/* Parses an Ethernet frame carrying a TCP segment. Returns 0 if the packet
+ * is a candidate for coalescing: IPv4 without options and fragmentation or
+ * IPv6 without extension headers, all headers in the first netbuf, and no
+ * trailing bytes after the IP packet.
+ */
+static int gro_parse(struct uk_netbuf *pkt, struct gro_seg *seg)
+{
+	struct uk_ether_header *eh;
+	__sz pktlen = gro_pktlen(pkt);
+	__sz iplen;
+
+	if (unlikely(pkt->len < UK_ETHER_HDR_LEN))
+		return -1;
+
+	eh = (struct uk_ether_header *) pkt->data;
+	seg->ip  = NULL;
+	seg->ip6 = NULL;
+
+	switch (np_ntohs(eh->ether_type)) {
+	case UK_ETHERTYPE_IP:
+		if (pkt->len < UK_ETHER_HDR_LEN + sizeof(struct uk_iphdr))
+			return -1;
+		seg->ip = (struct uk_iphdr *) (eh + 1);
+		if (seg->ip->ip_v != 4 ||
+		    seg->ip->ip_hl != sizeof(struct uk_iphdr) / 4 ||
+		    seg->ip->ip_p != UK_IPPROTO_TCP ||
+		    (np_ntohs(seg->ip->ip_off) & (UK_IP_MF | UK_IP_OFFMASK)))
+			return -1;
+		seg->iphlen = sizeof(struct uk_iphdr);
+		iplen = np_ntohs(seg->ip->ip_len);
+		break;
+	case UK_ETHERTYPE_IPV6:
+		if (pkt->len < UK_ETHER_HDR_LEN + sizeof(struct uk_ip6_hdr))
+			return -1;
+		seg->ip6 = (struct uk_ip6_hdr *) (eh + 1);
+		if ((np_ntohl(seg->ip6->ip6_flow) >> 28) != 6 ||
+		    seg->ip6->ip6_nxt != UK_IPPROTO_TCP)
+			return -1;
+		seg->iphlen = sizeof(struct uk_ip6_hdr);
+		iplen = sizeof(struct uk_ip6_hdr)
+			+ np_ntohs(seg->ip6->ip6_plen);
+		break;
+	default:
+		return -1;
+	}
+
+	if (pktlen != UK_ETHER_HDR_LEN + iplen)
+		return -1;
+	if (pkt->len < UK_ETHER_HDR_LEN + seg->iphlen + sizeof(struct uk_tcphdr))
+		return -1;
+
+	seg->th = gro_th(pkt, seg->iphlen);
+	seg->thlen = seg->th->th_off * 4;
+	if (seg->thlen < sizeof(struct uk_tcphdr) ||
+	    iplen < (__sz) seg->iphlen + seg->thlen ||
+	    pkt->len < UK_ETHER_HDR_LEN + seg->iphlen + seg->thlen)
+		return -1;
+
+	seg->paylen = iplen - seg->iphlen - seg->thlen;
+	return 0;
+}
+
+/* Returns 1 if `seg` belongs to the flow that is held in `f` */
+static int gro_flow_match(struct uk_netdev_gro_flow *f, struct gro_seg *seg)
+{
+	struct uk_iphdr *ip;
+	struct uk_ip6_hdr *ip6;
+	struct uk_tcphdr *th;
+
+	if (f->iphlen != seg->iphlen)
+		return 0;
+
+	th = gro_th(f->head, f->iphlen);
+	if (th->th_sport != seg->th->th_sport ||
+	    th->th_dport != seg->th->th_dport)
+		return 0;
+
+	if (seg->ip) {
+		ip = (struct uk_iphdr *) ((__uptr) f->head->data
+					  + UK_ETHER_HDR_LEN);
+		return ip->ip_src == seg->ip->ip_src &&
+		       ip->ip_dst == seg->ip->ip_dst;
+	}
+
+	ip6 = (struct uk_ip6_hdr *) ((__uptr) f->head->data + UK_ETHER_HDR_LEN);
+	return !memcmp(ip6->ip6_src, seg->ip6->ip6_src,
+		       sizeof(ip6->ip6_src) + sizeof(ip6->ip6_dst));
+}
+
+/* Returns 1 if `seg` continues the flow held in `f` and can be appended */
+static int gro_flow_continues(struct uk_netdev_gro_flow *f,
+			      struct gro_seg *seg)
+{
+	struct uk_tcphdr *th = gro_th(f->head, f->iphlen);
+	struct uk_iphdr *ip;
+
+	if (np_ntohl(seg->th->th_seq) != f->next_seq ||
+	    seg->th->th_ack != th->th_ack ||
+	    seg->thlen != f->thlen ||
+	    seg->paylen > f->mss ||
+	    f->segs >= CONFIG_LIBUKNETDEV_GRO_MAXSEGS)
+		return 0;
+
+	/* The merged packet has to fit into the IP length field */
+	if ((__sz) f->paylen + seg->paylen + f->thlen
+	    + (seg->ip ? f->iphlen : 0) > GRO_IP_MAXLEN)
+		return 0;
+
+	if (seg->ip) {
+		ip = (struct uk_iphdr *) ((__uptr) f->head->data
+					  + UK_ETHER_HDR_LEN);
+		if (ip->ip_tos != seg->ip->ip_tos ||
+		    ip->ip_ttl != seg->ip->ip_ttl)
+			return 0;
+	}
+
+	/* TCP options (e.g., timestamps) have to be identical */
+	return !memcmp(th + 1, seg->th + 1,
+		       f->thlen - sizeof(struct uk_tcphdr));
+}
+
+/* Hands the held packet of `f` to the stack and frees the slot */
+static void gro_flow_flush(struct uk_netdev_gro *gro,
+			   struct uk_netdev_gro_flow *f)
+{
+	struct uk_netbuf *pkt = f->head;
+	struct uk_iphdr *ip;
+	struct uk_ip6_hdr *ip6;
+	struct uk_tcphdr *th;
+
+	UK_ASSERT(pkt);
+
+	if (f->segs > 1) {
+		if (f->iphlen == sizeof(struct uk_iphdr)) {
+			ip = (struct uk_iphdr *) ((__uptr) pkt->data
+						  + UK_ETHER_HDR_LEN);
+			ip->ip_len = np_htons(f->iphlen + f->thlen
+					      + f->paylen);
+			np_ip_csum_set(ip);
+		} else {
+			ip6 = (struct uk_ip6_hdr *) ((__uptr) pkt->data
+						     + UK_ETHER_HDR_LEN);
+			ip6->ip6_plen = np_htons(f->thlen + f->paylen);
+		}
+
+		th = gro_th(pkt, f->iphlen);
+		th->th_flags |= f->th_flags;
+		th->th_win = f->win;
+
+		/* The TCP checksum does not cover the merged packet anymore.
+		 * All segments were validated by the device.
+		 */
+		pkt->flags &= ~UK_NETBUF_F_PARTIAL_CSUM;
+		pkt->flags |= UK_NETBUF_F_DATA_VALID;
+	}
+
+	f->head = NULL;
+	f->tail = NULL;
+	gro->deliver(pkt, gro->deliver_argp);
+}
+
+static void gro_flow_start(struct uk_netdev_gro_flow *f,
+			   struct uk_netbuf *pkt, struct gro_seg *seg)
+{
+	f->head     = pkt;
+	f->tail     = uk_netbuf_chain_last(pkt);
+	f->tstamp   = ukplat_monotonic_clock();
+	f->next_seq = np_ntohl(seg->th->th_seq) + seg->paylen;
+	f->paylen   = seg->paylen;
+	f->iphlen   = seg->iphlen;
+	f->thlen    = seg->thlen;
+	f->mss      = seg->paylen;
+	f->segs     = 1;
+	f->win      = seg->th->th_win;
+	f->th_flags = 0;
+}
+
+static void gro_flow_append(struct uk_netdev_gro_flow *f,
+			    struct uk_netbuf *pkt, struct gro_seg *seg)
+{
+	int rc __maybe_unused;
+
+	f->next_seq += seg->paylen;
+	f->paylen   += seg->paylen;
+	f->segs++;
+	f->win       = seg->th->th_win;
+	f->th_flags |= seg->th->th_flags & UK_TH_PUSH;
+
+	/* Only the payload is appended to the chain */
+	rc = uk_netbuf_header(pkt, -((int16_t) (UK_ETHER_HDR_LEN + seg->iphlen
+						 + seg->thlen)));
+	UK_ASSERT(rc == 1);
+	uk_netbuf_connect(f->tail, pkt);
+	f->tail = uk_netbuf_chain_last(pkt);
+}
+
+void uk_netdev_gro_init(struct uk_netdev_gro *gro,
+			uk_netdev_gro_deliver_t deliver, void *argp)
+{
+	UK_ASSERT(gro);
+	UK_ASSERT(deliver);
+
+	memset(gro, 0, sizeof(*gro));
+	gro->deliver = deliver;
+	gro->deliver_argp = argp;
+}
+
+void uk_netdev_gro_receive(struct uk_netdev_gro *gro, struct uk_netbuf *pkt)
+{
+	struct uk_netdev_gro_flow *f = NULL;
+	struct uk_netdev_gro_flow *slot = NULL;
+	struct gro_seg seg;
+	unsigned int i;
+
+	UK_ASSERT(gro);
+	UK_ASSERT(pkt);
+	UK_ASSERT(!pkt->prev);
+
+	if (gro_parse(pkt, &seg) < 0) {
+		gro->deliver(pkt, gro->deliver_argp);
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(gro->flows); ++i) {
+		if (!gro->flows[i].head) {
+			if (!slot || slot->head)
+				slot = &gro->flows[i];
+			continue;
+		}
+		if (gro_flow_match(&gro->flows[i], &seg)) {
+			f = &gro->flows[i];
+			break;
+		}
+		/* Remember the oldest flow in case we need to evict it */
+		if (!slot || (slot->head && gro->flows[i].tstamp < slot->tstamp))
+			slot = &gro->flows[i];
+	}
+
+	/* Segments without payload, with control flags, or without a
+	 * validated checksum are not merged. Deliver the held part of the
+	 * flow first to keep the order.
+	 */
+	if (seg.paylen == 0 || (seg.th->th_flags & GRO_TH_FLUSH) ||
+	    !(pkt->flags & (UK_NETBUF_F_DATA_VALID |
+			    UK_NETBUF_F_PARTIAL_CSUM))) {
+		if (f)
+			gro_flow_flush(gro, f);
+		gro->deliver(pkt, gro->deliver_argp);
+		return;
+	}
+
+	if (f && gro_flow_continues(f, &seg)) {
+		gro_flow_append(f, pkt, &seg);
+
+		/* A short segment or PSH ends a burst of the sender */
+		if (seg.paylen < f->mss || (seg.th->th_flags & UK_TH_PUSH))
+			gro_flow_flush(gro, f);
+		return;
+	}
+
+	if (f) {
+		gro_flow_flush(gro, f);
+		slot = f;
+	} else if (slot->head) {
+		gro_flow_flush(gro, slot);
+	}
+
+	gro_flow_start(slot, pkt, &seg);
+	if (seg.th->th_flags & UK_TH_PUSH)
+		gro_flow_flush(gro, slot);
+}
+
+void uk_netdev_gro_flush(struct uk_netdev_gro *gro)
+{
+	unsigned int i;
+
+	UK_ASSERT(gro);
+
+	for (i = 0; i < ARRAY_SIZE(gro->flows); ++i)
+		if (gro->flows[i].head)
+			gro_flow_flush(gro, &gro->flows[i]);
+}
+
+void uk_netdev_gro_flush_expired(struct uk_netdev_gro *gro, __nsec timeout)
+{
+	__nsec now = ukplat_monotonic_clock();
+	unsigned int i;
+
+	UK_ASSERT(gro);
+
+	for (i = 0; i < ARRAY_SIZE(gro->flows); ++i)
+		if (gro->flows[i].head &&
+		    now - gro->flows[i].tstamp >= timeout)
+			gro_flow_flush(gro, &gro->flows[i]);
+}
@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <string.h>
+#include <uk/alloc.h>
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/netdev.h>
+#include <uk/print.h>
+#include "netproto.h"
+
+/* Header layout of the packet that is segmented */
+struct gso_hdrs {
+	uint16_t l3off;      /* Offset of the IP header */
+	uint16_t l4off;      /* Offset of the TCP/UDP header */
+	uint16_t hdrlen;     /* Length of all headers */
+	uint8_t ipv6;        /* 1 for IPv6, 0 for IPv4 */
+	uint8_t proto;       /* UK_IPPROTO_TCP or UK_IPPROTO_UDP */
+};
+
+static int gso_parse(struct uk_netbuf *pkt, struct gso_hdrs *h)
+{
+	struct uk_ether_vlan_header *evh;
+	struct uk_iphdr *ip;
+	struct uk_ip6_hdr *ip6;
+	uint16_t type;
+
+	h->hdrlen = pkt->header_len;
+	if (unlikely(h->hdrlen > pkt->len || pkt->gso_size == 0))
+		return -EINVAL;
+	if (unlikely(h->hdrlen < UK_ETHER_HDR_LEN))
+		return -EINVAL;
+
+	evh  = (struct uk_ether_vlan_header *) pkt->data;
+	type = np_ntohs(evh->evl_encap_proto);
+	h->l3off = UK_ETHER_HDR_LEN;
+	if (type == UK_ETHERTYPE_VLAN) {
+		if (unlikely(h->hdrlen < sizeof(*evh)))
+			return -EINVAL;
+		type = np_ntohs(evh->evl_proto);
+		h->l3off = sizeof(*evh);
+	}
+
+	switch (type) {
+	case UK_ETHERTYPE_IP:
+		if (unlikely(h->hdrlen < h->l3off + sizeof(*ip)))
+			return -EINVAL;
+		ip = (struct uk_iphdr *) ((__uptr) pkt->data + h->l3off);
+		h->ipv6  = 0;
+		h->proto = ip->ip_p;
+		h->l4off = h->l3off + ip->ip_hl * 4;
+		break;
+	case UK_ETHERTYPE_IPV6:
+		if (unlikely(h->hdrlen < h->l3off + sizeof(*ip6)))
+			return -EINVAL;
+		ip6 = (struct uk_ip6_hdr *) ((__uptr) pkt->data + h->l3off);
+		h->ipv6  = 1;
+		h->proto = ip6->ip6_nxt;
+		h->l4off = h->l3off + sizeof(*ip6);
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (pkt->flags & UK_NETBUF_F_GSO_UDP_L4) {
+		if (unlikely(h->proto != UK_IPPROTO_UDP ||
+			     h->hdrlen != h->l4off + sizeof(struct uk_udphdr)))
+			return -EINVAL;
+	} else {
+		if (unlikely(h->proto != UK_IPPROTO_TCP ||
+			     h->hdrlen < h->l4off + sizeof(struct uk_tcphdr)))
+			return -EINVAL;
+	}
+	return 0;
+}
+
+/* Rewrites the headers of a segment and computes its checksums */
+static void gso_fixup(struct uk_netbuf *seg, const struct gso_hdrs *h,
+		      uint16_t idx, uint32_t seq_off, uint16_t seglen,
+		      int last)
+{
+	struct uk_iphdr *ip = NULL;
+	struct uk_ip6_hdr *ip6 = NULL;
+	struct uk_tcphdr *th;
+	struct uk_udphdr *uh;
+	uint16_t l4len = h->hdrlen - h->l4off + seglen;
+	uint16_t *l4sum;
+	uint64_t sum;
+
+	if (h->ipv6) {
+		ip6 = (struct uk_ip6_hdr *) ((__uptr) seg->data + h->l3off);
+		ip6->ip6_plen = np_htons(h->l4off - h->l3off - sizeof(*ip6)
+					 + l4len);
+		sum = np_csum_add(0, ip6->ip6_src,
+				  sizeof(ip6->ip6_src) + sizeof(ip6->ip6_dst));
+	} else {
+		ip = (struct uk_iphdr *) ((__uptr) seg->data + h->l3off);
+		ip->ip_len = np_htons(h->l4off - h->l3off + l4len);
+		ip->ip_id  = np_htons(np_ntohs(ip->ip_id) + idx);
+		ip->ip_sum = 0;
+		ip->ip_sum = np_csum_fold(np_csum_add(0, ip,
+						      h->l4off - h->l3off));
+		sum = np_csum_add(0, &ip->ip_src,
+				  sizeof(ip->ip_src) + sizeof(ip->ip_dst));
+	}
+	sum += np_htons((uint16_t) h->proto);
+	sum += np_htons(l4len);
+
+	if (h->proto == UK_IPPROTO_TCP) {
+		th = (struct uk_tcphdr *) ((__uptr) seg->data + h->l4off);
+		th->th_seq = np_htonl(np_ntohl(th->th_seq) + seq_off);
+		if (!last)
+			th->th_flags &= ~(UK_TH_FIN | UK_TH_PUSH);
+		if (idx > 0)
+			th->th_flags &= ~UK_TH_CWR;
+		l4sum = &th->th_sum;
+	} else {
+		uh = (struct uk_udphdr *) ((__uptr) seg->data + h->l4off);
+		uh->uh_ulen = np_htons(l4len);
+		l4sum = &uh->uh_sum;
+	}
+
+	*l4sum = 0;
+	sum = np_csum_add(sum, (void *) ((__uptr) seg->data + h->l4off),
+			  l4len);
+	*l4sum = np_csum_fold(sum);
+	if (h->proto == UK_IPPROTO_UDP && *l4sum == 0)
+		*l4sum = 0xffff;
+}
+
+/* Copies `len` bytes from a netbuf chain, starting at `*nb` with offset
+ * `*off`. The position is advanced.
+ */
+static void gso_copy(void *dst, struct uk_netbuf **nb, __sz *off, __sz len)
+{
+	__sz chunk;
+
+	while (len > 0) {
+		UK_ASSERT(*nb);
+		if (*off >= (*nb)->len) {
+			*nb = (*nb)->next;
+			*off = 0;
+			continue;
+		}
+		chunk = MIN(len, (*nb)->len - *off);
+		memcpy(dst, (void *) ((__uptr) (*nb)->data + *off), chunk);
+		dst = (void *) ((__uptr) dst + chunk);
+		*off += chunk;
+		len -= chunk;
+	}
+}
+
+int uk_netdev_tx_gso(struct uk_netdev *dev, uint16_t queue_id,
+		     struct uk_netbuf *pkt)
+{
+	struct uk_alloc *a = uk_alloc_get_default();
+	struct uk_netbuf *seg, *nb;
+	struct gso_hdrs h;
+	__sz paylen = 0;
+	__sz off;
+	uint16_t mss;
+	uint16_t align;
+	uint16_t seglen;
+	uint16_t i, nb_segs;
+	int ret;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(pkt);
+	UK_ASSERT(pkt->flags & UK_NETBUF_F_GSO_MASK);
+
+	mss   = pkt->gso_size;
+	align = dev->_data->ioalign ? dev->_data->ioalign : 1;
+
+	ret = gso_parse(pkt, &h);
+	if (unlikely(ret < 0)) {
+		uk_pr_err("netdev%"__PRIu16": Cannot segment packet: %d\n",
+			  dev->_data->id, ret);
+		return ret;
+	}
+
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt)
+		paylen += nb->len;
+	paylen -= h.hdrlen;
+	nb_segs = DIV_ROUND_UP(paylen, mss);
+	if (unlikely(nb_segs == 0))
+		nb_segs = 1;
+
+	nb  = pkt;
+	off = h.hdrlen;
+	for (i = 0; i < nb_segs; ++i) {
+		seglen = MIN(paylen - (__sz) i * mss, (__sz) mss);
+
+		seg = uk_netbuf_alloc_buf(a, dev->_data->nb_encap_tx
+					  + h.hdrlen + seglen,
+					  align,
+					  dev->_data->nb_encap_tx, 0, NULL);
+		if (unlikely(!seg)) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		memcpy(seg->data, pkt->data, h.hdrlen);
+		gso_copy((void *) ((__uptr) seg->data + h.hdrlen),
+			 &nb, &off, seglen);
+		seg->len = h.hdrlen + seglen;
+		gso_fixup(seg, &h, i, (uint32_t) i * mss, seglen,
+			  i == nb_segs - 1);
+
+		ret = uk_netdev_tx_one(dev, queue_id, seg);
+		if (unlikely(ret < 0 || !uk_netdev_status_successful(ret))) {
+			uk_netbuf_free(seg);
+			break;
+		}
+	}
+
+	/* Nothing sent: the caller keeps the packet */
+	if (i == 0)
+		return ret;
+
+	/* The packet is consumed as soon as one segment was sent */
+	if (unlikely(i < nb_segs)) {
+		uk_pr_debug("netdev%"__PRIu16": Dropped %"__PRIu16" of %"__PRIu16" segments\n",
+			    dev->_data->id, nb_segs - i, nb_segs);
+		ret = UK_NETDEV_STATUS_SUCCESS;
+	}
+	uk_netbuf_free(pkt);
+	return ret;
+}
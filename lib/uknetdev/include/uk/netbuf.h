@@ -50,6 +50,7 @@ extern "C" {
 #endif
 
 struct uk_netbuf;
+struct uk_netbuf_pool;
 
 typedef void (*uk_netbuf_dtor_t)(struct uk_netbuf *);
 
@@ -132,6 +133,20 @@ typedef void (*uk_netbuf_dtor_t)(struct uk_netbuf *);
 #define UK_NETBUF_F_GSO_TCPV4_BIT    2
 #define UK_NETBUF_F_GSO_TCPV4        (1 << UK_NETBUF_F_GSO_TCPV4_BIT)
 
+/* Same as UK_NETBUF_F_GSO_TCPV4 for TCP over IPv6 */
+#define UK_NETBUF_F_GSO_TCPV6_BIT    3
+#define UK_NETBUF_F_GSO_TCPV6        (1 << UK_NETBUF_F_GSO_TCPV6_BIT)
+
+/* Indicates the packet should be split into UDP datagrams of `gso_size`
+ * payload bytes each (UDP segmentation offload, IPv4 or IPv6).
+ */
+#define UK_NETBUF_F_GSO_UDP_L4_BIT   4
+#define UK_NETBUF_F_GSO_UDP_L4       (1 << UK_NETBUF_F_GSO_UDP_L4_BIT)
+
+#define UK_NETBUF_F_GSO_MASK         (UK_NETBUF_F_GSO_TCPV4 | \
+				      UK_NETBUF_F_GSO_TCPV6 | \
+				      UK_NETBUF_F_GSO_UDP_L4)
+
 struct uk_netbuf {
 	struct uk_netbuf *next;
 	struct uk_netbuf *prev;
@@ -167,6 +182,9 @@ struct uk_netbuf {
 	uk_netbuf_dtor_t dtor; /**< Destructor callback */
 	struct uk_alloc *_a;   /**< @internal Allocator for free'ing */
 	void *_b;              /**< @internal Base address for free'ing */
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+	struct uk_netbuf_pool *_p; /**< @internal Pool for recycling */
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
 };
 
 /*
@@ -345,6 +363,104 @@ struct uk_netbuf *uk_netbuf_prepare_buf(void *mem, size_t size,
 					uint16_t headroom,
 					size_t privlen, uk_netbuf_dtor_t dtor);
 
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+/**
+ * Allocates a pool of netbufs with data buffer area. Each netbuf is a single
+ * object of the pool with the buffer area placed at its beginning and aligned
+ * to the cache line size. Metadata (struct uk_netbuf, priv) is placed at the
+ * end of the object.
+ * Netbufs that are taken from the pool go back to the pool on their last
+ * uk_netbuf_free(); the heap is only used for creating the pool.
+ * Note: The pool is not synchronized. It is intended to be used by a single
+ *       queue. If netbufs are taken or returned from interrupt context, the
+ *       caller has to make sure that this does not interleave with other
+ *       operations on the same pool.
+ * @param a
+ *   Allocator to be used for allocating the pool
+ * @param count
+ *   Number of netbufs in the pool
+ * @param buflen
+ *   Minimum size of the buffer area of each netbuf (including headroom)
+ * @param headroom
+ *   Number of bytes reserved as headroom from the buffer area.
+ *   `headroom` has to be smaller or equal to `buflen`.
+ * @param privlen
+ *   Length for reserved memory to store private data of each netbuf.
+ * @returns
+ *   - (NULL): Allocation failed
+ *   - pointer to netbuf pool
+ */
+struct uk_netbuf_pool *uk_netbuf_pool_alloc(struct uk_alloc *a,
+					    unsigned int count, size_t buflen,
+					    uint16_t headroom, size_t privlen);
+
+/**
+ * Frees a netbuf pool that was allocated with uk_netbuf_pool_alloc().
+ * Note: All netbufs of the pool have to be free'd before.
+ * @param p
+ *   Pointer to netbuf pool
+ */
+void uk_netbuf_pool_free(struct uk_netbuf_pool *p);
+
+/**
+ * Returns the number of netbufs that are currently available in a pool.
+ * @param p
+ *   Pointer to netbuf pool
+ * @returns
+ *   Number of free netbufs
+ */
+unsigned int uk_netbuf_pool_availcount(struct uk_netbuf_pool *p);
+
+/**
+ * Takes multiple netbufs from a pool. Each netbuf is initialized like
+ * with uk_netbuf_prepare_buf(): m->len is 0 and m->data points to the first
+ * byte after the headroom.
+ * @param p
+ *   Pointer to netbuf pool
+ * @param m
+ *   Array that is filled with references to the taken netbufs
+ * @param count
+ *   Maximum number of netbufs to take
+ * @returns
+ *   Number of netbufs placed on `m`
+ */
+unsigned int uk_netbuf_pool_take_batch(struct uk_netbuf_pool *p,
+				       struct uk_netbuf *m[],
+				       unsigned int count);
+
+/**
+ * Takes one netbuf from a pool.
+ * @param p
+ *   Pointer to netbuf pool
+ * @returns
+ *   - (NULL): Pool is empty
+ *   - initialized uk_netbuf
+ */
+static inline struct uk_netbuf *uk_netbuf_pool_take(struct uk_netbuf_pool *p)
+{
+	struct uk_netbuf *m;
+
+	if (uk_netbuf_pool_take_batch(p, &m, 1) != 1)
+		return NULL;
+	return m;
+}
+
+/**
+ * Receive buffer allocator callback (see `uk_netdev_alloc_rxpkts`) that
+ * takes netbufs from the netbuf pool given with `argp`.
+ * @param argp
+ *   Pointer to netbuf pool
+ * @param pkts
+ *   Array that is filled with references to the taken netbufs
+ * @param count
+ *   Number of requested netbufs
+ * @returns
+ *   Number of netbufs placed on `pkts`
+ */
+uint16_t uk_netbuf_pool_alloc_rxpkts(void *argp, struct uk_netbuf *pkts[],
+				     uint16_t count);
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
+
 /**
  * Retrieves the last element of a netbuf chain
  * @param m
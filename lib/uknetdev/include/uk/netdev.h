@@ -437,6 +437,70 @@ static inline int uk_netdev_rxq_intr_disable(struct uk_netdev *dev,
 	return dev->ops->rxq_intr_disable(dev, dev->_rx_queue[queue_id]);
 }
 
+#ifdef CONFIG_LIBUKNETDEV_DISPATCHER_NAPI
+/**
+ * @internal
+ * Charges a received packet to the poll budget of the queue dispatcher. As
+ * soon as the budget is used up, UK_NETDEV_STATUS_MORE is hidden from the
+ * caller so that the event callback returns to the dispatcher thread.
+ * Outside of a dispatcher poll, the budget is zero and `status` is returned
+ * unmodified.
+ */
+static inline int _uk_netdev_rx_budget(struct uk_netdev *dev,
+				       uint16_t queue_id, int status)
+{
+	struct uk_netdev_event_handler *h;
+
+	h = &dev->_data->rxq_handler[queue_id];
+	if (!h->budget)
+		return status;
+
+	if (--h->budget == 0 && (status & UK_NETDEV_STATUS_MORE)) {
+		h->more = 1;
+		status &= ~UK_NETDEV_STATUS_MORE;
+	}
+	return status;
+}
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI */
+
+#if CONFIG_LIBUKNETDEV_RXHOOK
+/**
+ * Registers or removes the early receive hook of a receive queue. The hook
+ * is called from uk_netdev_rx_one() for every received packet and decides
+ * with its verdict if the packet is returned to the caller, dropped, or sent
+ * out again (see uk_netdev_rxhook_t). Packets that are not passed are never
+ * seen by the API user.
+ * The hook must not be changed while a receive on the queue is in progress,
+ * e.g., from within the queue event callback of another queue.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The index of the receive queue.
+ *   The value must be in the range [0, nb_rx_queue - 1] previously supplied
+ *   to uk_netdev_configure().
+ * @param hook
+ *   The hook function, or NULL to remove the current hook.
+ * @param argp
+ *   Extra argument that is handed over to the hook.
+ * @return
+ *   - (0): Success.
+ *   - (-EINVAL): The device is not configured yet.
+ */
+int uk_netdev_rxq_hook_set(struct uk_netdev *dev, uint16_t queue_id,
+			   uk_netdev_rxhook_t hook, void *argp);
+
+/**
+ * @internal
+ * Runs the receive hook of a queue on a received packet and executes its
+ * verdict. Returns the verdict; for anything else than UK_NETDEV_RXHOOK_PASS,
+ * the packet has been consumed.
+ */
+enum uk_netdev_rxhook_verdict _uk_netdev_rxhook_run(struct uk_netdev *dev,
+						    uint16_t queue_id,
+						    struct uk_netbuf *pkt);
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
+
 /**
  * Receive one packet and re-program used receive descriptors. In order to avoid
  * race conditions, queue interrupts have to be off while executing this
@@ -445,6 +509,13 @@ static inline int uk_netdev_rxq_intr_disable(struct uk_netdev *dev,
  * uk_netdev_rxq_intr_enable() indicated that packets are left on the queue.
  * In both cases, uk_netdev_rx_one() is going to enable interrupts again as soon
  * as the last packet was received from the queue.
+ * With CONFIG_LIBUKNETDEV_DISPATCHER_NAPI, the dispatcher thread owns the
+ * queue interrupts instead and re-arms them after polling. Within the event
+ * callback, UK_NETDEV_STATUS_MORE is cleared once the poll budget is used up;
+ * the callback is then expected to return to the dispatcher.
+ * With CONFIG_LIBUKNETDEV_RXHOOK, packets that the receive hook of the queue
+ * consumes are not returned; the next packet of the queue is received instead
+ * (see uk_netdev_rxq_hook_set()).
  * If this function is called from interrupt context (e.g., within receive event
  * handler when no dispatcher threads are configured) make sure that the
  * provided receive buffer allocator function is interrupt-context-safe
@@ -477,6 +548,9 @@ static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
 				   struct uk_netbuf **pkt)
 {
 	int ret;
+#ifdef CONFIG_LIBUKNETDEV_RXHOOK
+	int underrun = 0;
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
 
 	UK_ASSERT(dev);
 	UK_ASSERT(dev->rx_one);
@@ -486,9 +560,15 @@ static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
 		  !PTRISERR(dev->_rx_queue[queue_id]));
 	UK_ASSERT(pkt);
 
-
+#ifdef CONFIG_LIBUKNETDEV_RXHOOK
+next:
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
 	ret = dev->rx_one(dev, dev->_rx_queue[queue_id], pkt);
 
+#ifdef CONFIG_LIBUKNETDEV_DISPATCHER_NAPI
+	if (ret >= 0 && (ret & UK_NETDEV_STATUS_SUCCESS))
+		ret = _uk_netdev_rx_budget(dev, queue_id, ret);
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI */
 #ifdef CONFIG_LIBUKNETDEV_STATS
 	if (ret >= 0 && (ret & UK_NETDEV_STATUS_SUCCESS)) {
 		struct uk_netbuf *nb;
@@ -498,15 +578,11 @@ static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
 			dev->_stats.rx_m.bytes += (*pkt)->len;
 		dev->_stats.rx_m.packets++;
 		ukarch_spin_unlock(&dev->_stats_lock);
-		return ret;
-	}
-	if (ret >= 0 && (ret & UK_NETDEV_STATUS_UNDERRUN)) {
+	} else if (ret >= 0 && (ret & UK_NETDEV_STATUS_UNDERRUN)) {
 		ukarch_spin_lock(&dev->_stats_lock);
 		dev->_stats.rx_m.fifo++;
 		ukarch_spin_unlock(&dev->_stats_lock);
-		return ret;
-	}
-	if (ret < 0) {
+	} else if (ret < 0) {
 		ukarch_spin_lock(&dev->_stats_lock);
 		dev->_stats.rx_m.errors++;
 		ukarch_spin_unlock(&dev->_stats_lock);
@@ -514,9 +590,56 @@ static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
 	}
 #endif /* CONFIG_LIBUKNETDEV_STATS */
 
+#ifdef CONFIG_LIBUKNETDEV_RXHOOK
+	if (ret >= 0 && (ret & UK_NETDEV_STATUS_SUCCESS) &&
+	    unlikely(dev->_data->rxq_handler[queue_id].rxhook) &&
+	    _uk_netdev_rxhook_run(dev, queue_id, *pkt)
+	    != UK_NETDEV_RXHOOK_PASS) {
+		/* Consumed by the hook: continue with the next packet */
+		*pkt = NULL;
+		underrun |= ret & UK_NETDEV_STATUS_UNDERRUN;
+		if (ret & UK_NETDEV_STATUS_MORE)
+			goto next;
+		ret &= ~UK_NETDEV_STATUS_SUCCESS;
+	}
+	if (ret >= 0)
+		ret |= underrun;
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
+
 	return ret;
 }
 
+#if CONFIG_LIBUKNETDEV_GSO
+/**
+ * Segments a netbuf that has one of the UK_NETBUF_F_GSO_* flags set in
+ * software and transmits the resulting packets. It is called by
+ * uk_netdev_tx_one() when the device does not offload the requested
+ * segmentation.
+ * Once the first segment was put to the transmit queue, `pkt` is consumed.
+ * Segments that do not fit into the queue anymore are dropped.
+ * Parameters and return values are the same as for uk_netdev_tx_one().
+ */
+int uk_netdev_tx_gso(struct uk_netdev *dev, uint16_t queue_id,
+		     struct uk_netbuf *pkt);
+
+/**
+ * @internal
+ * Returns true if the device can do the segmentation requested by
+ * `nb_flags` (UK_NETBUF_F_GSO_*) itself.
+ */
+static inline int _uk_netdev_gso_offloaded(struct uk_netdev *dev,
+					   uint8_t nb_flags)
+{
+	uint32_t features = dev->_data->features;
+
+	if (nb_flags & UK_NETBUF_F_GSO_TCPV4)
+		return uk_netdev_tso4_supported(features);
+	if (nb_flags & UK_NETBUF_F_GSO_TCPV6)
+		return uk_netdev_tso6_supported(features);
+	return uk_netdev_uso_supported(features);
+}
+#endif /* CONFIG_LIBUKNETDEV_GSO */
+
 /**
  * Transmit one packet
  *
@@ -532,6 +655,9 @@ static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
  *   Please note that some drivers may require available headroom on the netbuf
  *   for doing a transmission - inspect `nb_encap` with uk_netdev_info_get().
  *   `pkt` has never to be `NULL`.
+ *   With CONFIG_LIBUKNETDEV_GSO, packets with a UK_NETBUF_F_GSO_* flag that
+ *   the device cannot segment are segmented in software
+ *   (see uk_netdev_tx_gso()).
  * @return
  *   - (>=0): Positive value with status flags
  *     - UK_NETDEV_STATUS_SUCCESS: `pkt` was successfully put to the transmit
@@ -556,6 +682,12 @@ static inline int uk_netdev_tx_one(struct uk_netdev *dev, uint16_t queue_id,
 		  !PTRISERR(dev->_tx_queue[queue_id]));
 	UK_ASSERT(pkt);
 
+#if CONFIG_LIBUKNETDEV_GSO
+	if (unlikely(pkt->flags & UK_NETBUF_F_GSO_MASK) &&
+	    !_uk_netdev_gso_offloaded(dev, pkt->flags))
+		return uk_netdev_tx_gso(dev, queue_id, pkt);
+#endif /* CONFIG_LIBUKNETDEV_GSO */
+
 	ret = dev->tx_one(dev, dev->_tx_queue[queue_id], pkt);
 
 #ifdef CONFIG_LIBUKNETDEV_STATS
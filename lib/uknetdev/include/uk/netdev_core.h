@@ -147,6 +147,23 @@ struct uk_hwaddr {
 #define UK_NETDEV_F_TSO4_BIT		3
 #define UK_NETDEV_F_TSO4		(1UL << UK_NETDEV_F_TSO4_BIT)
 
+/* Indicates that the network device supports sending netbufs with the
+ * UK_NETBUF_F_GSO_TCPV6 bit set. */
+#define UK_NETDEV_F_TSO6_BIT		5
+#define UK_NETDEV_F_TSO6		(1UL << UK_NETDEV_F_TSO6_BIT)
+
+/* Indicates that the network device supports sending netbufs with the
+ * UK_NETBUF_F_GSO_UDP_L4 bit set. */
+#define UK_NETDEV_F_USO_BIT		6
+#define UK_NETDEV_F_USO			(1UL << UK_NETDEV_F_USO_BIT)
+
+/* Indicates that the network device may coalesce received TCP segments.
+ * Received packets can then be longer than the MTU and are provided as
+ * netbuf chains.
+ */
+#define UK_NETDEV_F_LRO_BIT		4
+#define UK_NETDEV_F_LRO			(1UL << UK_NETDEV_F_LRO_BIT)
+
 #define uk_netdev_rxintr_supported(feature)	\
 	(feature & (UK_NETDEV_F_RXQ_INTR))
 #define uk_netdev_txintr_supported(feature)	\
@@ -155,6 +172,12 @@ struct uk_hwaddr {
 	(feature & (UK_NETDEV_F_PARTIAL_CSUM))
 #define uk_netdev_tso4_supported(feature) \
 	(feature & (UK_NETDEV_F_TSO4))
+#define uk_netdev_tso6_supported(feature) \
+	(feature & (UK_NETDEV_F_TSO6))
+#define uk_netdev_uso_supported(feature) \
+	(feature & (UK_NETDEV_F_USO))
+#define uk_netdev_lro_supported(feature) \
+	(feature & (UK_NETDEV_F_LRO))
 /**
  * A structure used to describe network device capabilities.
  */
@@ -271,6 +294,53 @@ typedef uint16_t (*uk_netdev_alloc_rxpkts)(void *argp,
 					   struct uk_netbuf *pkts[],
 					   uint16_t count);
 
+#if CONFIG_LIBUKNETDEV_RXHOOK
+/**
+ * Verdicts returned by a receive hook.
+ */
+enum uk_netdev_rxhook_verdict {
+	UK_NETDEV_RXHOOK_PASS = 0, /**< Return the packet to the API user. */
+	UK_NETDEV_RXHOOK_DROP,     /**< Free the packet. */
+	UK_NETDEV_RXHOOK_TX,       /**< Send the packet on the transmit queue
+				    *   with the same ID of the same device.
+				    */
+	UK_NETDEV_RXHOOK_REDIRECT, /**< Send the packet on the transmit queue
+				    *   selected by the hook.
+				    */
+};
+
+/**
+ * Transmit queue selected by a receive hook for UK_NETDEV_RXHOOK_REDIRECT.
+ */
+struct uk_netdev_rxhook_target {
+	struct uk_netdev *dev;
+	uint16_t queue_id;
+};
+
+/**
+ * Function type used for receive hooks. It is called for every packet that
+ * is received from the queue, before the packet is returned by
+ * uk_netdev_rx_one(). The hook may modify the packet (e.g., rewrite
+ * addresses for UK_NETDEV_RXHOOK_TX) but must not free it.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The receive queue on which the packet was received.
+ * @param pkt
+ *   The received packet.
+ * @param target
+ *   To be filled in by the hook when returning UK_NETDEV_RXHOOK_REDIRECT.
+ * @param argp
+ *   Extra argument that was defined on hook registration.
+ * @return
+ *   Verdict that decides what happens with the packet.
+ */
+typedef enum uk_netdev_rxhook_verdict (*uk_netdev_rxhook_t)(
+	struct uk_netdev *dev, uint16_t queue_id, struct uk_netbuf *pkt,
+	struct uk_netdev_rxhook_target *target, void *argp);
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
+
 /**
  * A structure used to configure an Unikraft network device RX queue.
  */
@@ -439,6 +509,14 @@ struct uk_netdev_event_handler {
 	char                *dispatcher_name; /**< reference to thread name */
 	struct uk_sched     *dispatcher_s;    /**< Scheduler for dispatcher. */
 #endif
+#ifdef CONFIG_LIBUKNETDEV_DISPATCHER_NAPI
+	uint16_t            budget;      /**< packets left in current poll */
+	int                 more;        /**< budget ran out, queue not empty */
+#endif
+#ifdef CONFIG_LIBUKNETDEV_RXHOOK
+	uk_netdev_rxhook_t  rxhook;      /**< early receive hook */
+	void                *rxhook_argp; /**< argument for the hook */
+#endif
 };
 
 /**
@@ -453,6 +531,12 @@ struct uk_netdev_data {
 
 	const uint16_t       id;    /**< ID is assigned during registration */
 	const char           *drv_name;
+
+#if CONFIG_LIBUKNETDEV_GSO
+	uint32_t             features;    /**< Cached device features */
+	uint16_t             nb_encap_tx; /**< Cached tx headroom */
+	uint16_t             ioalign;     /**< Cached buffer alignment */
+#endif /* CONFIG_LIBUKNETDEV_GSO */
 };
 
 #if CONFIG_LIBUKNETDEV_EINFO_LIBPARAM
@@ -487,9 +571,31 @@ struct uk_netdev_rx_stats {
 	size_t fifo;
 };
 
+#if CONFIG_LIBUKNETDEV_RXHOOK
+struct uk_netdev_rxhook_stats {
+	/** The number of packets that were passed to the API user */
+	size_t pass;
+
+	/** The number of packets that were dropped */
+	size_t drop;
+
+	/** The number of packets that were sent back out */
+	size_t tx;
+
+	/** The number of packets that were redirected */
+	size_t redirect;
+
+	/** The number of packets that could not be sent or redirected */
+	size_t aborted;
+};
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
+
 struct uk_netdev_stats {
 	struct uk_netdev_tx_stats tx_m;
 	struct uk_netdev_rx_stats rx_m;
+#if CONFIG_LIBUKNETDEV_RXHOOK
+	struct uk_netdev_rxhook_stats rxhook_m;
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
 };
 
 /**
@@ -69,6 +69,27 @@ extern "C" {
 int uk_netdev_drv_register(struct uk_netdev *dev, struct uk_alloc *a,
 			   const char *drv_name);
 
+/**
+ * Prepares a packet with UK_NETBUF_F_GSO_TCPV4 or UK_NETBUF_F_GSO_TCPV6 set
+ * for segmentation by the device. The TCP checksum field is seeded with the
+ * pseudo-header checksum without the length, as most devices add the length
+ * of each segment themselves. For IPv4, the total length and the header
+ * checksum are cleared for the same reason. All headers (`header_len`) have to be
+ * within the first netbuf of the chain.
+ *
+ * @param pkt
+ *   Packet to be segmented by the device
+ * @param l3_off
+ *   Set to the offset of the IP header
+ * @param l4_off
+ *   Set to the offset of the TCP header
+ * @return
+ *   - (0): Success
+ *   - (-EINVAL): The headers do not match the requested segmentation
+ */
+int uk_netdev_drv_tso_prepare(struct uk_netbuf *pkt,
+			      uint16_t *l3_off, uint16_t *l4_off);
+
 /**
  * Forwards an RX queue event to the API user
  * Can (and should) be called from device interrupt context
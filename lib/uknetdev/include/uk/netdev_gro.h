@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#ifndef __UK_NETDEV_GRO__
+#define __UK_NETDEV_GRO__
+
+#include <stdint.h>
+#include <uk/arch/time.h>
+#include <uk/netbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Software receive-side coalescing (generic receive offload).
+ *
+ * A GRO context is placed between the receive function of a queue
+ * (e.g., `uk_netdev_rx_one()`) and the network stack. Consecutive in-order
+ * TCP segments of the same flow are merged into a single packet: the payload
+ * of each following segment is appended as netbuf chain to the first
+ * segment, whose IP and TCP headers are updated on delivery. All other
+ * packets are handed to the stack unmodified.
+ * Held packets are delivered when a flow can not be continued, on
+ * uk_netdev_gro_flush() (e.g., at the end of a receive burst), or on
+ * uk_netdev_gro_flush_expired() (e.g., from a timer).
+ * A GRO context is not synchronized and is intended to be used by the
+ * receive path of a single queue.
+ */
+
+/**
+ * Function type for handing packets over to the network stack.
+ *
+ * @param pkt
+ *   Received (and possibly coalesced) packet. Ownership is passed.
+ * @param argp
+ *   Argument that was given with uk_netdev_gro_init().
+ */
+typedef void (*uk_netdev_gro_deliver_t)(struct uk_netbuf *pkt, void *argp);
+
+/**
+ * @internal
+ * State of a flow that is being coalesced.
+ */
+struct uk_netdev_gro_flow {
+	struct uk_netbuf *head;   /**< First segment, NULL if unused */
+	struct uk_netbuf *tail;   /**< Last netbuf of the chain */
+	__nsec tstamp;            /**< Arrival time of the first segment */
+	uint32_t next_seq;        /**< Expected sequence number (host order) */
+	uint32_t paylen;          /**< Accumulated TCP payload length */
+	uint16_t iphlen;          /**< Length of the IP header */
+	uint16_t thlen;           /**< Length of the TCP header */
+	uint16_t mss;             /**< Payload length of the first segment */
+	uint16_t segs;            /**< Number of merged segments */
+	uint16_t win;             /**< Latest window (network order) */
+	uint8_t th_flags;         /**< Accumulated TCP flags */
+};
+
+/**
+ * GRO context, typically one per receive queue.
+ */
+struct uk_netdev_gro {
+	uk_netdev_gro_deliver_t deliver;
+	void *deliver_argp;
+	struct uk_netdev_gro_flow flows[CONFIG_LIBUKNETDEV_GRO_MAXFLOWS];
+};
+
+/**
+ * Initializes a GRO context.
+ *
+ * @param gro
+ *   GRO context to initialize
+ * @param deliver
+ *   Function that is called for every packet handed to the network stack
+ * @param argp
+ *   Extra argument for `deliver`
+ */
+void uk_netdev_gro_init(struct uk_netdev_gro *gro,
+			uk_netdev_gro_deliver_t deliver, void *argp);
+
+/**
+ * Passes a received packet to the GRO context. The packet is either merged
+ * into a held flow, held as start of a new flow, or delivered immediately.
+ * Packets with payload are only merged if their checksum was validated by
+ * the device (UK_NETBUF_F_DATA_VALID or UK_NETBUF_F_PARTIAL_CSUM).
+ *
+ * @param gro
+ *   GRO context
+ * @param pkt
+ *   Received packet. Ownership is passed to the GRO context.
+ */
+void uk_netdev_gro_receive(struct uk_netdev_gro *gro, struct uk_netbuf *pkt);
+
+/**
+ * Delivers all held packets.
+ *
+ * @param gro
+ *   GRO context
+ */
+void uk_netdev_gro_flush(struct uk_netdev_gro *gro);
+
+/**
+ * Delivers held packets whose first segment arrived at least `timeout`
+ * nanoseconds ago.
+ *
+ * @param gro
+ *   GRO context
+ * @param timeout
+ *   Maximum time a packet is held back
+ */
+void uk_netdev_gro_flush_expired(struct uk_netdev_gro *gro, __nsec timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_NETDEV_GRO__ */
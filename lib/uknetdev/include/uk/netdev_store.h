@@ -17,4 +17,10 @@
 #define UK_NETDEV_STATS_RX_ERRORS	0x30
 #define UK_NETDEV_STATS_RX_FIFO		0x40
 
+#define UK_NETDEV_STATS_RXHOOK_PASS	0x50
+#define UK_NETDEV_STATS_RXHOOK_DROP	0x51
+#define UK_NETDEV_STATS_RXHOOK_TX	0x52
+#define UK_NETDEV_STATS_RXHOOK_REDIRECT	0x53
+#define UK_NETDEV_STATS_RXHOOK_ABORTED	0x54
+
 #endif /* __UK_NETDEV_STORE_H__ */
@@ -52,6 +52,15 @@
 
 #define	UK_ETHER_VLAN_ENCAP_LEN	4	/* len of 802.1Q VLAN encapsulation */
 
+/*
+ * Ethernet header.
+ */
+struct uk_ether_header {
+	uint8_t ether_dhost[UK_ETH_ADDR_LEN];
+	uint8_t ether_shost[UK_ETH_ADDR_LEN];
+	uint16_t ether_type;
+} __packed;
+
 /*
  * 802.1q Virtual LAN header.
  */
@@ -93,6 +102,18 @@ struct uk_iphdr {
 	uint32_t 	ip_src, ip_dst;		/* source and dest address */
 } __packed __align(2);
 
+/*
+ * IPv6 header, without extension headers.
+ */
+struct uk_ip6_hdr {
+	uint32_t	ip6_flow;		/* version, class and flow label */
+	uint16_t	ip6_plen;		/* payload length */
+	uint8_t		ip6_nxt;		/* next header */
+	uint8_t		ip6_hlim;		/* hop limit */
+	uint8_t		ip6_src[16];		/* source address */
+	uint8_t		ip6_dst[16];		/* destination address */
+} __packed __align(2);
+
 #define	UK_IPPROTO_IP		0		/* dummy for IP */
 #define	UK_IPPROTO_ICMP		1		/* control message protocol */
 #define	UK_IPPROTO_TCP		6		/* tcp */
@@ -134,4 +155,15 @@ struct uk_tcphdr {
 	uint16_t	th_urp;			/* urgent pointer */
 };
 
+/*
+ * UDP header.
+ * Per RFC 768, September, 1981.
+ */
+struct uk_udphdr {
+	uint16_t	uh_sport;		/* source port */
+	uint16_t	uh_dport;		/* destination port */
+	uint16_t	uh_ulen;		/* udp length */
+	uint16_t	uh_sum;			/* udp checksum */
+};
+
 #endif /* __UK_NETSTRUCTS__ */
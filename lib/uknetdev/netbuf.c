@@ -32,6 +32,10 @@
 #include <uk/netbuf.h>
 #include <uk/essentials.h>
 #include <uk/print.h>
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+#include <uk/allocpool.h>
+#include <uk/arch/lcpu.h>
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
 
 /* Used to align netbuf's priv and data areas to `long long` data type */
 #define NETBUF_ADDR_ALIGNMENT (sizeof(long long))
@@ -40,6 +44,19 @@
 #define NETBUF_ADDR_ALIGN_DOWN(x) ALIGN_DOWN((__uptr) (x), \
 					     NETBUF_ADDR_ALIGNMENT)
 
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+/* Number of pool objects that are taken or returned with one batch call */
+#define NETBUF_POOL_BATCH 32U
+
+struct uk_netbuf_pool {
+	struct uk_alloc *a;      /* Parent allocator of the pool */
+	struct uk_allocpool *ap; /* Pool of netbuf objects */
+	size_t meta_off;         /* Offset of `struct uk_netbuf` in an object */
+	size_t privlen;
+	uint16_t headroom;
+};
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
+
 #if CONFIG_LIBUKSGLIST
 int uk_netbuf_sglist_append(struct uk_sglist *sg, struct uk_netbuf *netbuf)
 {
@@ -241,10 +258,20 @@ void uk_netbuf_append(struct uk_netbuf *head,
 	tail->prev = headtail;
 }
 
-void uk_netbuf_free_single(struct uk_netbuf *m)
+/* Releases a reference to `m`. When this was the last reference, the netbuf
+ * is disconnected from its chain and its destructor is called. The memory of
+ * heap-allocated netbufs is free'd. For netbufs of a pool, the object is
+ * returned via `obj` and `p` so that the caller can give it back to the pool.
+ */
+static inline void _netbuf_release(struct uk_netbuf *m,
+				   void **obj __maybe_unused,
+				   struct uk_netbuf_pool **p __maybe_unused)
 {
 	struct uk_alloc *a;
 	void *b;
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+	struct uk_netbuf_pool *mp;
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
 
 	UK_ASSERT(m);
 
@@ -266,27 +293,174 @@ void uk_netbuf_free_single(struct uk_netbuf *m)
 		 */
 		a = m->_a;
 		b = m->_b;
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+		mp = m->_p;
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
 
 		if (m->dtor)
 			m->dtor(m);
 		if (a && b)
 			uk_free(a, b);
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+		else if (mp) {
+			*obj = b;
+			*p = mp;
+		}
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
 	} else {
 		uk_pr_debug("Not freeing netbuf %p (next: %p): refcount greater than 1",
 			    m, m->next);
 	}
 }
 
+void uk_netbuf_free_single(struct uk_netbuf *m)
+{
+	void *obj = NULL;
+	struct uk_netbuf_pool *p = NULL;
+
+	_netbuf_release(m, &obj, &p);
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+	if (p)
+		uk_allocpool_return(p->ap, obj);
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
+}
+
 void uk_netbuf_free(struct uk_netbuf *m)
 {
 	struct uk_netbuf *n;
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+	void *objs[NETBUF_POOL_BATCH];
+	struct uk_netbuf_pool *batch_p = NULL;
+	unsigned int count = 0;
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
+	void *obj;
+	struct uk_netbuf_pool *p;
 
 	UK_ASSERT(m);
 	UK_ASSERT(!m->prev);
 
 	while (m != NULL) {
 		n = m->next;
-		uk_netbuf_free_single(m);
+		p = NULL;
+		_netbuf_release(m, &obj, &p);
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+		if (p) {
+			/* Collect objects of the same pool and give them
+			 * back with a single batch call.
+			 */
+			if (count == NETBUF_POOL_BATCH
+			    || (count > 0 && p != batch_p)) {
+				uk_allocpool_return_batch(batch_p->ap,
+							  objs, count);
+				count = 0;
+			}
+			batch_p = p;
+			objs[count++] = obj;
+		}
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
 		m = n;
 	}
+
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+	if (count > 0)
+		uk_allocpool_return_batch(batch_p->ap, objs, count);
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
+}
+
+#if CONFIG_LIBUKNETDEV_NETBUF_POOL
+struct uk_netbuf_pool *uk_netbuf_pool_alloc(struct uk_alloc *a,
+					    unsigned int count, size_t buflen,
+					    uint16_t headroom, size_t privlen)
+{
+	struct uk_netbuf_pool *p;
+	size_t meta_len;
+	size_t obj_len;
+
+	UK_ASSERT(a);
+	UK_ASSERT(count > 0);
+	UK_ASSERT(buflen > 0);
+	UK_ASSERT(headroom <= buflen);
+
+	/* Objects are padded to full cache lines so that no two netbufs
+	 * share a line. The buffer area starts at the beginning of an
+	 * object, the metadata is placed at its end.
+	 */
+	meta_len = NETBUF_ADDR_ALIGN_UP(sizeof(struct uk_netbuf) + privlen);
+	obj_len  = ALIGN_UP(NETBUF_ADDR_ALIGN_UP(buflen) + meta_len,
+			    CACHE_LINE_SIZE);
+
+	p = uk_malloc(a, sizeof(*p));
+	if (unlikely(!p))
+		return NULL;
+
+	p->ap = uk_allocpool_alloc(a, count, obj_len, CACHE_LINE_SIZE);
+	if (unlikely(!p->ap)) {
+		uk_free(a, p);
+		return NULL;
+	}
+
+	p->a        = a;
+	p->meta_off = obj_len - meta_len;
+	p->privlen  = privlen;
+	p->headroom = headroom;
+	return p;
+}
+
+void uk_netbuf_pool_free(struct uk_netbuf_pool *p)
+{
+	UK_ASSERT(p);
+
+	uk_allocpool_free(p->ap);
+	uk_free(p->a, p);
+}
+
+unsigned int uk_netbuf_pool_availcount(struct uk_netbuf_pool *p)
+{
+	UK_ASSERT(p);
+
+	return uk_allocpool_availcount(p->ap);
+}
+
+unsigned int uk_netbuf_pool_take_batch(struct uk_netbuf_pool *p,
+				       struct uk_netbuf *m[],
+				       unsigned int count)
+{
+	void *objs[NETBUF_POOL_BATCH];
+	struct uk_netbuf *nb;
+	unsigned int taken = 0;
+	unsigned int n, i;
+
+	UK_ASSERT(p);
+	UK_ASSERT(m || count == 0);
+
+	while (taken < count) {
+		n = uk_allocpool_take_batch(p->ap, objs,
+					    MIN(count - taken,
+						NETBUF_POOL_BATCH));
+		for (i = 0; i < n; ++i) {
+			nb = (struct uk_netbuf *) ((__uptr) objs[i]
+						   + p->meta_off);
+			uk_netbuf_init_indir(nb, objs[i], p->meta_off,
+					     p->headroom,
+					     p->privlen > 0
+					     ? (void *) ((__uptr) nb
+							 + sizeof(*nb))
+					     : NULL,
+					     NULL);
+			nb->_b = objs[i];
+			nb->_p = p;
+			m[taken++] = nb;
+		}
+		if (n < NETBUF_POOL_BATCH)
+			break;
+	}
+	return taken;
+}
+
+uint16_t uk_netbuf_pool_alloc_rxpkts(void *argp, struct uk_netbuf *pkts[],
+				     uint16_t count)
+{
+	return (uint16_t) uk_netbuf_pool_take_batch(
+		(struct uk_netbuf_pool *) argp, pkts, count);
 }
+#endif /* CONFIG_LIBUKNETDEV_NETBUF_POOL */
@@ -41,6 +41,9 @@
 #if CONFIG_LIBUKNETDEV_EINFO_LIBPARAM
 #include <uk/argparse.h>
 #endif /* CONFIG_LIBUKNETDEV_EINFO_LIBPARAM */
+#if CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL > 0
+#include <uk/plat/time.h>
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL > 0 */
 
 #if CONFIG_LIBUKNETDEV_STATS
 #include "stats.h"
@@ -408,6 +411,12 @@ int uk_netdev_configure(struct uk_netdev *dev,
 			   dev->_data->id);
 		dev->_data->state = UK_NETDEV_CONFIGURED;
 
+#if CONFIG_LIBUKNETDEV_GSO
+		dev->_data->features    = dev_info.features;
+		dev->_data->nb_encap_tx = dev_info.nb_encap_tx;
+		dev->_data->ioalign     = dev_info.ioalign;
+#endif /* CONFIG_LIBUKNETDEV_GSO */
+
 #ifdef CONFIG_LIBUKNETDEV_STATS
 	ret = uk_netdev_stats_init(dev);
 	if (unlikely(ret)) {
@@ -424,6 +433,79 @@ int uk_netdev_configure(struct uk_netdev *dev,
 }
 
 #ifdef CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
+#ifdef CONFIG_LIBUKNETDEV_DISPATCHER_NAPI
+#define DISPATCHER_BUSYPOLL_NSEC \
+	ukarch_time_usec_to_nsec(CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL)
+
+/*
+ * Runs the event callback once with a fresh packet budget.
+ * Returns the number of packets that were received by the callback.
+ * `handler->more` is set if the budget was used up before the queue
+ * was drained.
+ */
+static uint16_t _dispatcher_poll(struct uk_netdev_event_handler *handler)
+{
+	uint16_t budget;
+
+	handler->more = 0;
+	handler->budget = CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUDGET;
+	handler->callback(handler->dev,
+			  handler->queue_id,
+			  handler->cookie);
+	budget = handler->budget;
+	handler->budget = 0;
+	return CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUDGET - budget;
+}
+
+static void _dispatcher_napi(struct uk_netdev_event_handler *handler)
+{
+#if CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL > 0
+	__nsec deadline;
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL > 0 */
+	int rc;
+
+	do {
+		/* Keep queue interrupts off while we poll. This also prevents
+		 * the driver from re-arming them when the queue runs empty.
+		 */
+		rc = uk_netdev_rxq_intr_disable(handler->dev,
+						handler->queue_id);
+		if (unlikely(rc < 0)) {
+			/* No interrupt control: single callback, as without
+			 * the hybrid mode
+			 */
+			handler->callback(handler->dev,
+					  handler->queue_id,
+					  handler->cookie);
+			return;
+		}
+
+#if CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL > 0
+		deadline = 0;
+		for (;;) {
+			if (_dispatcher_poll(handler) > 0 || handler->more)
+				deadline = 0;
+			else if (!deadline)
+				deadline = ukplat_monotonic_clock() +
+					   DISPATCHER_BUSYPOLL_NSEC;
+			else if (ukplat_monotonic_clock() >= deadline)
+				break;
+			uk_sched_yield();
+		}
+#else /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL == 0 */
+		while (_dispatcher_poll(handler), handler->more)
+			uk_sched_yield();
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI_BUSYPOLL == 0 */
+
+		/* Queue is drained: re-arm interrupts. If packets arrived in
+		 * the meantime, the driver tells us and we continue polling.
+		 */
+		rc = uk_netdev_rxq_intr_enable(handler->dev,
+					       handler->queue_id);
+	} while (rc == 1);
+}
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHER_NAPI */
+
 static __noreturn void _dispatcher(void *arg)
 {
 	struct uk_netdev_event_handler *handler =
@@ -434,9 +516,13 @@ static __noreturn void _dispatcher(void *arg)
 
 	for (;;) {
 		uk_semaphore_down(&handler->events);
+#ifdef CONFIG_LIBUKNETDEV_DISPATCHER_NAPI
+		_dispatcher_napi(handler);
+#else /* !CONFIG_LIBUKNETDEV_DISPATCHER_NAPI */
 		handler->callback(handler->dev,
 				  handler->queue_id,
 				  handler->cookie);
+#endif /* !CONFIG_LIBUKNETDEV_DISPATCHER_NAPI */
 	}
 }
 #endif
@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+/* Internal helpers for parsing and rewriting protocol headers */
+
+#ifndef __UKNETDEV_NETPROTO_H__
+#define __UKNETDEV_NETPROTO_H__
+
+#include <stdint.h>
+#include <uk/essentials.h>
+#include <uk/netstructs.h>
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define np_ntohs(x) __builtin_bswap16(x)
+#define np_ntohl(x) __builtin_bswap32(x)
+#else /* __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ */
+#define np_ntohs(x) ((uint16_t) (x))
+#define np_ntohl(x) ((uint32_t) (x))
+#endif /* __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ */
+#define np_htons(x) np_ntohs(x)
+#define np_htonl(x) np_ntohl(x)
+
+/* Adds `len` bytes at `data` to a one's complement sum. Bytes are summed
+ * as 16-bit words in memory order, so the folded result can be stored
+ * into a header field as is.
+ */
+static inline uint64_t np_csum_add(uint64_t sum, const void *data, __sz len)
+{
+	const uint8_t *p = (const uint8_t *) data;
+	uint16_t w;
+
+	while (len >= 2) {
+		__builtin_memcpy(&w, p, sizeof(w));
+		sum += w;
+		p += 2;
+		len -= 2;
+	}
+	if (len) {
+		w = 0;
+		*(uint8_t *) &w = *p;
+		sum += w;
+	}
+	return sum;
+}
+
+static inline uint16_t np_csum_fold(uint64_t sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t) ~sum;
+}
+
+/* Computes the header checksum of an IPv4 header without options */
+static inline void np_ip_csum_set(struct uk_iphdr *ip)
+{
+	ip->ip_sum = 0;
+	ip->ip_sum = np_csum_fold(np_csum_add(0, ip, sizeof(*ip)));
+}
+
+#endif /* __UKNETDEV_NETPROTO_H__ */
@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/netdev_driver.h>
+#include "netproto.h"
+
+int uk_netdev_drv_tso_prepare(struct uk_netbuf *pkt,
+			      uint16_t *l3_off, uint16_t *l4_off)
+{
+	struct uk_ether_vlan_header *evh;
+	struct uk_iphdr *ip;
+	struct uk_ip6_hdr *ip6;
+	struct uk_tcphdr *th;
+	uint16_t type, l3off, l4off;
+	uint64_t sum;
+
+	UK_ASSERT(pkt);
+	UK_ASSERT(pkt->flags & (UK_NETBUF_F_GSO_TCPV4 | UK_NETBUF_F_GSO_TCPV6));
+
+	if (unlikely(pkt->header_len > pkt->len ||
+		     pkt->header_len < UK_ETHER_HDR_LEN ||
+		     pkt->gso_size == 0))
+		return -EINVAL;
+
+	evh   = (struct uk_ether_vlan_header *) pkt->data;
+	type  = np_ntohs(evh->evl_encap_proto);
+	l3off = UK_ETHER_HDR_LEN;
+	if (type == UK_ETHERTYPE_VLAN) {
+		if (unlikely(pkt->header_len < sizeof(*evh)))
+			return -EINVAL;
+		type  = np_ntohs(evh->evl_proto);
+		l3off = sizeof(*evh);
+	}
+
+	if (pkt->flags & UK_NETBUF_F_GSO_TCPV4) {
+		if (unlikely(type != UK_ETHERTYPE_IP ||
+			     pkt->header_len < l3off + sizeof(*ip)))
+			return -EINVAL;
+		ip = (struct uk_iphdr *) ((__uptr) pkt->data + l3off);
+		if (unlikely(ip->ip_p != UK_IPPROTO_TCP))
+			return -EINVAL;
+		l4off = l3off + ip->ip_hl * 4;
+		/* The device fills in length and checksum of every segment
+		 * and sums over the fields as they are
+		 */
+		ip->ip_len = 0;
+		ip->ip_sum = 0;
+		sum = np_csum_add(0, &ip->ip_src,
+				  sizeof(ip->ip_src) + sizeof(ip->ip_dst));
+	} else {
+		if (unlikely(type != UK_ETHERTYPE_IPV6 ||
+			     pkt->header_len < l3off + sizeof(*ip6)))
+			return -EINVAL;
+		ip6 = (struct uk_ip6_hdr *) ((__uptr) pkt->data + l3off);
+		if (unlikely(ip6->ip6_nxt != UK_IPPROTO_TCP))
+			return -EINVAL;
+		l4off = l3off + sizeof(*ip6);
+		sum = np_csum_add(0, ip6->ip6_src,
+				  sizeof(ip6->ip6_src) + sizeof(ip6->ip6_dst));
+	}
+	if (unlikely(pkt->header_len < l4off + sizeof(*th)))
+		return -EINVAL;
+
+	/* The device adds the length of every segment itself */
+	sum += np_htons((uint16_t) UK_IPPROTO_TCP);
+	th = (struct uk_tcphdr *) ((__uptr) pkt->data + l4off);
+	th->th_sum = (uint16_t) ~np_csum_fold(sum);
+
+	*l3_off = l3off;
+	*l4_off = l4off;
+	return 0;
+}
@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/netdev.h>
+#include <uk/print.h>
+
+int uk_netdev_rxq_hook_set(struct uk_netdev *dev, uint16_t queue_id,
+			   uk_netdev_rxhook_t hook, void *argp)
+{
+	struct uk_netdev_event_handler *h;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+	UK_ASSERT(queue_id < CONFIG_LIBUKNETDEV_MAXNBQUEUES);
+
+	if (dev->_data->state != UK_NETDEV_CONFIGURED &&
+	    dev->_data->state != UK_NETDEV_RUNNING)
+		return -EINVAL;
+
+	h = &dev->_data->rxq_handler[queue_id];
+	h->rxhook = hook;
+	h->rxhook_argp = argp;
+
+	uk_pr_info("netdev%"PRIu16": %s receive hook on queue %"PRIu16"\n",
+		   dev->_data->id, hook ? "Installed" : "Removed", queue_id);
+	return 0;
+}
+
+/* Sends a packet on behalf of the hook, returns 0 when it was queued */
+static int rxhook_xmit(struct uk_netdev *dev, uint16_t queue_id,
+		       struct uk_netbuf *pkt)
+{
+	int ret;
+
+	if (unlikely(!dev || queue_id >= CONFIG_LIBUKNETDEV_MAXNBQUEUES ||
+		     dev->_data->state != UK_NETDEV_RUNNING ||
+		     !dev->_tx_queue[queue_id] ||
+		     PTRISERR(dev->_tx_queue[queue_id])))
+		return -EINVAL;
+
+	ret = uk_netdev_tx_one(dev, queue_id, pkt);
+	if (unlikely(!uk_netdev_status_successful(ret)))
+		return ret < 0 ? ret : -ENOSPC;
+	return 0;
+}
+
+#if CONFIG_LIBUKNETDEV_STATS
+#define rxhook_stats_inc(dev, field)				\
+	do {							\
+		ukarch_spin_lock(&(dev)->_stats_lock);		\
+		(dev)->_stats.rxhook_m.field++;			\
+		ukarch_spin_unlock(&(dev)->_stats_lock);	\
+	} while (0)
+#else /* !CONFIG_LIBUKNETDEV_STATS */
+#define rxhook_stats_inc(dev, field) do {} while (0)
+#endif /* !CONFIG_LIBUKNETDEV_STATS */
+
+enum uk_netdev_rxhook_verdict _uk_netdev_rxhook_run(struct uk_netdev *dev,
+						    uint16_t queue_id,
+						    struct uk_netbuf *pkt)
+{
+	struct uk_netdev_event_handler *h;
+	struct uk_netdev_rxhook_target target = { NULL, 0 };
+	enum uk_netdev_rxhook_verdict verdict;
+	int rc;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(pkt);
+
+	h = &dev->_data->rxq_handler[queue_id];
+	UK_ASSERT(h->rxhook);
+
+	verdict = h->rxhook(dev, queue_id, pkt, &target, h->rxhook_argp);
+	switch (verdict) {
+	case UK_NETDEV_RXHOOK_PASS:
+		rxhook_stats_inc(dev, pass);
+		return verdict;
+	case UK_NETDEV_RXHOOK_TX:
+		rc = rxhook_xmit(dev, queue_id, pkt);
+		if (likely(rc == 0)) {
+			rxhook_stats_inc(dev, tx);
+			return verdict;
+		}
+		break;
+	case UK_NETDEV_RXHOOK_REDIRECT:
+		rc = rxhook_xmit(target.dev, target.queue_id, pkt);
+		if (likely(rc == 0)) {
+			rxhook_stats_inc(dev, redirect);
+			return verdict;
+		}
+		break;
+	default:
+		uk_netbuf_free(pkt);
+		rxhook_stats_inc(dev, drop);
+		return UK_NETDEV_RXHOOK_DROP;
+	}
+
+	/* Sending failed: the packet is dropped */
+	uk_pr_debug("netdev%"PRIu16": Receive hook verdict %d failed: %d\n",
+		    dev->_data->id, (int) verdict, rc);
+	uk_netbuf_free(pkt);
+	rxhook_stats_inc(dev, aborted);
+	return UK_NETDEV_RXHOOK_DROP;
+}
@@ -20,9 +20,9 @@ static int get_tx_bytes(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.tx_m.bytes;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -33,9 +33,9 @@ static int get_tx_packets(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.tx_m.packets;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -46,9 +46,9 @@ static int get_tx_errors(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.tx_m.errors;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -59,9 +59,9 @@ static int get_tx_fifo(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.tx_m.fifo;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -72,9 +72,9 @@ static int get_rx_bytes(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.rx_m.bytes;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -85,9 +85,9 @@ static int get_rx_packets(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.rx_m.packets;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -98,9 +98,9 @@ static int get_rx_errors(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.rx_m.errors;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
@@ -111,13 +111,80 @@ static int get_rx_fifo(void *cookie, __u64 *out)
 
 	UK_ASSERT(dev);
 
-	uk_spin_lock(&dev->_stats_lock);
+	ukarch_spin_lock(&dev->_stats_lock);
 	*out = dev->_stats.rx_m.fifo;
-	uk_spin_unlock(&dev->_stats_lock);
+	ukarch_spin_unlock(&dev->_stats_lock);
 
 	return 0;
 }
 
+#if CONFIG_LIBUKNETDEV_RXHOOK
+static int get_rxhook_pass(void *cookie, __u64 *out)
+{
+	struct uk_netdev *dev = (struct uk_netdev *)cookie;
+
+	UK_ASSERT(dev);
+
+	ukarch_spin_lock(&dev->_stats_lock);
+	*out = dev->_stats.rxhook_m.pass;
+	ukarch_spin_unlock(&dev->_stats_lock);
+
+	return 0;
+}
+
+static int get_rxhook_drop(void *cookie, __u64 *out)
+{
+	struct uk_netdev *dev = (struct uk_netdev *)cookie;
+
+	UK_ASSERT(dev);
+
+	ukarch_spin_lock(&dev->_stats_lock);
+	*out = dev->_stats.rxhook_m.drop;
+	ukarch_spin_unlock(&dev->_stats_lock);
+
+	return 0;
+}
+
+static int get_rxhook_tx(void *cookie, __u64 *out)
+{
+	struct uk_netdev *dev = (struct uk_netdev *)cookie;
+
+	UK_ASSERT(dev);
+
+	ukarch_spin_lock(&dev->_stats_lock);
+	*out = dev->_stats.rxhook_m.tx;
+	ukarch_spin_unlock(&dev->_stats_lock);
+
+	return 0;
+}
+
+static int get_rxhook_redirect(void *cookie, __u64 *out)
+{
+	struct uk_netdev *dev = (struct uk_netdev *)cookie;
+
+	UK_ASSERT(dev);
+
+	ukarch_spin_lock(&dev->_stats_lock);
+	*out = dev->_stats.rxhook_m.redirect;
+	ukarch_spin_unlock(&dev->_stats_lock);
+
+	return 0;
+}
+
+static int get_rxhook_aborted(void *cookie, __u64 *out)
+{
+	struct uk_netdev *dev = (struct uk_netdev *)cookie;
+
+	UK_ASSERT(dev);
+
+	ukarch_spin_lock(&dev->_stats_lock);
+	*out = dev->_stats.rxhook_m.aborted;
+	ukarch_spin_unlock(&dev->_stats_lock);
+
+	return 0;
+}
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
+
 static const struct uk_store_entry *dyn_entries[] = {
 	UK_STORE_ENTRY(UK_NETDEV_STATS_TX_BYTES, "tx_bytes", u64,
 		       get_tx_bytes, NULL),
@@ -135,6 +202,18 @@ static const struct uk_store_entry *dyn_entries[] = {
 		       get_rx_errors, NULL),
 	UK_STORE_ENTRY(UK_NETDEV_STATS_RX_FIFO, "rx_fifo", u64,
 		       get_rx_fifo, NULL),
+#if CONFIG_LIBUKNETDEV_RXHOOK
+	UK_STORE_ENTRY(UK_NETDEV_STATS_RXHOOK_PASS, "rxhook_pass", u64,
+		       get_rxhook_pass, NULL),
+	UK_STORE_ENTRY(UK_NETDEV_STATS_RXHOOK_DROP, "rxhook_drop", u64,
+		       get_rxhook_drop, NULL),
+	UK_STORE_ENTRY(UK_NETDEV_STATS_RXHOOK_TX, "rxhook_tx", u64,
+		       get_rxhook_tx, NULL),
+	UK_STORE_ENTRY(UK_NETDEV_STATS_RXHOOK_REDIRECT, "rxhook_redirect", u64,
+		       get_rxhook_redirect, NULL),
+	UK_STORE_ENTRY(UK_NETDEV_STATS_RXHOOK_ABORTED, "rxhook_aborted", u64,
+		       get_rxhook_aborted, NULL),
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
 	NULL
 };
 
@@ -0,0 +1,573 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <uk/alloc.h>
+#include <uk/essentials.h>
+#include <uk/netdev.h>
+#include <uk/plat/time.h>
+#include <uk/test.h>
+#if CONFIG_LIBUKNETDEV_GRO
+#include <uk/netdev_gro.h>
+#endif /* CONFIG_LIBUKNETDEV_GRO */
+#if CONFIG_LIBUKNETDEV_GRO || CONFIG_LIBUKNETDEV_GSO
+#include "../netproto.h"
+#endif /* CONFIG_LIBUKNETDEV_GRO || CONFIG_LIBUKNETDEV_GSO */
+
+#ifndef CONFIG_LIBUKNETDEV_TEST_BENCH_PKTS
+#define CONFIG_LIBUKNETDEV_TEST_BENCH_PKTS 100000
+#endif /* !CONFIG_LIBUKNETDEV_TEST_BENCH_PKTS */
+
+#define BENCH_NB_PKTS	CONFIG_LIBUKNETDEV_TEST_BENCH_PKTS
+#define BENCH_BUFLEN	2048
+#define BENCH_NB_DESC	256
+
+static const __u16 bench_pktlen[] = { 64, 512, 1500 };
+static const __u16 bench_batch[]  = { 1, 8, 32 };
+
+struct bench_result {
+	__u64 sent;
+	__u64 received;
+	__u64 corrupted;
+	__nsec nsec;
+	__u64 cycles;
+};
+
+static struct uk_netdev *bench_dev;
+static __u16 bench_rxheadroom;
+
+static inline __u64 bench_cycles(void)
+{
+#if CONFIG_ARCH_X86_64
+	__u32 lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((__u64) hi << 32) | lo;
+#elif CONFIG_ARCH_ARM_64
+	__u64 cnt;
+
+	__asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(cnt));
+	return cnt;
+#else
+	return 0;
+#endif
+}
+
+static __u16 bench_alloc_rxpkts(void *argp __unused,
+				struct uk_netbuf *pkts[], __u16 count)
+{
+	struct uk_alloc *a = uk_alloc_get_default();
+	__u16 i;
+
+	for (i = 0; i < count; ++i) {
+		pkts[i] = uk_netbuf_alloc_buf(a, BENCH_BUFLEN, sizeof(void *),
+					      bench_rxheadroom, 0, NULL);
+		if (unlikely(!pkts[i]))
+			break;
+		pkts[i]->len = pkts[i]->buflen - uk_netbuf_headroom(pkts[i]);
+	}
+	return i;
+}
+
+/* Configures the first loopback device for polling on queue 0 */
+static struct uk_netdev *bench_setup(void)
+{
+	struct uk_alloc *a = uk_alloc_get_default();
+	struct uk_netdev_conf dev_conf = { .nb_rx_queues = 1,
+					   .nb_tx_queues = 1 };
+	struct uk_netdev_rxqueue_conf rxq_conf = { 0 };
+	struct uk_netdev_txqueue_conf txq_conf = { 0 };
+	struct uk_netdev_info info;
+	struct uk_netdev *dev;
+	unsigned int i;
+	const char *name;
+
+	for (i = 0, dev = NULL; i < uk_netdev_count() && !dev; ++i) {
+		dev = uk_netdev_get(i);
+		name = uk_netdev_drv_name_get(dev);
+		if (!name || strcmp(name, "loop") ||
+		    uk_netdev_state_get(dev) != UK_NETDEV_UNCONFIGURED)
+			dev = NULL;
+	}
+	if (!dev)
+		return NULL;
+
+	uk_netdev_info_get(dev, &info);
+	bench_rxheadroom = info.nb_encap_rx;
+
+	if (uk_netdev_configure(dev, &dev_conf) < 0)
+		return NULL;
+
+	rxq_conf.a = a;
+	rxq_conf.alloc_rxpkts = bench_alloc_rxpkts;
+	if (uk_netdev_rxq_configure(dev, 0, BENCH_NB_DESC, &rxq_conf) < 0)
+		return NULL;
+
+	txq_conf.a = a;
+	if (uk_netdev_txq_configure(dev, 0, BENCH_NB_DESC, &txq_conf) < 0)
+		return NULL;
+
+	if (uk_netdev_start(dev) < 0)
+		return NULL;
+	return dev;
+}
+
+/* Receives until the queue is empty */
+static void bench_drain(struct uk_netdev *dev, __u16 pktlen,
+			struct bench_result *res)
+{
+	struct uk_netbuf *pkt;
+	int status;
+
+	do {
+		status = uk_netdev_rx_one(dev, 0, &pkt);
+		if (unlikely(status < 0))
+			return;
+		if (uk_netdev_status_successful(status)) {
+			if (unlikely(pkt->len != pktlen ||
+				     ((__u8 *) pkt->data)[pktlen - 1]
+				     != (__u8) pktlen))
+				res->corrupted++;
+			res->received++;
+			uk_netbuf_free(pkt);
+		}
+	} while (uk_netdev_status_more(status));
+}
+
+static void bench_run(struct uk_netdev *dev, __u16 pktlen, __u16 batch,
+		      struct bench_result *res)
+{
+	struct uk_alloc *a = uk_alloc_get_default();
+	struct uk_netdev_info info;
+	struct uk_netbuf *pkt;
+	__nsec t0;
+	__u64 c0;
+	__u16 i;
+	int status;
+
+	uk_netdev_info_get(dev, &info);
+	memset(res, 0, sizeof(*res));
+
+	t0 = ukplat_monotonic_clock();
+	c0 = bench_cycles();
+	while (res->sent < BENCH_NB_PKTS) {
+		for (i = 0; i < batch && res->sent < BENCH_NB_PKTS; ++i) {
+			pkt = uk_netbuf_alloc_buf(a, info.nb_encap_tx + pktlen,
+						  info.ioalign ? info.ioalign
+							       : sizeof(void *),
+						  info.nb_encap_tx, 0, NULL);
+			if (unlikely(!pkt))
+				goto out;
+			pkt->len = pktlen;
+			memset(pkt->data, 0, UK_ETH_HDR_UNTAGGED_LEN);
+			((__u8 *) pkt->data)[pktlen - 1] = (__u8) pktlen;
+
+			status = uk_netdev_tx_one(dev, 0, pkt);
+			if (!uk_netdev_status_successful(status)) {
+				uk_netbuf_free(pkt);
+				if (unlikely(status < 0))
+					goto out;
+				break;
+			}
+			res->sent++;
+		}
+		bench_drain(dev, pktlen, res);
+	}
+
+out:
+	bench_drain(dev, pktlen, res);
+	res->cycles = bench_cycles() - c0;
+	res->nsec = ukplat_monotonic_clock() - t0;
+}
+
+UK_TESTCASE(uknetdev_loop, loop_pktgen)
+{
+	struct bench_result res;
+	unsigned int i, j;
+	__u64 pps;
+
+	bench_dev = bench_setup();
+	if (!bench_dev) {
+		printf("uknetdev: No unused loopback device, skipping\n");
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(bench_pktlen); ++i) {
+		for (j = 0; j < ARRAY_SIZE(bench_batch); ++j) {
+			bench_run(bench_dev, bench_pktlen[i], bench_batch[j],
+				  &res);
+
+			UK_TEST_EXPECT_SNUM_EQ(res.sent, BENCH_NB_PKTS);
+#if CONFIG_LIBUKNETDEV_LOOP_NULL
+			/* A null device receives nothing */
+			UK_TEST_EXPECT_ZERO(res.received);
+#else /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+			UK_TEST_EXPECT_SNUM_EQ(res.received, res.sent);
+#endif /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+			UK_TEST_EXPECT_ZERO(res.corrupted);
+
+			pps = res.nsec ? (res.sent * ukarch_time_sec_to_nsec(1))
+					 / res.nsec : 0;
+			printf("uknetdev: len %4"__PRIu16" batch %2"__PRIu16
+			       ": tx %"__PRIu64" rx %"__PRIu64
+			       " pkts, %"__PRIu64" pps, %"__PRIu64
+			       " cycles/pkt\n",
+			       bench_pktlen[i], bench_batch[j],
+			       res.sent, res.received, pps,
+			       res.sent ? res.cycles / res.sent : 0);
+		}
+	}
+}
+
+#if CONFIG_LIBUKNETDEV_RXHOOK
+static enum uk_netdev_rxhook_verdict
+test_rxhook_drop_odd(struct uk_netdev *dev __unused, __u16 queue_id __unused,
+		     struct uk_netbuf *pkt,
+		     struct uk_netdev_rxhook_target *target __unused,
+		     void *argp)
+{
+	unsigned int *seen = (unsigned int *) argp;
+
+	(*seen)++;
+	return (((__u8 *) pkt->data)[pkt->len - 1] & 1)
+	       ? UK_NETDEV_RXHOOK_DROP : UK_NETDEV_RXHOOK_PASS;
+}
+
+UK_TESTCASE(uknetdev_loop, loop_rxhook)
+{
+	struct bench_result res;
+	unsigned int seen = 0;
+
+	/* Runs after loop_pktgen, which configured the device */
+	if (!bench_dev)
+		return;
+
+	UK_TEST_EXPECT_ZERO(uk_netdev_rxq_hook_set(bench_dev, 0,
+						   test_rxhook_drop_odd,
+						   &seen));
+	bench_run(bench_dev, 65, 8, &res);
+	UK_TEST_EXPECT_SNUM_EQ(res.sent, BENCH_NB_PKTS);
+#if CONFIG_LIBUKNETDEV_LOOP_NULL
+	/* A null device receives nothing, so the hook never runs */
+	UK_TEST_EXPECT_ZERO(seen);
+#else /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+	/* All packets carry an odd marker, none may pass */
+	UK_TEST_EXPECT_SNUM_EQ(seen, res.sent);
+#endif /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+	UK_TEST_EXPECT_ZERO(res.received);
+
+	seen = 0;
+	bench_run(bench_dev, 64, 8, &res);
+	UK_TEST_EXPECT_SNUM_EQ(res.sent, BENCH_NB_PKTS);
+#if CONFIG_LIBUKNETDEV_LOOP_NULL
+	UK_TEST_EXPECT_ZERO(seen);
+#else /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+	UK_TEST_EXPECT_SNUM_EQ(seen, res.sent);
+#endif /* !CONFIG_LIBUKNETDEV_LOOP_NULL */
+	UK_TEST_EXPECT_SNUM_EQ(res.received, seen);
+	UK_TEST_EXPECT_ZERO(uk_netdev_rxq_hook_set(bench_dev, 0, NULL, NULL));
+}
+#endif /* CONFIG_LIBUKNETDEV_RXHOOK */
+
+uk_testsuite_register(uknetdev_loop, NULL);
+
+#if CONFIG_LIBUKNETDEV_GRO || CONFIG_LIBUKNETDEV_GSO
+#define OFFL_HDRLEN (UK_ETHER_HDR_LEN + sizeof(struct uk_iphdr) \
+		     + sizeof(struct uk_tcphdr))
+#define OFFL_SEQ    1000
+#define OFFL_IPID   100
+
+/* Builds an Ethernet frame with a TCP/IPv4 segment. Payload byte `i`
+ * is `seq + i`, so the position of every byte in the stream is known.
+ */
+static struct uk_netbuf *offl_tcp4_pkt(__u32 seq, __u16 paylen, __u8 flags)
+{
+	struct uk_alloc *a = uk_alloc_get_default();
+	struct uk_ether_header *eh;
+	struct uk_netbuf *pkt;
+	struct uk_iphdr *ip;
+	struct uk_tcphdr *th;
+	__u8 *pay;
+	__u16 i;
+
+	pkt = uk_netbuf_alloc_buf(a, OFFL_HDRLEN + paylen, sizeof(void *),
+				  0, 0, NULL);
+	if (!pkt)
+		return NULL;
+	pkt->len = OFFL_HDRLEN + paylen;
+	memset(pkt->data, 0, OFFL_HDRLEN);
+
+	eh = (struct uk_ether_header *) pkt->data;
+	eh->ether_type = np_htons(UK_ETHERTYPE_IP);
+
+	ip = (struct uk_iphdr *) (eh + 1);
+	ip->ip_v   = 4;
+	ip->ip_hl  = sizeof(*ip) / 4;
+	ip->ip_len = np_htons(sizeof(*ip) + sizeof(*th) + paylen);
+	ip->ip_id  = np_htons(OFFL_IPID);
+	ip->ip_ttl = 64;
+	ip->ip_p   = UK_IPPROTO_TCP;
+	ip->ip_src = np_htonl(0x0a000001);
+	ip->ip_dst = np_htonl(0x0a000002);
+	np_ip_csum_set(ip);
+
+	th = (struct uk_tcphdr *) (ip + 1);
+	th->th_sport = np_htons(1234);
+	th->th_dport = np_htons(80);
+	th->th_seq   = np_htonl(seq);
+	th->th_ack   = np_htonl(1);
+	th->th_off   = sizeof(*th) / 4;
+	th->th_flags = UK_TH_ACK | flags;
+	th->th_win   = np_htons(512);
+
+	pay = (__u8 *) (th + 1);
+	for (i = 0; i < paylen; ++i)
+		pay[i] = (__u8) (seq + i);
+	return pkt;
+}
+
+static __sz offl_pktlen(struct uk_netbuf *pkt)
+{
+	struct uk_netbuf *nb;
+	__sz len = 0;
+
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt)
+		len += nb->len;
+	return len;
+}
+
+static inline struct uk_iphdr *offl_ip(struct uk_netbuf *pkt)
+{
+	return (struct uk_iphdr *) ((__uptr) pkt->data + UK_ETHER_HDR_LEN);
+}
+
+static inline struct uk_tcphdr *offl_th(struct uk_netbuf *pkt)
+{
+	return (struct uk_tcphdr *) (offl_ip(pkt) + 1);
+}
+
+/* Returns 1 if the IPv4 header checksum of `pkt` is valid */
+static int offl_ip_csum_ok(struct uk_netbuf *pkt)
+{
+	return np_csum_fold(np_csum_add(0, offl_ip(pkt),
+					sizeof(struct uk_iphdr))) == 0;
+}
+
+/* Returns 1 if all bytes of the chain after the headers follow the payload
+ * pattern of offl_tcp4_pkt() starting at `seq`, and sets `*paylen`
+ */
+static int offl_payload_ok(struct uk_netbuf *pkt, __u32 seq, __sz *paylen)
+{
+	struct uk_netbuf *nb;
+	__sz off = OFFL_HDRLEN;
+	__sz i;
+
+	*paylen = 0;
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt) {
+		for (i = off; i < nb->len; ++i)
+			if (((__u8 *) nb->data)[i] != (__u8) (seq + (*paylen)++))
+				return 0;
+		off = 0;
+	}
+	return 1;
+}
+#endif /* CONFIG_LIBUKNETDEV_GRO || CONFIG_LIBUKNETDEV_GSO */
+
+#if CONFIG_LIBUKNETDEV_GRO
+#define GRO_TEST_MAXPKTS 4
+
+struct gro_test {
+	struct uk_netdev_gro gro;
+	struct uk_netbuf *pkts[GRO_TEST_MAXPKTS];
+	unsigned int count;
+};
+
+static void gro_test_deliver(struct uk_netbuf *pkt, void *argp)
+{
+	struct gro_test *t = (struct gro_test *) argp;
+
+	if (t->count < GRO_TEST_MAXPKTS)
+		t->pkts[t->count++] = pkt;
+	else
+		uk_netbuf_free(pkt);
+}
+
+static int gro_test_receive(struct gro_test *t, __u32 seq, __u16 paylen,
+			    __u8 flags)
+{
+	struct uk_netbuf *pkt = offl_tcp4_pkt(seq, paylen, flags);
+
+	if (!pkt)
+		return -ENOMEM;
+	pkt->flags |= UK_NETBUF_F_DATA_VALID;
+	uk_netdev_gro_receive(&t->gro, pkt);
+	return 0;
+}
+
+static void gro_test_release(struct gro_test *t)
+{
+	while (t->count)
+		uk_netbuf_free(t->pkts[--t->count]);
+}
+
+UK_TESTCASE(uknetdev_gro, merge)
+{
+	struct gro_test t = { .count = 0 };
+	struct uk_netbuf *pkt;
+	__sz paylen;
+
+	uk_netdev_gro_init(&t.gro, gro_test_deliver, &t);
+
+	UK_TEST_EXPECT_ZERO(gro_test_receive(&t, OFFL_SEQ, 100, 0));
+	UK_TEST_EXPECT_ZERO(gro_test_receive(&t, OFFL_SEQ + 100, 100, 0));
+	UK_TEST_EXPECT_ZERO(t.count);
+
+	/* PSH ends the burst and is carried over to the merged packet */
+	UK_TEST_EXPECT_ZERO(gro_test_receive(&t, OFFL_SEQ + 200, 100,
+					     UK_TH_PUSH));
+	UK_TEST_EXPECT_SNUM_EQ(t.count, 1);
+	if (t.count != 1)
+		goto out;
+
+	pkt = t.pkts[0];
+	UK_TEST_EXPECT_SNUM_EQ(offl_pktlen(pkt), OFFL_HDRLEN + 300);
+	UK_TEST_EXPECT_SNUM_EQ(np_ntohs(offl_ip(pkt)->ip_len),
+			       OFFL_HDRLEN - UK_ETHER_HDR_LEN + 300);
+	UK_TEST_EXPECT(offl_ip_csum_ok(pkt));
+	UK_TEST_EXPECT_SNUM_EQ(np_ntohl(offl_th(pkt)->th_seq), OFFL_SEQ);
+	UK_TEST_EXPECT(offl_th(pkt)->th_flags & UK_TH_PUSH);
+	UK_TEST_EXPECT(pkt->flags & UK_NETBUF_F_DATA_VALID);
+	UK_TEST_EXPECT(offl_payload_ok(pkt, OFFL_SEQ, &paylen));
+	UK_TEST_EXPECT_SNUM_EQ(paylen, 300);
+
+out:
+	gro_test_release(&t);
+}
+
+UK_TESTCASE(uknetdev_gro, seq_gap)
+{
+	struct gro_test t = { .count = 0 };
+
+	uk_netdev_gro_init(&t.gro, gro_test_deliver, &t);
+
+	UK_TEST_EXPECT_ZERO(gro_test_receive(&t, OFFL_SEQ, 100, 0));
+	/* A missing segment prevents merging */
+	UK_TEST_EXPECT_ZERO(gro_test_receive(&t, OFFL_SEQ + 200, 100, 0));
+	UK_TEST_EXPECT_SNUM_EQ(t.count, 1);
+	uk_netdev_gro_flush(&t.gro);
+	UK_TEST_EXPECT_SNUM_EQ(t.count, 2);
+	if (t.count != 2)
+		goto out;
+
+	UK_TEST_EXPECT_SNUM_EQ(np_ntohl(offl_th(t.pkts[0])->th_seq), OFFL_SEQ);
+	UK_TEST_EXPECT_SNUM_EQ(np_ntohl(offl_th(t.pkts[1])->th_seq),
+			       OFFL_SEQ + 200);
+	UK_TEST_EXPECT_SNUM_EQ(np_ntohs(offl_ip(t.pkts[1])->ip_len),
+			       OFFL_HDRLEN - UK_ETHER_HDR_LEN + 100);
+
+out:
+	gro_test_release(&t);
+}
+
+uk_testsuite_register(uknetdev_gro, NULL);
+#endif /* CONFIG_LIBUKNETDEV_GRO */
+
+#if CONFIG_LIBUKNETDEV_GSO
+#define GSO_TEST_MSS     100
+#define GSO_TEST_PAYLEN  250
+#define GSO_TEST_NB_SEGS DIV_ROUND_UP(GSO_TEST_PAYLEN, GSO_TEST_MSS)
+
+static struct uk_netbuf *gso_test_segs[GSO_TEST_NB_SEGS + 1];
+static unsigned int gso_test_count;
+
+/* Transmit function of a fake device that keeps the segments */
+static int gso_test_tx_one(struct uk_netdev *dev __unused,
+			   struct uk_netdev_tx_queue *queue __unused,
+			   struct uk_netbuf *pkt)
+{
+	if (gso_test_count >= ARRAY_SIZE(gso_test_segs))
+		return 0;
+	gso_test_segs[gso_test_count++] = pkt;
+	return UK_NETDEV_STATUS_SUCCESS | UK_NETDEV_STATUS_MORE;
+}
+
+static char gso_test_txq;
+static struct uk_netdev_data gso_test_data = {
+	.state = UK_NETDEV_RUNNING,
+};
+static struct uk_netdev gso_test_dev = {
+	.tx_one   = gso_test_tx_one,
+	._data    = &gso_test_data,
+	._tx_queue = { (struct uk_netdev_tx_queue *) &gso_test_txq },
+};
+
+/* Returns 1 if the TCP checksum of a TCP/IPv4 segment is valid */
+static int gso_test_tcp_csum_ok(struct uk_netbuf *seg)
+{
+	struct uk_iphdr *ip = offl_ip(seg);
+	__u16 l4len = np_ntohs(ip->ip_len) - sizeof(*ip);
+	__u64 sum;
+
+	sum = np_csum_add(0, &ip->ip_src,
+			  sizeof(ip->ip_src) + sizeof(ip->ip_dst));
+	sum += np_htons((__u16) UK_IPPROTO_TCP);
+	sum += np_htons(l4len);
+	sum = np_csum_add(sum, offl_th(seg), l4len);
+	return np_csum_fold(sum) == 0;
+}
+
+UK_TESTCASE(uknetdev_gso, tcpv4)
+{
+	struct uk_netbuf *pkt, *seg;
+	__u16 seglen;
+	__sz paylen;
+	unsigned int i;
+
+	pkt = offl_tcp4_pkt(OFFL_SEQ, GSO_TEST_PAYLEN, UK_TH_PUSH);
+	UK_TEST_EXPECT_NOT_NULL(pkt);
+	if (!pkt)
+		return;
+	pkt->flags |= UK_NETBUF_F_GSO_TCPV4;
+	pkt->gso_size = GSO_TEST_MSS;
+	pkt->header_len = OFFL_HDRLEN;
+
+	gso_test_count = 0;
+	UK_TEST_EXPECT(uk_netdev_tx_gso(&gso_test_dev, 0, pkt)
+		       & UK_NETDEV_STATUS_SUCCESS);
+	UK_TEST_EXPECT_SNUM_EQ(gso_test_count, GSO_TEST_NB_SEGS);
+
+	for (i = 0; i < gso_test_count; ++i) {
+		seg = gso_test_segs[i];
+		seglen = MIN(GSO_TEST_PAYLEN - i * GSO_TEST_MSS,
+			     (unsigned int) GSO_TEST_MSS);
+
+		UK_TEST_EXPECT_SNUM_EQ(seg->len, OFFL_HDRLEN + seglen);
+		UK_TEST_EXPECT_SNUM_EQ(np_ntohs(offl_ip(seg)->ip_len),
+				       OFFL_HDRLEN - UK_ETHER_HDR_LEN + seglen);
+		UK_TEST_EXPECT_SNUM_EQ(np_ntohs(offl_ip(seg)->ip_id),
+				       OFFL_IPID + i);
+		UK_TEST_EXPECT(offl_ip_csum_ok(seg));
+		UK_TEST_EXPECT_SNUM_EQ(np_ntohl(offl_th(seg)->th_seq),
+				       OFFL_SEQ + i * GSO_TEST_MSS);
+		UK_TEST_EXPECT(gso_test_tcp_csum_ok(seg));
+		UK_TEST_EXPECT(offl_payload_ok(seg, OFFL_SEQ + i * GSO_TEST_MSS,
+					       &paylen));
+		UK_TEST_EXPECT_SNUM_EQ(paylen, seglen);
+
+		/* Only the last segment keeps PSH */
+		if (i < gso_test_count - 1)
+			UK_TEST_EXPECT_ZERO(offl_th(seg)->th_flags & UK_TH_PUSH);
+		else
+			UK_TEST_EXPECT(offl_th(seg)->th_flags & UK_TH_PUSH);
+
+		uk_netbuf_free(seg);
+	}
+}
+
+uk_testsuite_register(uknetdev_gso, NULL);
+#endif /* CONFIG_LIBUKNETDEV_GSO */
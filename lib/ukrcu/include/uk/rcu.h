@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#ifndef __UK_RCU_H__
+#define __UK_RCU_H__
+
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/atomic.h>
+#include <uk/arch/lcpu.h>
+#include <uk/plat/lcpu.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Read-copy-update
+ * ================
+ *
+ * Readers access RCU-protected data between uk_rcu_read_lock() and
+ * uk_rcu_read_unlock() without taking any lock. Updaters publish a new version
+ * with uk_rcu_assign_pointer() (or the _rcu list helpers of uk/list.h) and
+ * may free the old version once a grace period has passed, either by waiting
+ * in uk_rcu_synchronize() or by deferring the release with uk_rcu_call().
+ *
+ * Threads are scheduled cooperatively, so a reader must not block or yield
+ * inside its read-side critical section. Every context switch is then a
+ * quiescent state for its lcpu: no reader on this lcpu can still reference a
+ * version that was unpublished before. A grace period is over as soon as
+ * every other lcpu went through a quiescent state or was idle. Read-side
+ * critical sections are not supported in interrupt handlers.
+ */
+
+/* Per-lcpu quiescent state counter. Odd while the lcpu runs threads; even
+ * while it is idle or has not started scheduling yet.
+ */
+struct uk_rcu_lcpu {
+	__u64 seq;
+} __align(CACHE_LINE_SIZE);
+
+extern UKPLAT_PER_LCPU_DEFINE(struct uk_rcu_lcpu, _uk_rcu_lcpu);
+
+/**
+ * Reports a quiescent state for the current lcpu. Called by the scheduler on
+ * every context switch and when an lcpu leaves the idle state.
+ */
+static inline void uk_rcu_quiescent(void)
+{
+	struct uk_rcu_lcpu *l = &ukplat_per_lcpu_current(_uk_rcu_lcpu);
+
+	/* Accesses of finished readers must be complete before the
+	 * updater sees the new value, and new readers must not start before.
+	 */
+	__atomic_store_n(&l->seq, (l->seq | 1) + 2, __ATOMIC_RELEASE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * Marks the current lcpu as idle, e.g., before halting it. The lcpu does not
+ * delay grace periods until it reports a quiescent state again.
+ */
+static inline void uk_rcu_idle_enter(void)
+{
+	struct uk_rcu_lcpu *l = &ukplat_per_lcpu_current(_uk_rcu_lcpu);
+
+	__atomic_store_n(&l->seq, (l->seq | 1) + 1, __ATOMIC_RELEASE);
+}
+
+#define uk_rcu_idle_exit()	uk_rcu_quiescent()
+
+/**
+ * Enters a read-side critical section. Sections can be nested and must not
+ * block.
+ */
+#define uk_rcu_read_lock()	barrier()
+
+/**
+ * Leaves a read-side critical section.
+ */
+#define uk_rcu_read_unlock()	barrier()
+
+/**
+ * Loads an RCU-protected pointer within a read-side critical section.
+ */
+#define uk_rcu_dereference(p)	UK_READ_ONCE(p)
+
+/**
+ * Publishes an RCU-protected pointer. Initialization of the object it points
+ * to is visible to readers that see the new pointer.
+ */
+#define uk_rcu_assign_pointer(p, v)					\
+	__atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+
+/**
+ * Waits until all read-side critical sections that are in progress have
+ * finished. Must not be called inside a read-side critical section.
+ */
+void uk_rcu_synchronize(void);
+
+struct uk_rcu_head;
+
+typedef void (*uk_rcu_callback_t)(struct uk_rcu_head *head);
+
+/* To be embedded into objects that are released with uk_rcu_call() */
+struct uk_rcu_head {
+	struct uk_rcu_head *next;
+	uk_rcu_callback_t func;
+};
+
+/**
+ * Calls `func` after a grace period, from the RCU worker thread. Does not
+ * block and can be called from interrupt context.
+ *
+ * @param head
+ *   RCU head of the object; passed to `func`
+ * @param func
+ *   Callback, typically releases the object that embeds `head`
+ */
+void uk_rcu_call(struct uk_rcu_head *head, uk_rcu_callback_t func);
+
+/**
+ * Waits until all callbacks that were queued with uk_rcu_call() before have
+ * been called.
+ */
+void uk_rcu_barrier(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_RCU_H__ */
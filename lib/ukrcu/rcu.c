@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/init.h>
+#include <uk/print.h>
+#include <uk/rcu.h>
+#include <uk/sched.h>
+#include <uk/spinlock.h>
+#include <uk/thread.h>
+#include <uk/wait.h>
+
+UKPLAT_PER_LCPU_DEFINE(struct uk_rcu_lcpu, _uk_rcu_lcpu);
+
+/* Callbacks waiting for the next grace period, in call order */
+static struct uk_rcu_head *rcu_cbs;
+static struct uk_rcu_head **rcu_cbs_tail = &rcu_cbs;
+static uk_spinlock rcu_cbs_lock = UK_SPINLOCK_INITIALIZER();
+static struct uk_waitq rcu_cbs_wq = UK_WAIT_QUEUE_INITIALIZER(rcu_cbs_wq);
+
+#if CONFIG_HAVE_SMP
+/* Returns true if lcpu `idx` passed a quiescent state since `snap` */
+static inline bool rcu_lcpu_quiescent(__lcpuidx idx, __u64 snap)
+{
+	/* An lcpu that is idle or has not started runs no readers */
+	if (!(snap & 1))
+		return true;
+	return __atomic_load_n(&ukplat_per_lcpu(_uk_rcu_lcpu, idx).seq,
+			       __ATOMIC_ACQUIRE) != snap;
+}
+#endif /* CONFIG_HAVE_SMP */
+
+void uk_rcu_synchronize(void)
+{
+#if CONFIG_HAVE_SMP
+	__u64 snap[CONFIG_UKPLAT_LCPU_MAXCOUNT];
+	__lcpuidx self = ukplat_lcpu_idx();
+	__lcpuidx count = ukplat_lcpu_count();
+	__lcpuidx i;
+
+	/* Order the unpublishing stores of the caller before the snapshot */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	for (i = 0; i < count; ++i)
+		snap[i] = __atomic_load_n(&ukplat_per_lcpu(_uk_rcu_lcpu,
+							    i).seq,
+					  __ATOMIC_ACQUIRE);
+
+	/* The caller is not a reader and readers do not block, so the
+	 * current lcpu is quiescent already.
+	 */
+	for (i = 0; i < count; ++i) {
+		if (i == self)
+			continue;
+		while (!rcu_lcpu_quiescent(i, snap[i])) {
+			if (uk_thread_current())
+				uk_sched_yield();
+			else
+				ukarch_spinwait();
+		}
+	}
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else /* !CONFIG_HAVE_SMP */
+	/* All readers ran to completion on this very lcpu */
+	barrier();
+#endif /* !CONFIG_HAVE_SMP */
+}
+
+void uk_rcu_call(struct uk_rcu_head *head, uk_rcu_callback_t func)
+{
+	unsigned long irqf;
+
+	UK_ASSERT(head);
+	UK_ASSERT(func);
+
+	head->next = NULL;
+	head->func = func;
+
+	uk_spin_lock_irqsave(&rcu_cbs_lock, irqf);
+	*rcu_cbs_tail = head;
+	rcu_cbs_tail = &head->next;
+	uk_spin_unlock_irqrestore(&rcu_cbs_lock, irqf);
+
+	uk_waitq_wake_up(&rcu_cbs_wq);
+}
+
+struct rcu_barrier {
+	struct uk_rcu_head head;
+	struct uk_waitq wq;
+	uk_spinlock sl;
+	int done;
+};
+
+static void rcu_barrier_cb(struct uk_rcu_head *head)
+{
+	struct rcu_barrier *b = __containerof(head, struct rcu_barrier, head);
+
+	/* Wake up with the lock held so that the waiter cannot return and
+	 * release `b` before we are done with it.
+	 */
+	uk_spin_lock(&b->sl);
+	b->done = 1;
+	uk_waitq_wake_up(&b->wq);
+	uk_spin_unlock(&b->sl);
+}
+
+void uk_rcu_barrier(void)
+{
+	struct rcu_barrier b;
+
+	b.done = 0;
+	uk_waitq_init(&b.wq);
+	uk_spin_init(&b.sl);
+
+	/* Callbacks are called in order, ours is the last one */
+	uk_rcu_call(&b.head, rcu_barrier_cb);
+
+	uk_spin_lock(&b.sl);
+	uk_waitq_wait_event_locked(&b.wq, b.done,
+				   uk_spin_lock, uk_spin_unlock, &b.sl);
+	uk_spin_unlock(&b.sl);
+}
+
+static __noreturn void rcu_worker(void *argp __unused)
+{
+	struct uk_rcu_head *cbs, *next;
+	unsigned long irqf;
+
+	for (;;) {
+		uk_waitq_wait_event(&rcu_cbs_wq, UK_READ_ONCE(rcu_cbs) != NULL);
+
+		uk_spin_lock_irqsave(&rcu_cbs_lock, irqf);
+		cbs = rcu_cbs;
+		rcu_cbs = NULL;
+		rcu_cbs_tail = &rcu_cbs;
+		uk_spin_unlock_irqrestore(&rcu_cbs_lock, irqf);
+
+		/* Every callback that we took was queued before the grace
+		 * period started.
+		 */
+		uk_rcu_synchronize();
+
+		for (; cbs; cbs = next) {
+			next = cbs->next;
+			cbs->func(cbs);
+		}
+	}
+}
+
+static int rcu_init(struct uk_init_ctx *ictx __unused)
+{
+	struct uk_sched *s = uk_sched_current();
+
+	if (unlikely(!s)) {
+		uk_pr_err("Cannot start RCU worker without a scheduler\n");
+		return -ENOTSUP;
+	}
+
+	if (unlikely(!uk_sched_thread_create(s, rcu_worker, NULL, "rcu"))) {
+		uk_pr_err("Failed to start RCU worker\n");
+		return -ENOMEM;
+	}
+	return 0;
+}
+uk_lib_initcall(rcu_init, 0x0);
@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2026, Unikraft GmbH and The Unikraft Authors.
+ * Licensed under the BSD-3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ */
+
+#include <uk/list.h>
+#include <uk/rcu.h>
+#include <uk/test.h>
+
+struct rcu_test_entry {
+	int val;
+	struct uk_list_head list;
+	struct uk_hlist_node hnode;
+	struct uk_rcu_head rcu;
+};
+
+static int rcu_test_sum(struct uk_list_head *head)
+{
+	struct rcu_test_entry *e;
+	int sum = 0;
+
+	uk_rcu_read_lock();
+	uk_list_for_each_entry_rcu(e, head, list)
+		sum += e->val;
+	uk_rcu_read_unlock();
+	return sum;
+}
+
+UK_TESTCASE(ukrcu, list_rcu)
+{
+	struct rcu_test_entry e[3] = { { .val = 1 }, { .val = 2 },
+				       { .val = 4 } };
+	UK_LIST_HEAD(head);
+	UK_HLIST_HEAD(hhead);
+	struct rcu_test_entry *itr;
+	int sum = 0;
+
+	uk_list_add_rcu(&e[0].list, &head);
+	uk_list_add_tail_rcu(&e[1].list, &head);
+	UK_TEST_EXPECT_SNUM_EQ(rcu_test_sum(&head), 3);
+
+	uk_list_replace_rcu(&e[0].list, &e[2].list);
+	UK_TEST_EXPECT_SNUM_EQ(rcu_test_sum(&head), 6);
+
+	/* A reader that is on a removed entry still gets to the list head */
+	uk_list_del_rcu(&e[2].list);
+	UK_TEST_EXPECT_PTR_EQ(e[2].list.next, &e[1].list);
+	UK_TEST_EXPECT_SNUM_EQ(rcu_test_sum(&head), 2);
+	uk_rcu_synchronize();
+
+	uk_hlist_add_head_rcu(&e[0].hnode, &hhead);
+	uk_hlist_add_head_rcu(&e[1].hnode, &hhead);
+	uk_hlist_del_rcu(&e[0].hnode);
+	uk_hlist_for_each_entry_rcu(itr, &hhead, hnode)
+		sum += itr->val;
+	UK_TEST_EXPECT_SNUM_EQ(sum, 2);
+}
+
+static int rcu_test_calls;
+
+static void rcu_test_cb(struct uk_rcu_head *head)
+{
+	struct rcu_test_entry *e = __containerof(head, struct rcu_test_entry,
+						 rcu);
+
+	/* Callbacks are called in order */
+	if (e->val == rcu_test_calls)
+		rcu_test_calls++;
+}
+
+UK_TESTCASE(ukrcu, call_rcu)
+{
+	struct rcu_test_entry e[4];
+	int i;
+
+	rcu_test_calls = 0;
+	for (i = 0; i < (int)ARRAY_SIZE(e); ++i) {
+		e[i].val = i;
+		uk_rcu_call(&e[i].rcu, rcu_test_cb);
+	}
+	uk_rcu_barrier();
+	UK_TEST_EXPECT_SNUM_EQ(rcu_test_calls, ARRAY_SIZE(e));
+}
+
+uk_testsuite_register(ukrcu, NULL);
@@ -48,6 +48,10 @@
 #include <string.h>
 #endif /* CONFIG_LIBUKSCHED_STATS */
 
+#if CONFIG_LIBUKRCU
+#include <uk/rcu.h>
+#endif /* CONFIG_LIBUKRCU */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -108,6 +112,11 @@ void uk_sched_thread_switch(struct uk_thread *next)
 
 	ukplat_per_lcpu_current(__uk_sched_thread_current) = next;
 
+#if CONFIG_LIBUKRCU
+	/* `prev` cannot be in an RCU read-side critical section */
+	uk_rcu_quiescent();
+#endif /* CONFIG_LIBUKRCU */
+
 	prev->tlsp = ukplat_tlsp_get();
 	if (prev->ectx)
 		ukarch_ectx_store(prev->ectx);
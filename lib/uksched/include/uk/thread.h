@@ -102,6 +102,21 @@ struct uk_thread *uk_thread_current(void)
 	return ukplat_per_lcpu_current(__uk_sched_thread_current);
 }
 
+/* Returns true if the thread currently executes on some lcpu. The answer can
+ * be outdated as soon as it is returned; use it only as a hint.
+ */
+static inline
+bool uk_thread_is_oncpu(const struct uk_thread *t)
+{
+	__lcpuidx i;
+
+	for (i = 0; i < ukplat_lcpu_count(); ++i)
+		if (UK_READ_ONCE(ukplat_per_lcpu(__uk_sched_thread_current,
+						 i)) == t)
+			return true;
+	return false;
+}
+
 /*
  * STATES OF THREADS
  * =================
@@ -42,6 +42,9 @@
 #include <uk/plat/lcpu.h>
 #include <uk/sched.h>
 #include <uk/syscall.h>
+#if CONFIG_LIBUKRCU
+#include <uk/rcu.h>
+#endif /* CONFIG_LIBUKRCU */
 
 struct uk_sched *uk_sched_head;
 
@@ -234,6 +237,10 @@ int uk_sched_start(struct uk_sched *s)
 
 	/* Set main_thread as current scheduled thread */
 	ukplat_per_lcpu_current(__uk_sched_thread_current) = main_thread;
+#if CONFIG_LIBUKRCU
+	/* This lcpu runs threads from now on */
+	uk_rcu_quiescent();
+#endif /* CONFIG_LIBUKRCU */
 
 	/* Add main to the scheduler's thread list */
 	UK_TAILQ_INSERT_TAIL(&s->thread_list, main_thread, thread_list);
@@ -36,8 +36,20 @@
 #include <uk/sched_impl.h>
 #include <uk/schedcoop.h>
 #include <uk/essentials.h>
+#if CONFIG_LIBUKRCU
+#include <uk/rcu.h>
+#endif /* CONFIG_LIBUKRCU */
+#if CONFIG_HAVE_PAGING && CONFIG_LIBUKFALLOC
+#include <uk/plat/paging.h>
+#include <uk/falloc.h>
+#endif /* CONFIG_HAVE_PAGING && CONFIG_LIBUKFALLOC */
 #include "schedcoop.h"
 
+/* Number of frames that the idle thread zeroes before checking for runnable
+ * threads again
+ */
+#define SCHEDCOOP_IDLE_FZERO_BATCH	16
+
 static void schedcoop_schedule(struct uk_sched *s)
 {
 	struct schedcoop *c = uksched2schedcoop(s);
@@ -174,6 +186,21 @@ static void schedcoop_thread_blocked(struct uk_sched *s, struct uk_thread *t)
 		UK_TAILQ_INSERT_TAIL(&c->sleep_queue, t, queue);
 }
 
+#if CONFIG_HAVE_PAGING && CONFIG_LIBUKFALLOC
+/* Lets the frame allocator use idle time, e.g., to zero frames in advance */
+static int idle_fzero(void)
+{
+	struct uk_pagetable *pt = ukplat_pt_get_active();
+
+	if (unlikely(!pt || !pt->fa || !pt->fa->fzero))
+		return 0;
+
+	return pt->fa->fzero(pt->fa, SCHEDCOOP_IDLE_FZERO_BATCH) > 0;
+}
+#else /* CONFIG_HAVE_PAGING && CONFIG_LIBUKFALLOC */
+#define idle_fzero() 0
+#endif /* !CONFIG_HAVE_PAGING || !CONFIG_LIBUKFALLOC */
+
 static __noreturn void idle_thread_fn(void *argp)
 {
 	struct schedcoop *c = (struct schedcoop *) argp;
@@ -183,6 +210,15 @@ static __noreturn void idle_thread_fn(void *argp)
 	UK_ASSERT(c);
 
 	for (;;) {
+		/* Do some background work with interrupts enabled as long as
+		 * there is nothing else to do. Threads woken up in the
+		 * meantime get the CPU after the current batch.
+		 */
+		if (!UK_TAILQ_FIRST(&c->run_queue) && idle_fzero()) {
+			schedcoop_yield(&c->sched);
+			continue;
+		}
+
 		flags = ukplat_lcpu_save_irqf();
 
 		/*
@@ -219,10 +255,16 @@ static __noreturn void idle_thread_fn(void *argp)
 		now = ukplat_monotonic_clock();
 
 		if (!wake_up_time || wake_up_time > now) {
+#if CONFIG_LIBUKRCU
+			uk_rcu_idle_enter();
+#endif /* CONFIG_LIBUKRCU */
 			if (wake_up_time)
 				ukplat_lcpu_halt_irq_until(wake_up_time);
 			else
 				ukplat_lcpu_halt_irq();
+#if CONFIG_LIBUKRCU
+			uk_rcu_idle_exit();
+#endif /* CONFIG_LIBUKRCU */
 
 			/* handle pending events if any */
 			ukplat_lcpu_irqs_handle_pending();
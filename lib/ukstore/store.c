@@ -67,7 +67,7 @@ struct uk_store_object_entry {
 
 /* The starting point of all dynamic objects for each library */
 static struct uk_list_head dynamic_heads[__UKLIBID_COUNT__] = { NULL, };
-static __spinlock dynamic_heads_lock = UK_SPINLOCK_INITIALIZER();
+static uk_spinlock dynamic_heads_lock = UK_SPINLOCK_INITIALIZER();
 
 #include <uk/bits/store_array.h>
 
@@ -71,6 +71,13 @@ struct uk_vas {
 	/** VAS flags */
 #define UK_VAS_FLAG_NO_PAGING		0x1 /* On-demand paging disabled */
 	unsigned long flags;
+
+#ifdef CONFIG_LIBUKVMEM_THP
+	/** Number of faults resolved with a transparent large page */
+	unsigned long nr_thp_promoted;
+	/** Number of faults that could not be resolved with a large page */
+	unsigned long nr_thp_fallback;
+#endif /* CONFIG_LIBUKVMEM_THP */
 };
 
 /**
@@ -120,6 +127,8 @@ struct uk_vma {
 
 	/** VMA flags - high word bits are from mapping flags */
 #define UK_VMA_FLAG_UNINITIALIZED	0x1 /* Do not initialize memory */
+#define UK_VMA_FLAG_HUGEPAGE		0x2 /* Prefer transparent large pages */
+#define UK_VMA_FLAG_NOHUGEPAGE		0x4 /* No transparent large pages */
 	unsigned long flags;
 
 	/** Desired page level (-1 = no preference) */
@@ -624,6 +633,8 @@ int uk_vma_set_attr(struct uk_vas *vas, __vaddr_t vaddr, __sz len,
 /* VMA advices */
 #define UK_VMA_ADV_DONTNEED		0x01 /* Physical memory can be freed */
 #define UK_VMA_ADV_WILLNEED		0x02 /* Area should be prefaulted */
+#define UK_VMA_ADV_HUGEPAGE		0x04 /* Use transparent large pages */
+#define UK_VMA_ADV_NOHUGEPAGE		0x08 /* No transparent large pages */
 
 /* The high word bits of the advice are usable for VMA-type specific advices */
 #define UK_VMA_ADV_EXTF_SHIFT		(sizeof(unsigned long) * 4)
@@ -656,6 +667,11 @@ int uk_vma_set_attr(struct uk_vas *vas, __vaddr_t vaddr, __sz len,
  *   UK_VMA_ADV_WILLNEED informs the virtual memory system that the pages will
  *   be needed soon and should be paged in. This can be used to reduce the
  *   number of page faults.
+ *
+ *   UK_VMA_ADV_HUGEPAGE and UK_VMA_ADV_NOHUGEPAGE enable or disable transparent
+ *   large pages for anonymous memory in the address range. VMAs are split at
+ *   the range boundaries if necessary. Pages that are already mapped are not
+ *   affected. Without CONFIG_LIBUKVMEM_THP, these advices have no effect.
  * @param flags
  *   One of the generic flags (UK_VMA_FLAG_*)
  *
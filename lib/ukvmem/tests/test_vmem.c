@@ -508,6 +508,69 @@ UK_TESTCASE(ukvmem, test_vma_anon_large)
 }
 #endif /* PAGE_LARGE_SHIFT */
 
+#if defined(CONFIG_LIBUKVMEM_THP) && defined(PAGE_LARGE_SHIFT)
+/**
+ * Tests if anonymous memory is paged-in with transparent large pages and if
+ * this can be controlled with advices.
+ */
+UK_TESTCASE(ukvmem, test_vma_anon_thp)
+{
+	struct uk_vas *vas = vas_init();
+	unsigned long promoted;
+	__vaddr_t va;
+	unsigned int lvl;
+	int rc;
+	__sz len;
+
+	/* The mapping should be aligned to allow for large pages */
+	va = __VADDR_ANY;
+	rc = uk_vma_map_anon(vas, &va, PAGE_LARGE_SIZE * 2, PROT_RW, 0, NULL);
+	UK_TEST_EXPECT_ZERO(rc);
+	UK_TEST_EXPECT(PAGE_LARGE_ALIGNED(va));
+
+	/* Enable large pages for the first half and disable them for the
+	 * second half. This should split the VMA.
+	 */
+	rc = uk_vma_advise(vas, va, PAGE_LARGE_SIZE, UK_VMA_ADV_HUGEPAGE, 0);
+	UK_TEST_EXPECT_ZERO(rc);
+
+	rc = uk_vma_advise(vas, va + PAGE_LARGE_SIZE, PAGE_LARGE_SIZE,
+			   UK_VMA_ADV_NOHUGEPAGE, 0);
+	UK_TEST_EXPECT_ZERO(rc);
+
+	UK_TEST_EXPECT_ZERO(chk_vas(vas, (struct vma_entry[]){
+		{va, va + PAGE_LARGE_SIZE, PROT_RW},
+		{va + PAGE_LARGE_SIZE, va + 2 * PAGE_LARGE_SIZE, PROT_RW},
+	}, 2));
+
+	promoted = vas->nr_thp_promoted;
+
+	len = probe_rw(va + PAGE_SIZE, PAGE_SIZE);
+	UK_TEST_EXPECT_SNUM_EQ(len, PAGE_SIZE);
+
+	lvl = PAGE_LEVEL;
+	rc = ukplat_pt_walk(vas->pt, va, &lvl, NULL, NULL);
+	vmem_bug_on(rc != 0);
+
+	UK_TEST_EXPECT_SNUM_EQ(lvl, PAGE_LARGE_LEVEL);
+	UK_TEST_EXPECT_SNUM_EQ(vas->nr_thp_promoted, promoted + 1);
+	UK_TEST_EXPECT(is_zero(va, PAGE_LARGE_SIZE));
+
+	/* The second half must use regular pages */
+	len = probe_rw(va + PAGE_LARGE_SIZE, PAGE_SIZE);
+	UK_TEST_EXPECT_SNUM_EQ(len, PAGE_SIZE);
+
+	lvl = PAGE_LEVEL;
+	rc = ukplat_pt_walk(vas->pt, va + PAGE_LARGE_SIZE, &lvl, NULL, NULL);
+	vmem_bug_on(rc != 0);
+
+	UK_TEST_EXPECT_SNUM_EQ(lvl, PAGE_LEVEL);
+	UK_TEST_EXPECT_SNUM_EQ(vas->nr_thp_promoted, promoted + 1);
+
+	vas_clean(vas);
+}
+#endif /* CONFIG_LIBUKVMEM_THP && PAGE_LARGE_SHIFT */
+
 /**
  * Tests direct physical memory mappings. We especially make sure that the
  * mapping actually maps the correct physical memory and that this is still
@@ -40,6 +40,16 @@ static int vma_op_anon_fault(struct uk_vma *vma, struct uk_vm_fault *fault)
 	UK_ASSERT(fault->len == PAGE_Lx_SIZE(fault->level));
 	UK_ASSERT(fault->type & UK_VMA_FAULT_NONPRESENT);
 
+	/* Prefer a frame that has already been zeroed in idle time */
+	if (pages == 1 && !(vma->flags & UK_VMA_FLAG_UNINITIALIZED) &&
+	    pt->fa->falloc_zeroed) {
+		rc = pt->fa->falloc_zeroed(pt->fa, &paddr);
+		if (rc == 0) {
+			fault->paddr = paddr;
+			return 0;
+		}
+	}
+
 	rc = pt->fa->falloc(pt->fa, &paddr, pages, FALLOC_FLAG_ALIGNED);
 	if (unlikely(rc))
 		return rc;
@@ -67,6 +67,11 @@ int uk_vas_init(struct uk_vas *vas, struct uk_pagetable *pt __maybe_unused,
 
 	vas->flags = 0;
 
+#ifdef CONFIG_LIBUKVMEM_THP
+	vas->nr_thp_promoted = 0;
+	vas->nr_thp_fallback = 0;
+#endif /* CONFIG_LIBUKVMEM_THP */
+
 	UK_INIT_LIST_HEAD(&vas->vma_list);
 
 	return 0;
@@ -603,6 +608,7 @@ int uk_vma_map(struct uk_vas *vas, __vaddr_t *vaddr, __sz len,
 	unsigned long extf;
 	unsigned long flgs;
 	__vaddr_t va, base;
+	__sz align;
 
 	UK_ASSERT(vas);
 	UK_ASSERT(vaddr);
@@ -632,7 +638,17 @@ int uk_vma_map(struct uk_vas *vas, __vaddr_t *vaddr, __sz len,
 		base = (ops->get_base) ? ops->get_base(vas, args, flags) :
 					 vas->vma_base;
 
-		va = vmem_first_fit(vas, base, PAGE_Lx_SIZE(algn_lvl), len);
+		align = PAGE_Lx_SIZE(algn_lvl);
+#ifdef CONFIG_LIBUKVMEM_THP
+		/* Place anonymous memory that can hold a transparent large
+		 * page so that it can actually be used.
+		 */
+		if (ops == &uk_vma_anon_ops && to_lvl < 0 &&
+		    len >= PAGE_LARGE_SIZE)
+			align = PAGE_LARGE_SIZE;
+#endif /* CONFIG_LIBUKVMEM_THP */
+
+		va = vmem_first_fit(vas, base, align, len);
 		if (unlikely(va == __VADDR_INV))
 			return -ENOMEM;
 	} else {
@@ -914,6 +930,40 @@ static int vmem_vma_advise(struct uk_vma *vma, __vaddr_t vaddr, __sz len,
 	return VMA_ADVISE(vma, vaddr, len, advice);
 }
 
+static void vmem_vma_set_hugepage_vmas(struct uk_vma *start,
+				       struct uk_vma *end,
+				       unsigned long advice)
+{
+	struct uk_vma *vma = start;
+
+	UK_ASSERT(start);
+	UK_ASSERT(end);
+
+	/* NOHUGEPAGE takes precedence over HUGEPAGE */
+	for (;;) {
+		vma->flags &= ~(UK_VMA_FLAG_HUGEPAGE | UK_VMA_FLAG_NOHUGEPAGE);
+		vma->flags |= (advice & UK_VMA_ADV_NOHUGEPAGE) ?
+				UK_VMA_FLAG_NOHUGEPAGE : UK_VMA_FLAG_HUGEPAGE;
+
+		if (vma == end)
+			break;
+
+		vma = uk_list_next_entry(vma, vma_list);
+	}
+
+	/* Do a second pass and try to merge VMAs */
+	vma = vmem_vma_try_merge_with_next(end);
+	UK_ASSERT(vma == end);
+
+	vma = start;
+	while (vma != end) {
+		vma = vmem_vma_try_merge_with_prev(vma);
+		vma = uk_list_next_entry(vma, vma_list);
+	}
+
+	vmem_vma_try_merge_with_prev(end);
+}
+
 int uk_vma_advise(struct uk_vas *vas, __vaddr_t vaddr, __sz len,
 		  unsigned long advice, unsigned long flags)
 {
@@ -925,6 +975,28 @@ int uk_vma_advise(struct uk_vas *vas, __vaddr_t vaddr, __sz len,
 	if (unlikely(len == 0))
 		return 0;
 
+	if (advice & (UK_VMA_ADV_HUGEPAGE | UK_VMA_ADV_NOHUGEPAGE)) {
+		/* The large page preference is a property of the VMA. So, we
+		 * have to split VMAs that are only partially covered.
+		 */
+		rc = vmem_vma_split_vmas(vas, vaddr, len, __NULL,
+					 &vma_start, &vma_end, strict);
+		if (unlikely(rc)) {
+			if (rc == -ENOENT && !strict)
+				return 0;
+
+			return rc;
+		}
+
+		vmem_vma_set_hugepage_vmas(vma_start, vma_end, advice);
+
+		advice &= ~(UK_VMA_ADV_HUGEPAGE | UK_VMA_ADV_NOHUGEPAGE);
+		if (!advice)
+			return 0;
+
+		vma_start = __NULL;
+	}
+
 	rc = vmem_vma_find_range(vas, &vaddr, &len,
 				 &vma_start, &vma_end, strict);
 	if (unlikely(rc)) {
@@ -1027,6 +1099,66 @@ static int vmem_mapx_pagefault(struct uk_pagetable *pt __unused,
 	return 0;
 }
 
+#ifdef CONFIG_LIBUKVMEM_THP
+static inline int vmem_vma_thp_enabled(struct uk_vma *vma)
+{
+	if (vma->ops != &uk_vma_anon_ops || vma->page_lvl >= 0)
+		return 0;
+
+	if (vma->flags & UK_VMA_FLAG_NOHUGEPAGE)
+		return 0;
+
+#ifdef CONFIG_LIBUKVMEM_THP_ALWAYS
+	return 1;
+#else /* CONFIG_LIBUKVMEM_THP_ALWAYS */
+	return (vma->flags & UK_VMA_FLAG_HUGEPAGE);
+#endif /* !CONFIG_LIBUKVMEM_THP_ALWAYS */
+}
+
+/**
+ * Tries to resolve a fault in an anonymous VMA with a large page. This is only
+ * possible if the large page around the faulting address lies entirely within
+ * the VMA and nothing is mapped in its range yet (i.e., there is no page
+ * table below the large page level).
+ *
+ * @return
+ *   0 on success, -EAGAIN if the fault should be resolved with regular
+ *   demand-paging, or another negative errno error
+ */
+static int vmem_pagefault_thp(struct uk_pagetable *pt, __vaddr_t vaddr,
+			      struct uk_vma *vma, struct ukplat_page_mapx *mapx)
+{
+	unsigned int lvl = PAGE_LEVEL;
+	__vaddr_t vbase;
+	int rc;
+
+	vbase = PAGE_LARGE_ALIGN_DOWN(vaddr);
+	if (vbase < vma->start || vma->end - vbase < PAGE_LARGE_SIZE)
+		return -EAGAIN;
+
+	rc = ukplat_pt_walk(pt, vbase, &lvl, __NULL, __NULL);
+	if (unlikely(rc))
+		return rc;
+
+	if (lvl < PAGE_LARGE_LEVEL)
+		return -EAGAIN;
+
+	rc = ukplat_page_mapx(pt, vbase, 0, 1, vma->attr,
+			      PAGE_FLAG_SIZE(PAGE_LARGE_LEVEL) |
+			      PAGE_FLAG_FORCE_SIZE, mapx);
+	if (rc == -ENOMEM) {
+		/* The frame allocator cannot provide a large frame */
+		vma->vas->nr_thp_fallback++;
+		return -EAGAIN;
+	}
+	if (unlikely(rc))
+		return rc;
+
+	vma->vas->nr_thp_promoted++;
+	return 0;
+}
+#endif /* CONFIG_LIBUKVMEM_THP */
+
 int vmem_pagefault(__vaddr_t vaddr, unsigned int type, struct __regs *regs)
 {
 	const unsigned int demand_lvl =
@@ -1073,6 +1205,14 @@ int vmem_pagefault(__vaddr_t vaddr, unsigned int type, struct __regs *regs)
 	UK_ASSERT(ctx.vma->vas->pt);
 	pt = ctx.vma->vas->pt;
 
+#ifdef CONFIG_LIBUKVMEM_THP
+	if (vmem_vma_thp_enabled(ctx.vma)) {
+		rc = vmem_pagefault_thp(pt, vaddr, ctx.vma, &mapx);
+		if (rc != -EAGAIN)
+			return rc;
+	}
+#endif /* CONFIG_LIBUKVMEM_THP */
+
 	/* Find the page level at which we want to page-in. If the VMA does not
 	 * enforce a specific page size and the configuration allows to page-in
 	 * large pages, we first check up to which level we find page tables.